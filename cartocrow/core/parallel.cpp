@@ -0,0 +1,61 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace cartocrow {
+
+int effectiveThreadCount(int threadCount) {
+	if (threadCount > 0) {
+		return threadCount;
+	}
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallel_for(int count, int threadCount, const std::function<void(int)>& f) {
+	threadCount = std::min(effectiveThreadCount(threadCount), count);
+	if (threadCount <= 1) {
+		for (int i = 0; i < count; i++) {
+			f(i);
+		}
+		return;
+	}
+	std::atomic<int> next = 0;
+	std::vector<std::future<void>> workers;
+	for (int t = 0; t < threadCount; t++) {
+		workers.push_back(std::async(std::launch::async, [&]() {
+			for (int i = next++; i < count; i = next++) {
+				f(i);
+			}
+		}));
+	}
+	// if a worker throws, get() rethrows; the destructors of the other futures
+	// still wait for their workers to finish
+	for (auto& worker : workers) {
+		worker.get();
+	}
+}
+
+} // namespace cartocrow
@@ -0,0 +1,44 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_CORE_PARALLEL_H
+#define CARTOCROW_CORE_PARALLEL_H
+
+#include <functional>
+
+namespace cartocrow {
+
+/// Returns \p threadCount if it is positive, and the number of hardware
+/// threads otherwise.
+int effectiveThreadCount(int threadCount);
+
+/// Calls \p f for every index in \f$[0, count)\f$ on \p threadCount threads
+/// (0 uses one per hardware thread).
+///
+/// Every thread repeatedly takes the next index that is left, so this balances
+/// the load well even if the calls take very different amounts of time. The
+/// order in which the indices are handled is not specified, so to get results
+/// that do not depend on the number of threads, \p f should only write to
+/// state that belongs to its index. If \p f throws, the exception is rethrown
+/// after all threads have finished.
+void parallel_for(int count, int threadCount, const std::function<void(int)>& f);
+
+} // namespace cartocrow
+
+#endif //CARTOCROW_CORE_PARALLEL_H
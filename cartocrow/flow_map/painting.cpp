@@ -4,11 +4,21 @@
 #include "../renderer/geometry_renderer.h"
 #include <CGAL/Origin.h>
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
 namespace cartocrow::flow_map {
 
 Painting::Painting(std::shared_ptr<RegionMap> map, std::shared_ptr<SpiralTree> tree,
                    const Options options)
-    : m_tree(tree), m_map(map), m_options(options) {}
+    : m_tree(tree), m_map(map), m_options(options) {
+	// written such that nan is rejected as well
+	if (!(options.spiralTolerance > 0)) {
+		throw std::runtime_error("Spiral tolerance must be positive");
+	}
+}
 
 void Painting::paint(renderer::GeometryRenderer& renderer) const {
 	if (m_map) {
@@ -55,14 +65,23 @@ void Painting::paintObstacles(renderer::GeometryRenderer& renderer) const {
 }
 
 void Painting::paintFlow(renderer::GeometryRenderer& renderer) const {
+	const double strokeWidth = 4;
 	renderer.setMode(renderer::GeometryRenderer::stroke);
-	renderer.setStroke(Color{100, 100, 100}, 4);
+	renderer.setStroke(Color{100, 100, 100}, strokeWidth);
+
+	// all flow edges share the same style, so we draw them as a single path
+	// (instead of a separate element for every segment of every spiral)
+	renderer::RenderPath path;
 	for (const auto& node : m_tree->nodes()) {
 		if (node->m_parent == nullptr) {
 			continue;
 		}
 		const Spiral spiral(node->m_position, node->m_parent->m_position);
-		paintSpiral(renderer, spiral, m_tree->rootPosition(), node->m_parent->m_position);
+		paintSpiral(path, spiral, m_tree->rootPosition(), node->m_parent->m_position,
+		            m_options.spiralTolerance * strokeWidth);
+	}
+	if (!path.commands().empty()) {
+		renderer.draw(path);
 	}
 }
 
@@ -84,31 +103,54 @@ void Painting::paintNodes(renderer::GeometryRenderer& renderer) const {
 	renderer.draw(m_tree->rootPosition());
 }
 
-void Painting::paintSpiral(renderer::GeometryRenderer& renderer, const Spiral& spiral,
-                           const Point<Inexact>& root, const PolarPoint& parent) const {
-	std::vector<PolarPoint> points;
-	points.push_back(spiral.evaluate(0));
+void Painting::paintSpiral(renderer::RenderPath& path, const Spiral& spiral,
+                           const Point<Inexact>& root, const PolarPoint& parent,
+                           Number<Inexact> tolerance) const {
+	const Vector<Inexact> offset = root - CGAL::ORIGIN;
+	const std::vector<PolarPoint> vertices =
+	    flattenSpiral(spiral, parent, tolerance, m_options.spiralMax);
+	path.moveTo(vertices.front().toCartesian() + offset);
+	for (size_t i = 1; i < vertices.size(); ++i) {
+		path.lineTo(vertices[i].toCartesian() + offset);
+	}
+}
+
+std::vector<PolarPoint> Painting::flattenSpiral(const Spiral& spiral, const PolarPoint& parent,
+                                                Number<Inexact> tolerance, Number<Inexact> tMax) {
+	std::vector<PolarPoint> vertices;
+	vertices.push_back(spiral.evaluate(0));
+
 	if (spiral.angle() != 0) {
-		for (double t = m_options.spiralStep; t < m_options.spiralMax; t += m_options.spiralStep) {
-			const PolarPoint polar = spiral.evaluate(t);
-			if (polar.r() <= parent.r()) {
+		const Number<Inexact> tEnd =
+		    parent.r() > 0 ? std::min(spiral.parameterForR(parent.r()), tMax) : tMax;
+		// A logarithmic spiral with angle α has radius of curvature
+		// ρ = r / sin|α|, and its tangent turns by tan|α| · Δt over a step of
+		// Δt. A chord spanning a turn of θ deviates ρ (1 - cos(θ / 2)) from
+		// the arc. As r decreases along the spiral, bounding the deviation at
+		// the start of every step bounds it on the entire step. We write
+		// 1 - cos(θ / 2) as 2 sin²(θ / 4), so that θ doesn't round to zero for
+		// tolerances that are tiny compared to r.
+		const Number<Inexact> sinAlpha = std::abs(std::sin(spiral.angle()));
+		const Number<Inexact> tanAlpha = std::abs(std::tan(spiral.angle()));
+		Number<Inexact> t = 0;
+		while (true) {
+			const Number<Inexact> r = spiral.evaluate(t).r();
+			const Number<Inexact> sinQuarterTurn = std::sqrt(tolerance * sinAlpha / (2 * r));
+			const Number<Inexact> turn =
+			    sinQuarterTurn < 1 ? 4 * std::asin(sinQuarterTurn) : Number<Inexact>(M_PI);
+			const Number<Inexact> tNext = t + std::min(turn, Number<Inexact>(M_PI / 2)) / tanAlpha;
+			// the second condition guards against steps that are too small to
+			// make progress, which would otherwise loop forever
+			if (tNext >= tEnd || !(tNext > t)) {
 				break;
 			}
-			points.push_back(polar);
+			t = tNext;
+			vertices.push_back(spiral.evaluate(t));
 		}
 	}
-	points.push_back(parent);
-
-	Vector<Inexact> offset = root - CGAL::ORIGIN;
-	//std::cout << points.size() << "spiral coordinates ";
-	//for (int i = 0; i < points.size(); ++i) {
-	//	std::cout << points[i] << " ";
-	//}
-	//std::cout << std::endl;
-	for (int i = 0; i + 1 < points.size(); ++i) {
-		renderer.draw(Segment<Inexact>(points[i].toCartesian() + offset,
-		                               points[i + 1].toCartesian() + offset));
-	}
+
+	vertices.push_back(parent);
+	return vertices;
 }
 
 } // namespace cartocrow::flow_map
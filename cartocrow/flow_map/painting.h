@@ -3,10 +3,13 @@
 
 #include "../renderer/geometry_painting.h"
 #include "../renderer/geometry_renderer.h"
+#include "../renderer/render_path.h"
 #include "spiral.h"
 
 #include "spiral_tree.h"
 
+#include <vector>
+
 namespace cartocrow::flow_map {
 
 /// The \ref renderer::GeometryPainting "GeometryPainting" for a spiral tree.
@@ -15,13 +18,32 @@ class Painting : public renderer::GeometryPainting {
   public:
 	/// Options that determine what to draw in the painting.
 	struct Options {
-		double spiralStep = 0.01;
+		/// The maximum distance between a drawn flow edge and the spiral it
+		/// represents, as a fraction of the stroke width of the flow.
+		///
+		/// Spirals are drawn as polylines; their vertices are placed such that
+		/// this bound holds. Sharper turns (closer to the root) therefore
+		/// receive more vertices than nearly straight parts. This needs to be
+		/// positive; the constructor throws otherwise.
+		double spiralTolerance = 0.05;
+		/// The maximum parameter \f$t\f$ up to which spirals are drawn.
 		double spiralMax = 6.0;
+		/// Deprecated and ignored: spirals used to be sampled at this fixed
+		/// parameter step. Use \ref spiralTolerance instead.
+		double spiralStep = 0.01;
 	};
 
-	/// Creates a new painting with the given map and tree.
+	/// Creates a new painting with the given map and tree. Throws if
+	/// \ref Options::spiralTolerance is not positive.
 	Painting(std::shared_ptr<RegionMap> map, std::shared_ptr<SpiralTree> tree, const Options options);
 
+	/// Approximates the given spiral, from its anchor to \c parent (but not
+	/// beyond parameter \c tMax), by a polyline that deviates at most
+	/// \c tolerance from the spiral. Returns the vertices of the polyline,
+	/// which all lie on the spiral except possibly the last one.
+	static std::vector<PolarPoint> flattenSpiral(const Spiral& spiral, const PolarPoint& parent,
+	                                             Number<Inexact> tolerance, Number<Inexact> tMax);
+
   protected:
 	void paint(renderer::GeometryRenderer& renderer) const override;
 
@@ -31,8 +53,11 @@ class Painting : public renderer::GeometryPainting {
 	void paintNodes(renderer::GeometryRenderer& renderer) const;
 	void paintFlow(renderer::GeometryRenderer& renderer) const;
 
-	void paintSpiral(renderer::GeometryRenderer& renderer, const Spiral& spiral,
-	                 const Point<Inexact>& offset, const PolarPoint& parent) const;
+	/// Appends a polyline approximating the given spiral, from its anchor to
+	/// \c parent, to \c path, such that the polyline deviates at most
+	/// \c tolerance from the spiral.
+	void paintSpiral(renderer::RenderPath& path, const Spiral& spiral, const Point<Inexact>& offset,
+	                 const PolarPoint& parent, Number<Inexact> tolerance) const;
 
 	std::shared_ptr<RegionMap> m_map;
 	std::shared_ptr<SpiralTree> m_tree;
@@ -21,11 +21,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "reachable_region_algorithm.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <optional>
 #include <ostream>
 
 #include "../core/core.h"
+#include "../core/parallel.h"
 #include "intersections.h"
 #include "polar_point.h"
 #include "polar_segment.h"
@@ -99,13 +102,15 @@ void ReachableRegionAlgorithm::NodeEvent::handle() {
 	using enum SweepEdgeShape::Type;
 
 	// TODO
-	std::cout << "> \033[1mhandling \033[33mnode event\033[0m\n";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{240, 120, 0}, 1);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "node");
+	if (m_alg->m_debugOutput) {
+		std::cout << "> \033[1mhandling \033[33mnode event\033[0m\n";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{240, 120, 0}, 1);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "node");
+	}
 
 	SweepInterval* interval = m_alg->m_circle.intervalAt(m_node->m_position.phi());
 	if (interval->type() == SweepInterval::Type::REACHABLE) {
@@ -121,27 +126,29 @@ ReachableRegionAlgorithm::VertexEvent::VertexEvent(PolarPoint position, std::sha
 void ReachableRegionAlgorithm::VertexEvent::handle() {
 	using enum SweepInterval::Type;
 
-	std::string side = "";
-	switch (m_side) {
-	case Side::LEFT:
-		side = "left";
-		break;
-	case Side::RIGHT:
-		side = "right";
-		break;
-	case Side::NEAR:
-		side = "near";
-		break;
-	case Side::FAR:
-		side = "far";
-	}
-	std::cout << "> \033[1mhandling \033[35m" << side << " vertex event\033[0m\n";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{150, 150, 150}, 0.5);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), side);
+	if (m_alg->m_debugOutput) {
+		std::string side = "";
+		switch (m_side) {
+		case Side::LEFT:
+			side = "left";
+			break;
+		case Side::RIGHT:
+			side = "right";
+			break;
+		case Side::NEAR:
+			side = "near";
+			break;
+		case Side::FAR:
+			side = "far";
+		}
+		std::cout << "> \033[1mhandling \033[35m" << side << " vertex event\033[0m\n";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{150, 150, 150}, 0.5);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), side);
+	}
 
 	if (m_side == Side::LEFT) {
 		handleLeft();
@@ -314,13 +321,15 @@ void ReachableRegionAlgorithm::JoinEvent::handle() {
 	std::shared_ptr<SweepEdge> rightEdge = m_rightEdge.lock();
 	std::shared_ptr<SweepEdge> leftEdge = m_leftEdge.lock();
 
-	std::cout << "> \033[1mhandling \033[34mjoin event\033[0m\n";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{0, 120, 240}, 1);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "join");
+	if (m_alg->m_debugOutput) {
+		std::cout << "> \033[1mhandling \033[34mjoin event\033[0m\n";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{0, 120, 240}, 1);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "join");
+	}
 
 	SweepInterval* previousInterval = rightEdge->previousInterval();
 	SweepInterval* interval = rightEdge->nextInterval();
@@ -380,54 +389,242 @@ bool ReachableRegionAlgorithm::JoinEvent::isValid() const {
 
 ReachableRegionAlgorithm::ReachableRegionAlgorithm(std::shared_ptr<SpiralTree> tree)
     : m_tree(tree), m_debugPainting(std::make_shared<renderer::PaintingRenderer>()),
-      m_circle(SweepInterval::Type::REACHABLE) {}
+      m_debugOutput(false), m_threadCount(1), m_circle(SweepInterval::Type::REACHABLE) {}
 
 ReachableRegionAlgorithm::ReachableRegion ReachableRegionAlgorithm::run() {
 
-	std::cout << "\033[1m──────────────────────────────────────────────────────────\033[0m\n"
-	          << "\033[1m Step 1: Outwards sweep to construct the reachable region \033[0m\n"
-	          << "\033[1m──────────────────────────────────────────────────────────\033[0m\n";
+	if (m_debugOutput) {
+		std::cout << "\033[1m──────────────────────────────────────────────────────────\033[0m\n"
+		          << "\033[1m Step 1: Outwards sweep to construct the reachable region \033[0m\n"
+		          << "\033[1m──────────────────────────────────────────────────────────\033[0m\n";
+	}
 
-	// insert all nodes into the event queue
-	for (const std::shared_ptr<Node>& node : m_tree->nodes()) {
-		if (node->m_position.r() > 0) {
-			m_queue.push(std::make_shared<NodeEvent>(node, this));
+	m_vertices.clear();
+	m_reachableNodes.clear();
+	m_statistics = SweepStatistics{};
+
+	const int threadCount = effectiveThreadCount(m_threadCount);
+	std::vector<std::shared_ptr<Node>> unobstructedNodes;
+	std::vector<Sector> sectors;
+	if (threadCount > 1 && !m_debugOutput) {
+		sectors = computeSectors(unobstructedNodes);
+	}
+
+	if (sectors.empty()) {
+		Sector all;
+		for (SpiralTree::Obstacle& obstacle : m_tree->obstacles()) {
+			all.obstacles.push_back(&obstacle);
+		}
+		for (const std::shared_ptr<Node>& node : m_tree->nodes()) {
+			if (node->m_position.r() > 0) {
+				all.nodes.push_back(node);
+			}
 		}
+		sweep(all);
+		return {m_vertices, m_reachableNodes};
+	}
+
+	// sweep every sector with its own instance of the algorithm; each obstacle
+	// (and therefore each of its sweep edges) belongs to exactly one sector,
+	// so the sweeps do not share any mutable state
+	std::vector<std::unique_ptr<ReachableRegionAlgorithm>> parts;
+	for (int i = 0; i < sectors.size(); i++) {
+		parts.push_back(std::make_unique<ReachableRegionAlgorithm>(m_tree));
+	}
+	parallel_for(static_cast<int>(sectors.size()), threadCount,
+	             [&parts, &sectors](int i) { parts[i]->sweep(sectors[i]); });
+
+	// stitch the results of the sectors together
+	m_reachableNodes = std::move(unobstructedNodes);
+	for (const auto& part : parts) {
+		m_vertices.insert(m_vertices.end(), part->m_vertices.begin(), part->m_vertices.end());
+		m_reachableNodes.insert(m_reachableNodes.end(), part->m_reachableNodes.begin(),
+		                        part->m_reachableNodes.end());
+		m_statistics.handledEvents += part->m_statistics.handledEvents;
+		m_statistics.skippedEvents += part->m_statistics.skippedEvents;
+		m_statistics.sweeps += part->m_statistics.sweeps;
+		m_statistics.peakQueueSize =
+		    std::max(m_statistics.peakQueueSize, part->m_statistics.peakQueueSize);
+	}
+	std::stable_sort(m_vertices.begin(), m_vertices.end(),
+	                 [](const UnreachableRegionVertex& a, const UnreachableRegionVertex& b) {
+		                 return a.m_location.r() < b.m_location.r();
+	                 });
+	std::stable_sort(m_reachableNodes.begin(), m_reachableNodes.end(),
+	                 [](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b) {
+		                 return a->m_position.r() < b->m_position.r();
+	                 });
+
+	return {m_vertices, m_reachableNodes};
+}
+
+void ReachableRegionAlgorithm::sweep(const Sector& sector) {
+	m_statistics.sweeps++;
+
+	// insert all nodes into the event queue
+	for (const std::shared_ptr<Node>& node : sector.nodes) {
+		m_queue.push(std::make_shared<NodeEvent>(node, this));
 	}
 
 	// insert all obstacle vertices into the event queue
-	for (SpiralTree::Obstacle& obstacle : m_tree->obstacles()) {
-		for (auto e = obstacle.begin(); e != obstacle.end(); e++) {
+	for (SpiralTree::Obstacle* obstacle : sector.obstacles) {
+		for (auto e = obstacle->begin(); e != obstacle->end(); e++) {
 			std::shared_ptr<SweepEdge> e1 = *e;
-			std::shared_ptr<SweepEdge> e2 = ++e == obstacle.end() ? *obstacle.begin() : *e;
+			std::shared_ptr<SweepEdge> e2 = ++e == obstacle->end() ? *obstacle->begin() : *e;
 			m_queue.push(std::make_shared<VertexEvent>(e2->shape().start(), e1, e2, this));
 			e--;
 		}
 	}
 
-	m_circle.print();
+	if (m_debugOutput) {
+		m_circle.print();
+	}
+	m_statistics.peakQueueSize = std::max(m_statistics.peakQueueSize, m_queue.size());
 	// main loop, handle all events
 	while (!m_queue.empty()) {
 		std::shared_ptr<Event> event = m_queue.top();
 		m_queue.pop();
 		if (!event->isValid()) {
+			m_statistics.skippedEvents++;
 			continue;
 		}
-		if (m_circle.edges().empty()) {
-			m_circle.m_onlyInterval->paintSweepShape(*m_debugPainting, m_circle.r(), event->r());
-		} else {
-			for (const auto& edge : m_circle.edges()) {
-				edge->nextInterval()->paintSweepShape(*m_debugPainting, m_circle.r(), event->r());
+		if (m_debugOutput) {
+			if (m_circle.edges().empty()) {
+				m_circle.m_onlyInterval->paintSweepShape(*m_debugPainting, m_circle.r(), event->r());
+			} else {
+				for (const auto& edge : m_circle.edges()) {
+					edge->nextInterval()->paintSweepShape(*m_debugPainting, m_circle.r(), event->r());
+				}
 			}
 		}
 		m_circle.grow(event->r());
-		m_circle.print();
+		if (m_debugOutput) {
+			m_circle.print();
+		}
 		event->handle();
-		m_circle.print();
+		m_statistics.handledEvents++;
+		m_statistics.peakQueueSize = std::max(m_statistics.peakQueueSize, m_queue.size());
+		if (m_debugOutput) {
+			m_circle.print();
+		}
 		assert(m_circle.isValid());
 	}
+}
 
-	return {m_vertices, m_reachableNodes};
+std::vector<ReachableRegionAlgorithm::Sector>
+ReachableRegionAlgorithm::computeSectors(std::vector<std::shared_ptr<Node>>& unobstructedNodes) {
+	struct Extent {
+		Number<Inexact> from;
+		Number<Inexact> to;
+		std::vector<SpiralTree::Obstacle*> obstacles;
+	};
+
+	std::vector<Extent> extents;
+	for (SpiralTree::Obstacle& obstacle : m_tree->obstacles()) {
+		auto extent = angularExtent(obstacle);
+		if (!extent) {
+			return {};
+		}
+		// normalize such that the extent starts in [0, 2π)
+		const Number<Inexact> shift = wrapAngle(extent->first) - extent->first;
+		extents.push_back({extent->first + shift, extent->second + shift, {&obstacle}});
+	}
+	if (extents.size() < 2) {
+		return {};
+	}
+
+	// merge overlapping extents, first linearly and then around 2π
+	std::sort(extents.begin(), extents.end(),
+	          [](const Extent& a, const Extent& b) { return a.from < b.from; });
+	std::vector<Extent> merged;
+	for (Extent& extent : extents) {
+		if (!merged.empty() && extent.from <= merged.back().to) {
+			merged.back().to = std::max(merged.back().to, extent.to);
+			merged.back().obstacles.insert(merged.back().obstacles.end(),
+			                               extent.obstacles.begin(), extent.obstacles.end());
+		} else {
+			merged.push_back(std::move(extent));
+		}
+	}
+	while (merged.size() > 1 && merged.back().to >= merged.front().from + M_2xPI) {
+		merged.back().to = std::max(merged.back().to, merged.front().to + M_2xPI);
+		merged.back().obstacles.insert(merged.back().obstacles.end(),
+		                               merged.front().obstacles.begin(),
+		                               merged.front().obstacles.end());
+		merged.erase(merged.begin());
+	}
+	if (merged.size() < 2) {
+		return {};
+	}
+
+	std::vector<Sector> sectors(merged.size());
+	for (int i = 0; i < merged.size(); i++) {
+		sectors[i].obstacles = std::move(merged[i].obstacles);
+	}
+	for (const std::shared_ptr<Node>& node : m_tree->nodes()) {
+		if (node->m_position.r() <= 0) {
+			continue;
+		}
+		const Number<Inexact> phi = wrapAngle(node->m_position.phi());
+		std::optional<int> sector;
+		// only the last extent can extend past 2π
+		for (const Number<Inexact> angle : {phi, phi + M_2xPI}) {
+			auto after = std::upper_bound(merged.begin(), merged.end(), angle,
+			                              [](Number<Inexact> a, const Extent& extent) {
+				                              return a < extent.from;
+			                              });
+			if (after != merged.begin() && angle <= std::prev(after)->to) {
+				sector = std::prev(after) - merged.begin();
+				break;
+			}
+		}
+		if (sector) {
+			sectors[*sector].nodes.push_back(node);
+		} else {
+			unobstructedNodes.push_back(node);
+		}
+	}
+	return sectors;
+}
+
+std::optional<std::pair<Number<Inexact>, Number<Inexact>>>
+ReachableRegionAlgorithm::angularExtent(const SpiralTree::Obstacle& obstacle) {
+	if (obstacle.empty()) {
+		return std::nullopt;
+	}
+	// walk around the obstacle, tracking the total change in φ
+	const Number<Inexact> startPhi = obstacle.front()->shape().start().phi();
+	Number<Inexact> phi = startPhi;
+	Number<Inexact> from = phi;
+	Number<Inexact> to = phi;
+	for (const std::shared_ptr<SweepEdge>& edge : obstacle) {
+		const SweepEdgeShape& shape = edge->shape();
+		if (shape.type() != SweepEdgeShape::Type::SEGMENT || !shape.end() ||
+		    shape.start().r() == 0 || shape.end()->r() == 0) {
+			return std::nullopt;
+		}
+		phi += wrapAngle(shape.end()->phi() - shape.start().phi(), -M_PI);
+		from = std::min(from, phi);
+		to = std::max(to, phi);
+	}
+	// if we did not end up where we started, the obstacle winds around the
+	// origin
+	if (std::abs(phi - startPhi) > M_PI || to - from >= M_2xPI) {
+		return std::nullopt;
+	}
+	return std::make_pair(from, to);
+}
+
+const SweepStatistics& ReachableRegionAlgorithm::statistics() const {
+	return m_statistics;
+}
+
+void ReachableRegionAlgorithm::setDebugOutput(bool enabled) {
+	m_debugOutput = enabled;
+}
+
+void ReachableRegionAlgorithm::setThreadCount(int threadCount) {
+	m_threadCount = threadCount;
 }
 
 std::shared_ptr<renderer::GeometryPainting> ReachableRegionAlgorithm::debugPainting() {
@@ -22,6 +22,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_FLOW_MAP_REACHABLE_REGION_ALGORTIHM_H
 #define CARTOCROW_FLOW_MAP_REACHABLE_REGION_ALGORTIHM_H
 
+#include <optional>
+#include <utility>
 #include <variant>
 
 #include "../renderer/geometry_painting.h"
@@ -29,6 +31,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cartocrow/flow_map/node.h"
 #include "spiral_tree.h"
 #include "sweep_circle.h"
+#include "sweep_statistics.h"
 
 namespace cartocrow::flow_map {
 
@@ -74,6 +77,17 @@ namespace cartocrow::flow_map {
 ///
 /// See the linked class documentation for detailed descriptions of these event
 /// types.
+///
+/// ## Angular sectors
+///
+/// A point is unreachable only if the straight line segment from the point to
+/// the origin hits an obstacle. Hence, if the angular extents (as seen from the
+/// origin) of the obstacles can be split into groups that do not overlap, each
+/// group can be swept separately: the unreachable region is the union of the
+/// unreachable regions of the groups, and a node that does not lie in the
+/// angular extent of any group is always reachable. If more than one thread is
+/// allowed (see \ref setThreadCount()), these groups, or *sectors*, are swept
+/// concurrently and their results are merged afterwards.
 class ReachableRegionAlgorithm {
 
   public:
@@ -107,13 +121,52 @@ class ReachableRegionAlgorithm {
 	/// Runs the algorithm.
 	ReachableRegion run();
 
+	/// Enables or disables debug output. If enabled, \ref run() draws
+	/// information about the algorithm run into the \ref debugPainting() and
+	/// traces the handled events to \c std::cout.
+	/// Debug output is disabled by default, as it is expensive for large
+	/// inputs. It does not influence the result of the algorithm.
+	void setDebugOutput(bool enabled);
+
+	/// Sets the number of threads used to sweep independent angular sectors
+	/// (see the class documentation). The default is 1, which sweeps all
+	/// obstacles at once; 0 uses one thread per hardware thread. Debug output
+	/// always uses a single sweep.
+	void setThreadCount(int threadCount);
+
 	/// Returns a \ref GeometryPainting that shows some debug information. This
 	/// painting shows some debug information about the algorithm run. If this
-	/// method is called before \ref run(), this will result in an empty
-	/// painting.
+	/// method is called before \ref run(), or if debug output is disabled
+	/// (see \ref setDebugOutput()), this will result in an empty painting.
 	std::shared_ptr<renderer::GeometryPainting> debugPainting();
 
+	/// Returns statistics about the last run of the algorithm (see \ref
+	/// SweepStatistics).
+	const SweepStatistics& statistics() const;
+
   private:
+	/// A group of obstacles whose angular extent does not overlap with that of
+	/// any other group, together with the nodes within that extent.
+	struct Sector {
+		/// The obstacles in this sector.
+		std::vector<SpiralTree::Obstacle*> obstacles;
+		/// The nodes in this sector.
+		std::vector<std::shared_ptr<Node>> nodes;
+	};
+
+	/// Splits the obstacles of the tree into sectors. Nodes that do not lie in
+	/// any sector are added to \c unobstructedNodes. Returns an empty list if
+	/// the obstacles cannot be split, that is, if they would form a single
+	/// sector, or if some obstacle surrounds or touches the origin.
+	std::vector<Sector> computeSectors(std::vector<std::shared_ptr<Node>>& unobstructedNodes);
+	/// Computes the angular extent \f$[\phi_1, \phi_2]\f$ of the given
+	/// obstacle, with \f$\phi_2 - \phi_1 < 2\pi\f$. Returns \c std::nullopt
+	/// if the obstacle surrounds or touches the origin.
+	static std::optional<std::pair<Number<Inexact>, Number<Inexact>>>
+	angularExtent(const SpiralTree::Obstacle& obstacle);
+	/// Runs the sweep for the obstacles and nodes in the given sector.
+	void sweep(const Sector& sector);
+
 	/// The spiral tree we are computing.
 	std::shared_ptr<SpiralTree> m_tree;
 	/// Unreachable region vertices we've seen so far.
@@ -335,6 +388,12 @@ class ReachableRegionAlgorithm {
 	/// A painting that contains sweep shapes for each sweep interval
 	/// encountered during the execution of the algorithm.
 	std::shared_ptr<renderer::PaintingRenderer> m_debugPainting;
+	/// Whether to produce debug output (see \ref setDebugOutput()).
+	bool m_debugOutput;
+	/// The number of threads to use (see \ref setThreadCount()).
+	int m_threadCount;
+	/// Statistics about the algorithm run (see \ref statistics()).
+	SweepStatistics m_statistics;
 };
 
 } // namespace cartocrow::flow_map
@@ -21,8 +21,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "smooth_tree.h"
 
+#include "cartocrow/core/parallel.h"
 #include "cartocrow/flow_map/smooth_tree_painting.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace cartocrow::flow_map {
@@ -41,6 +44,8 @@ SmoothTree::SmoothTree(const std::shared_ptr<SpiralTree> spiralTree)
 	for (int i = 0; i < m_nodes.size(); i++) {
 		m_nodes[i]->m_id = i;
 	}
+
+	buildObstacleGrid();
 }
 
 std::shared_ptr<Node> SmoothTree::constructSmoothTree(const std::shared_ptr<Node>& node,
@@ -82,18 +87,111 @@ const std::vector<std::shared_ptr<Node>>& SmoothTree::nodes() const {
 	return m_nodes;
 }
 
+void SmoothTree::setObstacleCutoff(Number<Inexact> cutoff) {
+	m_obstacleCutoff = cutoff;
+}
+
+void SmoothTree::buildObstacleGrid() {
+	m_obstacleGrid = ObstacleGrid{};
+	std::vector<int> leaves;
+	std::vector<Point<Inexact>> positions;
+	for (int i = 0; i < m_nodes.size(); i++) {
+		if (m_nodes[i]->getType() == Node::ConnectionType::kLeaf) {
+			leaves.push_back(i);
+			positions.push_back(m_nodes[i]->m_position.toCartesian());
+		}
+	}
+	if (leaves.empty()) {
+		return;
+	}
+
+	Number<Inexact> xMin = positions[0].x();
+	Number<Inexact> xMax = positions[0].x();
+	Number<Inexact> yMin = positions[0].y();
+	Number<Inexact> yMax = positions[0].y();
+	for (const Point<Inexact>& position : positions) {
+		xMin = std::min(xMin, position.x());
+		xMax = std::max(xMax, position.x());
+		yMin = std::min(yMin, position.y());
+		yMax = std::max(yMax, position.y());
+	}
+
+	// aim for roughly as many cells as obstacles, but don't make the cells
+	// smaller than the buffer size, as every node looks at least that far
+	ObstacleGrid& grid = m_obstacleGrid;
+	const Number<Inexact> extent = std::max(xMax - xMin, yMax - yMin);
+	grid.cellSize = std::max(m_bufferSize, extent / std::sqrt(leaves.size()));
+	grid.origin = Point<Inexact>(xMin, yMin);
+	grid.columns = static_cast<int>(std::floor((xMax - xMin) / grid.cellSize)) + 1;
+	grid.rows = static_cast<int>(std::floor((yMax - yMin) / grid.cellSize)) + 1;
+
+	auto cellOf = [&grid](const Point<Inexact>& p) {
+		const int column = std::min(
+		    static_cast<int>((p.x() - grid.origin.x()) / grid.cellSize), grid.columns - 1);
+		const int row =
+		    std::min(static_cast<int>((p.y() - grid.origin.y()) / grid.cellSize), grid.rows - 1);
+		return row * grid.columns + column;
+	};
+
+	// counting sort of the obstacles by cell
+	grid.cellStart.assign(grid.columns * grid.rows + 1, 0);
+	for (const Point<Inexact>& position : positions) {
+		grid.cellStart[cellOf(position) + 1]++;
+	}
+	for (int c = 0; c < grid.columns * grid.rows; c++) {
+		grid.cellStart[c + 1] += grid.cellStart[c];
+	}
+	grid.obstacles.resize(leaves.size());
+	grid.positions.resize(leaves.size());
+	std::vector<int> next(grid.cellStart.begin(), grid.cellStart.end() - 1);
+	for (int k = 0; k < leaves.size(); k++) {
+		const int index = next[cellOf(positions[k])]++;
+		grid.obstacles[index] = leaves[k];
+		grid.positions[index] = positions[k];
+	}
+}
+
+template <typename F>
+void SmoothTree::forEachObstacleNear(const Point<Inexact>& p, Number<Inexact> radius, F f) const {
+	const ObstacleGrid& grid = m_obstacleGrid;
+	if (grid.obstacles.empty()) {
+		return;
+	}
+	auto clampedCell = [&grid](Number<Inexact> coordinate, int count) {
+		return static_cast<int>(
+		    std::clamp(std::floor(coordinate / grid.cellSize), 0.0, count - 1.0));
+	};
+	const int columnMin = clampedCell(p.x() - radius - grid.origin.x(), grid.columns);
+	const int columnMax = clampedCell(p.x() + radius - grid.origin.x(), grid.columns);
+	const int rowMin = clampedCell(p.y() - radius - grid.origin.y(), grid.rows);
+	const int rowMax = clampedCell(p.y() + radius - grid.origin.y(), grid.rows);
+	for (int row = rowMin; row <= rowMax; row++) {
+		for (int column = columnMin; column <= columnMax; column++) {
+			const int cell = row * grid.columns + column;
+			for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; k++) {
+				f(grid.obstacles[k], grid.positions[k]);
+			}
+		}
+	}
+}
+
+Number<Inexact> SmoothTree::obstacleRadius(int i) const {
+	return std::min(m_nodes[i]->m_flow + m_bufferSize, m_obstacleCutoff);
+}
+
 Number<Inexact> SmoothTree::computeObstacleCost() {
 	Number<Inexact> cost = 0;
 	for (int i = 0; i < m_nodes.size(); i++) {
 		const auto& node = m_nodes[i];
 		if (node->getType() == Node::ConnectionType::kSubdivision ||
 		    node->getType() == Node::ConnectionType::kJoin) {
-			for (int j = 0; j < m_nodes.size(); j++) {
-				const auto& obstacle = m_nodes[j];
-				if (obstacle->getType() == Node::ConnectionType::kLeaf) {
-					cost += computeObstacleCost(i, node->m_flow, obstacle->m_position);
+			const Point<Inexact> p = node->m_position.toCartesian();
+			const Number<Inexact> radius = obstacleRadius(i);
+			forEachObstacleNear(p, radius, [&](int j, const Point<Inexact>& position) {
+				if (CGAL::squared_distance(p, position) < radius * radius) {
+					cost += computeObstacleCost(i, node->m_flow, m_nodes[j]->m_position);
 				}
-			}
+			});
 		}
 	}
 	return cost;
@@ -114,6 +212,29 @@ Number<Inexact> SmoothTree::computeObstacleCost(int i, Number<Inexact> thickness
 	}
 }
 
+void SmoothTree::applyObstacleGradient(std::vector<PolarGradient>& gradient, int i,
+                                       Number<Inexact> thickness, PolarPoint obstacle) {
+	PolarPoint n = m_nodes[i]->m_position;
+	Number<Inexact> d = std::sqrt((n.toCartesian() - obstacle.toCartesian()).squared_length());
+	if (d == 0) {
+		return;
+	}
+
+	Number<Inexact> dCostDD;
+	if (d < thickness) {
+		dCostDD = -thickness * (m_bufferSize / 2 + thickness) / (m_bufferSize * d * d) +
+		          (m_bufferSize / 2 - thickness) / (m_bufferSize * thickness);
+	} else if (d < thickness + m_bufferSize) {
+		dCostDD = -2 / m_bufferSize * (1 - (d - thickness) / m_bufferSize);
+	} else {
+		return;
+	}
+
+	Number<Inexact> dPhi = n.phi() - obstacle.phi();
+	gradient[i].r += dCostDD * (n.r() - obstacle.r() * std::cos(dPhi)) / d;
+	gradient[i].phi += dCostDD * n.r() * obstacle.r() * std::sin(dPhi) / d;
+}
+
 Number<Inexact> SmoothTree::computeSmoothingCost() {
 	Number<Inexact> cost = 0;
 	for (int i = 0; i < m_nodes.size(); i++) {
@@ -133,24 +254,25 @@ Number<Inexact> SmoothTree::computeSmoothingCost(int i, int iParent, int iChild)
 	return m_smoothingFactor * std::pow(Spiral::alpha(p, n) - Spiral::alpha(n, c), 2);
 }
 
-void SmoothTree::applySmoothingGradient(int i, int iParent, int iChild) {
+void SmoothTree::applySmoothingGradient(std::vector<PolarGradient>& gradient, int i, int iParent,
+                                        int iChild) {
 	PolarPoint n = m_nodes[i]->m_position;
 	PolarPoint p = m_nodes[iParent]->m_position;
 	PolarPoint c = m_nodes[iChild]->m_position;
 
-	m_gradient[i].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[i].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                   (Spiral::dAlphaDR2(p, n) - Spiral::dAlphaDR1(n, c));
-	m_gradient[i].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[i].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                     (Spiral::dAlphaDPhi2(p, n) - Spiral::dAlphaDPhi1(n, c));
 
-	m_gradient[iParent].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[iParent].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                         Spiral::dAlphaDR1(p, n);
-	m_gradient[iParent].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[iParent].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                           Spiral::dAlphaDPhi1(p, n);
 
-	m_gradient[iChild].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[iChild].r += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                        -Spiral::dAlphaDR2(n, c);
-	m_gradient[iChild].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
+	gradient[iChild].phi += 2 * m_smoothingFactor * (Spiral::alpha(p, n) - Spiral::alpha(n, c)) *
 	                          -Spiral::dAlphaDPhi2(n, c);
 }
 
@@ -175,26 +297,27 @@ Number<Inexact> SmoothTree::computeAngleRestrictionCost(int i, int iChild1, int
 	                                    std::log(1.0 / std::cos(Spiral::alpha(n, c2))));
 }
 
-void SmoothTree::applyAngleRestrictionGradient(int i, int iChild1, int iChild2) {
+void SmoothTree::applyAngleRestrictionGradient(std::vector<PolarGradient>& gradient, int i,
+                                               int iChild1, int iChild2) {
 	PolarPoint n = m_nodes[i]->m_position;
 	PolarPoint c1 = m_nodes[iChild1]->m_position;
 	PolarPoint c2 = m_nodes[iChild2]->m_position;
 
-	m_gradient[i].r +=
+	gradient[i].r +=
 	    m_angle_restrictionFactor * (Spiral::dAlphaDR1(n, c1) * std::tan(Spiral::alpha(n, c1)) +
 	                                 Spiral::dAlphaDR1(n, c2) * std::tan(Spiral::alpha(n, c2)));
-	m_gradient[i].phi +=
+	gradient[i].phi +=
 	    m_angle_restrictionFactor * (Spiral::dAlphaDPhi1(n, c1) * std::tan(Spiral::alpha(n, c1)) +
 	                                 Spiral::dAlphaDPhi1(n, c2) * std::tan(Spiral::alpha(n, c2)));
 
-	m_gradient[iChild1].r +=
+	gradient[iChild1].r +=
 	    m_angle_restrictionFactor * Spiral::dAlphaDR2(n, c1) * std::tan(Spiral::alpha(n, c1));
-	m_gradient[iChild1].phi +=
+	gradient[iChild1].phi +=
 	    m_angle_restrictionFactor * Spiral::dAlphaDPhi2(n, c1) * std::tan(Spiral::alpha(n, c1));
 
-	m_gradient[iChild2].r +=
+	gradient[iChild2].r +=
 	    m_angle_restrictionFactor * Spiral::dAlphaDR2(n, c2) * std::tan(Spiral::alpha(n, c2));
-	m_gradient[iChild2].phi +=
+	gradient[iChild2].phi +=
 	    m_angle_restrictionFactor * Spiral::dAlphaDPhi2(n, c2) * std::tan(Spiral::alpha(n, c2));
 }
 
@@ -219,30 +342,31 @@ Number<Inexact> SmoothTree::computeBalancingCost(int i, int iChild1, int iChild2
 	       std::log(1 / std::sin(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2))));
 }
 
-void SmoothTree::applyBalancingGradient(int i, int iChild1, int iChild2) {
+void SmoothTree::applyBalancingGradient(std::vector<PolarGradient>& gradient, int i, int iChild1,
+                                        int iChild2) {
 	PolarPoint n = m_nodes[i]->m_position;
 	PolarPoint c1 = m_nodes[iChild1]->m_position;
 	PolarPoint c2 = m_nodes[iChild2]->m_position;
 
-	m_gradient[i].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
+	gradient[i].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
 	                   (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                   (Spiral::dAlphaDR1(n, c1) - Spiral::dAlphaDR1(n, c2));
-	m_gradient[i].phi += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
+	gradient[i].phi += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
 	                     (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                     (Spiral::dAlphaDPhi1(n, c1) - Spiral::dAlphaDPhi1(n, c2));
 
-	m_gradient[iChild1].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
+	gradient[iChild1].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
 	                         (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                         Spiral::dAlphaDR2(n, c1);
-	m_gradient[iChild1].phi += m_angle_restrictionFactor *
+	gradient[iChild1].phi += m_angle_restrictionFactor *
 	                           -std::pow(std::tan(m_restrictingAngle), 2) *
 	                           (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                           Spiral::dAlphaDPhi2(n, c1);
 
-	m_gradient[iChild2].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
+	gradient[iChild2].r += m_angle_restrictionFactor * -std::pow(std::tan(m_restrictingAngle), 2) *
 	                         (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                         -Spiral::dAlphaDR2(n, c2);
-	m_gradient[iChild2].phi += m_angle_restrictionFactor *
+	gradient[iChild2].phi += m_angle_restrictionFactor *
 	                           -std::pow(std::tan(m_restrictingAngle), 2) *
 	                           (1 / std::tan(0.5 * (Spiral::alpha(n, c1) - Spiral::alpha(n, c2)))) *
 	                           -Spiral::dAlphaDPhi2(n, c2);
@@ -282,7 +406,8 @@ SmoothTree::computeStraighteningCost(int i, int iParent,
 	return m_straighteningFactor * std::pow(Spiral::alpha(p, n) - numerator / denominator, 2);
 }
 
-void SmoothTree::applyStraighteningGradient(int i, int iParent,
+void SmoothTree::applyStraighteningGradient(std::vector<PolarGradient>& gradient, int i,
+                                            int iParent,
                                             const std::vector<std::shared_ptr<Node>>& children) {
 	PolarPoint n = m_nodes[i]->m_position;
 	PolarPoint p = m_nodes[iParent]->m_position;
@@ -305,26 +430,26 @@ void SmoothTree::applyStraighteningGradient(int i, int iParent,
 			denominator += child->m_flow;
 		}
 	}
-	m_gradient[i].r += 2 * m_straighteningFactor * (Spiral::alpha(p, n) - numerator / denominator) *
+	gradient[i].r += 2 * m_straighteningFactor * (Spiral::alpha(p, n) - numerator / denominator) *
 	                   (Spiral::dAlphaDR2(p, n) - numeratorDR1 / denominator);
-	m_gradient[i].phi += 2 * m_straighteningFactor *
+	gradient[i].phi += 2 * m_straighteningFactor *
 	                     (Spiral::alpha(p, n) - numerator / denominator) *
 	                     (Spiral::dAlphaDPhi2(p, n) - numeratorDPhi1 / denominator);
 
-	m_gradient[iParent].r += 2 * m_straighteningFactor *
+	gradient[iParent].r += 2 * m_straighteningFactor *
 	                         (Spiral::alpha(p, n) - numerator / denominator) *
 	                         Spiral::dAlphaDR1(p, n);
-	m_gradient[iParent].phi += 2 * m_straighteningFactor *
+	gradient[iParent].phi += 2 * m_straighteningFactor *
 	                           (Spiral::alpha(p, n) - numerator / denominator) *
 	                           Spiral::dAlphaDPhi1(p, n);
 
 	for (const auto& child : children) {
 		if (child->m_flow > maxFlow) {
 			PolarPoint c = child->m_position;
-			m_gradient[child->m_id].r += 2 * m_straighteningFactor *
+			gradient[child->m_id].r += 2 * m_straighteningFactor *
 			                             (Spiral::alpha(p, n) - numerator / denominator) *
 			                             -child->m_flow * Spiral::dAlphaDR2(n, c) / denominator;
-			m_gradient[child->m_id].phi += 2 * m_straighteningFactor *
+			gradient[child->m_id].phi += 2 * m_straighteningFactor *
 			                               (Spiral::alpha(p, n) - numerator / denominator) *
 			                               -child->m_flow * Spiral::dAlphaDPhi2(n, c) / denominator;
 		}
@@ -336,34 +461,195 @@ Number<Inexact> SmoothTree::computeCost() {
 	       computeBalancingCost() + computeStraighteningCost();
 }
 
-void SmoothTree::optimize() {
-	m_gradient = std::vector<PolarGradient>(m_nodes.size(), PolarGradient{});
-	for (int i = 0; i < m_nodes.size(); i++) {
+void SmoothTree::accumulateGradient(std::vector<PolarGradient>& gradient, int begin, int end) {
+	for (int i = begin; i < end; i++) {
 		const auto& node = m_nodes[i];
+		if (node->getType() == Node::ConnectionType::kSubdivision ||
+		    node->getType() == Node::ConnectionType::kJoin) {
+			const Point<Inexact> p = node->m_position.toCartesian();
+			const Number<Inexact> radius = obstacleRadius(i);
+			forEachObstacleNear(p, radius, [&](int j, const Point<Inexact>& position) {
+				if (CGAL::squared_distance(p, position) < radius * radius) {
+					applyObstacleGradient(gradient, i, node->m_flow, m_nodes[j]->m_position);
+				}
+			});
+		}
 		if (node->getType() == Node::ConnectionType::kSubdivision) {
-			applySmoothingGradient(i, m_nodes[i]->m_parent->m_id, m_nodes[i]->m_children[0]->m_id);
+			applySmoothingGradient(gradient, i, m_nodes[i]->m_parent->m_id,
+			                       m_nodes[i]->m_children[0]->m_id);
 		} else if (node->getType() == Node::ConnectionType::kJoin) {
 			applyAngleRestrictionGradient(
-			    i, m_nodes[i]->m_children[0]->m_id,
+			    gradient, i, m_nodes[i]->m_children[0]->m_id,
 			    m_nodes[i]->m_children[m_nodes[i]->m_children.size() - 1]->m_id);
 			applyBalancingGradient(
-			    i, m_nodes[i]->m_children[0]->m_id,
+			    gradient, i, m_nodes[i]->m_children[0]->m_id,
 			    m_nodes[i]->m_children[m_nodes[i]->m_children.size() - 1]->m_id);
-			applyStraighteningGradient(
-			    i, m_nodes[i]->m_parent->m_id,
-			    m_nodes[i]->m_children);
+			applyStraighteningGradient(gradient, i, m_nodes[i]->m_parent->m_id,
+			                           m_nodes[i]->m_children);
 		}
 	}
+}
+
+void SmoothTree::computeGradient(int threadCount) {
+	const int n = m_nodes.size();
+	m_gradient.assign(n, PolarGradient{});
+	// not worth starting threads for small trees
+	threadCount = std::min(effectiveThreadCount(threadCount), std::max(1, n / 256));
+	if (threadCount == 1) {
+		accumulateGradient(m_gradient, 0, n);
+		return;
+	}
+
+	// the cost terms of a node also contribute to the gradient of its
+	// neighbors, so each thread writes to its own buffer
+	m_threadGradients.resize(threadCount);
+	parallel_for(threadCount, threadCount, [this, n, threadCount](int t) {
+		const int begin = static_cast<long>(n) * t / threadCount;
+		const int end = static_cast<long>(n) * (t + 1) / threadCount;
+		m_threadGradients[t].assign(n, PolarGradient{});
+		accumulateGradient(m_threadGradients[t], begin, end);
+	});
+	for (const auto& threadGradient : m_threadGradients) {
+		for (int i = 0; i < n; i++) {
+			m_gradient[i].r += threadGradient[i].r;
+			m_gradient[i].phi += threadGradient[i].phi;
+		}
+	}
+}
+
+void SmoothTree::moveNodes(const std::vector<PolarPoint>& from, Number<Inexact> stepSize,
+                           bool moveJoinNodesRadially) {
+	for (int i = 0; i < m_nodes.size(); i++) {
+		PolarPoint position = from[i];
+		if (moveJoinNodesRadially && m_nodes[i]->getType() == Node::ConnectionType::kJoin) {
+			position.setR(position.r() - stepSize * m_gradient[i].r);
+		}
+		if (m_nodes[i]->getType() == Node::ConnectionType::kJoin ||
+		    m_nodes[i]->getType() == Node::ConnectionType::kSubdivision) {
+			position.setPhi(position.phi() - stepSize * m_gradient[i].phi);
+		}
+		m_nodes[i]->m_position = position;
+	}
+}
+
+Number<Inexact> SmoothTree::gradientSquaredLength(bool moveJoinNodesRadially) const {
+	Number<Inexact> length = 0;
 	for (int i = 0; i < m_nodes.size(); i++) {
-		Number<Inexact> epsilon = 0.0001; // TODO
-		if (m_nodes[i]->getType() == Node::ConnectionType::kJoin) {
-			//m_nodes[i]->m_position.setR(m_nodes[i]->m_position.r() - epsilon * m_gradient[i].r);
+		if (moveJoinNodesRadially && m_nodes[i]->getType() == Node::ConnectionType::kJoin) {
+			length += m_gradient[i].r * m_gradient[i].r;
 		}
 		if (m_nodes[i]->getType() == Node::ConnectionType::kJoin ||
 		    m_nodes[i]->getType() == Node::ConnectionType::kSubdivision) {
-			m_nodes[i]->m_position.setPhi(m_nodes[i]->m_position.phi() - epsilon * m_gradient[i].phi);
+			length += m_gradient[i].phi * m_gradient[i].phi;
 		}
 	}
+	return length;
+}
+
+std::vector<PolarPoint> SmoothTree::positions() const {
+	std::vector<PolarPoint> positions;
+	positions.reserve(m_nodes.size());
+	for (const auto& node : m_nodes) {
+		positions.push_back(node->m_position);
+	}
+	return positions;
+}
+
+void SmoothTree::setPositions(const std::vector<PolarPoint>& positions) {
+	for (int i = 0; i < m_nodes.size(); i++) {
+		m_nodes[i]->m_position = positions[i];
+	}
+}
+
+void SmoothTree::optimize() {
+	computeGradient(1);
+	Number<Inexact> epsilon = 0.0001; // TODO
+	moveNodes(positions(), epsilon, false);
+}
+
+SmoothTree::OptimizationResult SmoothTree::optimize(const OptimizationOptions& options) {
+	OptimizationResult result;
+
+	// x is the current solution, xPrevious the one before; the gradient step
+	// is taken from the look-ahead point y = x + momentum * (x - xPrevious)
+	std::vector<PolarPoint> x = positions();
+	std::vector<PolarPoint> xPrevious = x;
+	Number<Inexact> cost = computeCost();
+	result.costs.push_back(cost);
+	Number<Inexact> stepSize = options.initialStepSize;
+	int momentumIteration = 0;
+
+	while (result.iterations < options.maxIterations) {
+		result.iterations++;
+
+		const Number<Inexact> momentum = momentumIteration / (momentumIteration + 3.0);
+		std::vector<PolarPoint> y = x;
+		for (int i = 0; i < m_nodes.size(); i++) {
+			y[i].setR(x[i].r() + momentum * (x[i].r() - xPrevious[i].r()));
+			y[i].setPhi(x[i].phi() + momentum * wrapAngle(x[i].phi() - xPrevious[i].phi(), -M_PI));
+		}
+		setPositions(y);
+		const Number<Inexact> costY = momentumIteration == 0 ? cost : computeCost();
+		computeGradient(options.threadCount);
+		const Number<Inexact> gradientLength = gradientSquaredLength(options.moveJoinNodesRadially);
+		if (gradientLength == 0) {
+			if (momentumIteration == 0) {
+				result.converged = true;
+				break;
+			}
+			setPositions(x);
+			momentumIteration = 0;
+			xPrevious = x;
+			continue;
+		}
+
+		// backtracking line search until the Armijo condition holds (note that
+		// this also rejects steps where the cost becomes nan)
+		Number<Inexact> newCost = cost;
+		bool accepted = false;
+		while (stepSize >= options.minStepSize) {
+			moveNodes(y, stepSize, options.moveJoinNodesRadially);
+			newCost = computeCost();
+			if (newCost <= costY - 0.5 * stepSize * gradientLength) {
+				accepted = true;
+				break;
+			}
+			stepSize /= 2;
+		}
+
+		if (!accepted || newCost > cost) {
+			setPositions(x);
+			if (momentumIteration == 0) {
+				// even a plain gradient step doesn't help: give up
+				result.stalled = true;
+				break;
+			}
+			// the momentum overshot: restart from x without momentum
+			momentumIteration = 0;
+			xPrevious = x;
+			stepSize = std::max(stepSize, options.minStepSize) * 2;
+			continue;
+		}
+
+		xPrevious = std::move(x);
+		x = positions();
+		const Number<Inexact> decrease = cost - newCost;
+		cost = newCost;
+		result.costs.push_back(cost);
+		if (options.onIteration) {
+			options.onIteration(result.iterations, cost);
+		}
+		momentumIteration++;
+		// allow the step size to grow again
+		stepSize *= 2;
+
+		if (decrease <= options.tolerance * std::abs(cost)) {
+			result.converged = true;
+			break;
+		}
+	}
+
+	return result;
 }
 
 } // namespace cartocrow::flow_map
@@ -23,6 +23,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define CARTOCROW_FLOW_MAP_SMOOTH_TREE_H
 
 #include <deque>
+#include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <queue>
@@ -58,6 +60,66 @@ class SmoothTree {
 	/// Performs one optimization step.
 	void optimize();
 
+	/// Options for \ref optimize(const OptimizationOptions&).
+	struct OptimizationOptions {
+		/// The maximum number of iterations.
+		int maxIterations = 1000;
+		/// The optimization is considered converged when an iteration decreases
+		/// the cost by at most this fraction of the cost.
+		Number<Inexact> tolerance = 1e-9;
+		/// The step size that the first line search starts from.
+		Number<Inexact> initialStepSize = 1e-4;
+		/// The line search gives up if the step size drops below this value.
+		Number<Inexact> minStepSize = 1e-12;
+		/// Whether join nodes are allowed to move towards or away from the
+		/// root. (Subdivision nodes only ever move in the \f$\phi\f$
+		/// direction.)
+		bool moveJoinNodesRadially = true;
+		/// The number of threads used to compute the gradient, or `0` to use
+		/// the number of hardware threads.
+		int threadCount = 0;
+		/// If set, this is called after every accepted iteration with the
+		/// iteration number and the new cost.
+		std::function<void(int, Number<Inexact>)> onIteration;
+	};
+
+	/// The outcome of \ref optimize(const OptimizationOptions&).
+	struct OptimizationResult {
+		/// The number of iterations performed.
+		int iterations = 0;
+		/// Whether the optimization stopped because it converged, that is,
+		/// because an iteration decreased the cost by less than the tolerance
+		/// or the gradient vanished.
+		bool converged = false;
+		/// Whether the optimization stopped because the line search could not
+		/// find any step (not even a plain gradient step) that lowers the
+		/// cost. This does not imply that the tree is at a local minimum.
+		///
+		/// If neither \ref converged nor \ref stalled is set, the optimization
+		/// hit the maximum number of iterations.
+		bool stalled = false;
+		/// The cost before the first iteration, followed by the cost after
+		/// every accepted iteration.
+		std::vector<Number<Inexact>> costs;
+	};
+
+	/// Optimizes the tree until convergence.
+	///
+	/// This uses Nesterov's accelerated gradient descent, with a backtracking
+	/// line search to determine the step size in each iteration. If the cost
+	/// increases anyway, the momentum is reset (adaptive restart).
+	OptimizationResult optimize(const OptimizationOptions& options);
+
+	/// Sets the distance beyond which obstacles are ignored when computing the
+	/// obstacle cost and its gradient.
+	///
+	/// The obstacle cost of a node with thickness \f$t\f$ is zero for
+	/// obstacles at distance \f$t + B\f$ or more anyway, so by default (if the
+	/// cutoff is infinite) the obstacle cost is computed exactly. Setting a
+	/// smaller cutoff trades accuracy for speed, because fewer obstacles need
+	/// to be considered for thick nodes.
+	void setObstacleCutoff(Number<Inexact> cutoff);
+
   private:
 	/// The spiral tree underlying this smooth tree.
 	std::shared_ptr<SpiralTree> m_tree;
@@ -74,6 +136,66 @@ class SmoothTree {
 		Number<Inexact> phi = 0;
 	};
 	std::vector<PolarGradient> m_gradient;
+	/// Per-thread gradient buffers for \ref computeGradient(), which are summed
+	/// into \ref m_gradient afterwards.
+	std::vector<std::vector<PolarGradient>> m_threadGradients;
+
+	/// Computes the gradient of the cost function into \ref m_gradient, using
+	/// the given number of threads (or `0` for the number of hardware
+	/// threads).
+	void computeGradient(int threadCount);
+	/// Adds the gradient of the cost terms belonging to the nodes with index
+	/// in `[begin, end)` to `gradient`.
+	void accumulateGradient(std::vector<PolarGradient>& gradient, int begin, int end);
+	/// Sets the positions of the movable nodes to those in `from`, moved by
+	/// `stepSize` against \ref m_gradient.
+	void moveNodes(const std::vector<PolarPoint>& from, Number<Inexact> stepSize,
+	               bool moveJoinNodesRadially);
+	/// Returns the squared length of \ref m_gradient, restricted to the
+	/// coordinates that \ref moveNodes() changes.
+	Number<Inexact> gradientSquaredLength(bool moveJoinNodesRadially) const;
+	/// Returns the positions of all nodes.
+	std::vector<PolarPoint> positions() const;
+	/// Sets the positions of all nodes.
+	void setPositions(const std::vector<PolarPoint>& positions);
+
+	/// Uniform grid of the obstacle (leaf) nodes, used to find the obstacles
+	/// close to a node without iterating over all of them.
+	///
+	/// The obstacles are stored bucketed by grid cell: the obstacles in cell
+	/// \f$c\f$ are `obstacles[cellStart[c]]` up to (but excluding)
+	/// `obstacles[cellStart[c + 1]]`. Leaf nodes don't move during the
+	/// optimization, so this grid is built only once.
+	struct ObstacleGrid {
+		/// Bottom-left corner of the grid.
+		Point<Inexact> origin = Point<Inexact>(0, 0);
+		/// Width and height of a grid cell.
+		Number<Inexact> cellSize = 1;
+		/// Number of columns in the grid.
+		int columns = 0;
+		/// Number of rows in the grid.
+		int rows = 0;
+		/// For each cell, the index of its first obstacle in \ref obstacles.
+		std::vector<int> cellStart;
+		/// The node indices of the obstacles, sorted by grid cell.
+		std::vector<int> obstacles;
+		/// The Cartesian positions of the obstacles in \ref obstacles.
+		std::vector<Point<Inexact>> positions;
+	};
+	ObstacleGrid m_obstacleGrid;
+	/// Distance beyond which obstacles are ignored.
+	Number<Inexact> m_obstacleCutoff = std::numeric_limits<Number<Inexact>>::infinity();
+
+	/// Builds \ref m_obstacleGrid from the leaf nodes in this tree.
+	void buildObstacleGrid();
+	/// Calls `f(j, position)` for every obstacle `j` (with Cartesian
+	/// `position`) that is within distance `radius` of `p`. This may also
+	/// report some obstacles that are slightly further away.
+	template <typename F>
+	void forEachObstacleNear(const Point<Inexact>& p, Number<Inexact> radius, F f) const;
+	/// Returns the radius around node `i` in which obstacles contribute to the
+	/// obstacle cost.
+	Number<Inexact> obstacleRadius(int i) const;
 
 	/// Computes the obstacle cost for the subdivision or join node `i` at
 	/// \f$(r, \phi)\f$ to the given obstacle leaf node at \f$(r_{\text{obs}},
@@ -94,6 +216,20 @@ class SmoothTree {
 	/// a buffer size, and \f$D\f$ is the distance between \f$(r, \phi)\f$ and
 	/// \f$(r_{\text{obs}}, \phi_{\text{obs}})\f$.
 	Number<Inexact> computeObstacleCost(int i, Number<Inexact> thickness, PolarPoint obstacle);
+	/// Applies the obstacle gradient to `gradient` for the subdivision or
+	/// join node `i`, for the obstacle leaf node at \f$(r_{\text{obs}},
+	/// \phi_{\text{obs}})\f$.
+	///
+	/// The gradient is defined by the partial derivatives of the obstacle cost
+	/// (see \ref computeObstacleCost), which follow from
+	/// \f$\frac{\partial F_\text{obs}}{\partial r} =
+	/// \frac{\mathrm{d}F_\text{obs}}{\mathrm{d}D} \cdot
+	/// \frac{r - r_{\text{obs}} \cos(\phi - \phi_{\text{obs}})}{D}\f$ and
+	/// \f$\frac{\partial F_\text{obs}}{\partial \phi} =
+	/// \frac{\mathrm{d}F_\text{obs}}{\mathrm{d}D} \cdot
+	/// \frac{r r_{\text{obs}} \sin(\phi - \phi_{\text{obs}})}{D}\f$.
+	void applyObstacleGradient(std::vector<PolarGradient>& gradient, int i,
+	                           Number<Inexact> thickness, PolarPoint obstacle);
 
 	/// Computes the smoothing cost for the subdivision node `i` at \f$(r,
 	/// \phi)\f$, with parent `iParent` at \f$(r_p, \phi_p)\f$ and child
@@ -107,7 +243,7 @@ class SmoothTree {
 	///     \text{.}
 	/// \f]
 	Number<Inexact> computeSmoothingCost(int i, int iParent, int iChild);
-	/// Applies the smoothing gradient in \ref m_gradient to the subdivision node
+	/// Applies the smoothing gradient to `gradient` for the subdivision node
 	/// `i`, its parent `iParent`, and its child `iChild`.
 	///
 	/// The gradient is defined by the partial derivatives of the smoothing cost
@@ -132,7 +268,7 @@ class SmoothTree {
 	///     \text{;} \\
 	/// \f}
 	/// et cetera.
-	void applySmoothingGradient(int i, int iParent, int iChild);
+	void applySmoothingGradient(std::vector<PolarGradient>& gradient, int i, int iParent, int iChild);
 	
 	/// Computes the angle restriction cost for the join node `i` at \f$(r,
 	/// \phi)\f$, with children `iChild1` at \f$(r_{c_1}, \phi_{c_1})\f$ and
@@ -146,7 +282,7 @@ class SmoothTree {
 	///     \text{.}
 	/// \f]
 	Number<Inexact> computeAngleRestrictionCost(int i, int iChild1, int iChild2);
-	/// Applies the angle restriction gradient in \ref m_gradient to the join node
+	/// Applies the angle restriction gradient to `gradient` for the join node
 	/// `i` and its children `iChild1` and `iChild2`.
 	///
 	/// The gradient is defined by the partial derivatives of the angle
@@ -167,7 +303,8 @@ class SmoothTree {
 	///     \text{;} \\
 	/// \f}
 	/// et cetera.
-	void applyAngleRestrictionGradient(int i, int iChild1, int iChild2);
+	void applyAngleRestrictionGradient(std::vector<PolarGradient>& gradient, int i, int iChild1,
+	                                   int iChild2);
 	/// Computes the balancing cost for the join node `i` at \f$(r, \phi)\f$,
 	/// with children `iChild1` at \f$(r_{c_1}, \phi_{c_1})\f$ and `iChild2` at
 	/// \f$(r_{c_2}, \phi_{c_2})\f$.
@@ -181,7 +318,7 @@ class SmoothTree {
 	///     \text{.}
 	/// \f]
 	Number<Inexact> computeBalancingCost(int i, int iChild1, int iChild2);
-	/// Applies the balancing gradient in \ref m_gradient to the join node `i` and
+	/// Applies the balancing gradient to `gradient` for the join node `i` and
 	/// its children `iChild1` and `iChild2`.
 	///
 	/// The gradient is defined by the partial derivatives of the balancing cost
@@ -198,7 +335,8 @@ class SmoothTree {
 	///     \text{;} \\
 	/// \f}
 	/// et cetera.
-	void applyBalancingGradient(int i, int iChild1, int iChild2);
+	void applyBalancingGradient(std::vector<PolarGradient>& gradient, int i, int iChild1,
+	                            int iChild2);
 	/// Computes the straightening cost for the join node `i` at \f$(r,
 	/// \phi)\f$, with parent `iParent` at \f$(r_p, \phi_p)\f$ and children
 	/// `children` at \f$(r_{c_i}, \phi_{c_i})\f$.
@@ -214,7 +352,7 @@ class SmoothTree {
 	/// \f]
 	Number<Inexact> computeStraighteningCost(int i, int iParent,
 	                                         const std::vector<std::shared_ptr<Node>>& children);
-	/// Applies the straightening gradient in \ref m_gradient to the join node `i`
+	/// Applies the straightening gradient to `gradient` for the join node `i`
 	/// at \f$(r, \phi)\f$, with parent `iParent` at \f$(r_p, \phi_p)\f$ and
 	/// children `children` at \f$(r_{c_i}, \phi_{c_i})\f$.
 	///
@@ -234,7 +372,7 @@ class SmoothTree {
 	///     \text{;} \\
 	/// \f}
 	/// et cetera.
-	void applyStraighteningGradient(int i, int iParent,
+	void applyStraighteningGradient(std::vector<PolarGradient>& gradient, int i, int iParent,
 	                                const std::vector<std::shared_ptr<Node>>& children);
 
 	Number<Inexact> m_obstacleFactor = 2.0;
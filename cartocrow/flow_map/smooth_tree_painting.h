@@ -14,10 +14,7 @@ class SmoothTreePainting : public renderer::GeometryPainting {
 
   public:
 	/// Options that determine what to draw in the painting.
-	struct Options {
-		double spiralStep = 0.01;
-		double spiralMax = 6.0;
-	};
+	struct Options {};
 
 	/// Creates a new painting with the given map and tree.
 	SmoothTreePainting(std::shared_ptr<SmoothTree> tree, const Options options);
@@ -76,6 +76,13 @@ void SpiralTree::addObstacle(const Polygon<Inexact>& shape) {
 	m_obstacles.push_back(obstacle);
 }
 
+void SpiralTree::addCounterclockwiseObstacle(const Polygon<Inexact>& shape) {
+	assert(shape.is_counterclockwise_oriented());
+	Obstacle obstacle = makeCounterclockwiseObstacle(shape);
+	subdivideClosestAndSpiral(obstacle);
+	m_obstacles.push_back(obstacle);
+}
+
 void SpiralTree::addShields() {
 	for (const std::shared_ptr<Place>& place : places()) {
 		PolarPoint position(place->m_position, CGAL::ORIGIN - rootPosition());
@@ -149,13 +156,15 @@ void SpiralTree::addEdge(const std::shared_ptr<Node>& parent, const std::shared_
 }
 
 SpiralTree::Obstacle SpiralTree::makeObstacle(Polygon<Inexact> shape) {
-	Obstacle obstacle;
-
 	// enforce counter-clockwise vertex order
 	if (!shape.is_counterclockwise_oriented()) {
 		shape.reverse_orientation();
 	}
+	return makeCounterclockwiseObstacle(shape);
+}
 
+SpiralTree::Obstacle SpiralTree::makeCounterclockwiseObstacle(const Polygon<Inexact>& shape) {
+	Obstacle obstacle;
 	for (auto edge = shape.edges_begin(); edge != shape.edges_end(); ++edge) {
 		PolarPoint p1(edge->start(), CGAL::ORIGIN - rootPosition());
 		PolarPoint p2(edge->end(), CGAL::ORIGIN - rootPosition());
@@ -106,6 +106,13 @@ class SpiralTree {
 	void addPlace(const std::string& name, const Point<Inexact>& position, Number<Inexact> flow);
 	/// Adds an obstacle to the spiral tree.
 	void addObstacle(const Polygon<Inexact>& shape);
+	/// Adds an obstacle to the spiral tree, whose vertices are known to be in
+	/// counter-clockwise order already.
+	///
+	/// Unlike \ref addObstacle(), this neither copies the shape nor checks its
+	/// orientation. This is meant for obstacles that are shared by many trees
+	/// (see \ref SpiralTreeBatch), so that they are normalized only once.
+	void addCounterclockwiseObstacle(const Polygon<Inexact>& shape);
 
 	/// Adds a shield obstacle to each place to make sure that these nodes in
 	/// the tree become leaves.
@@ -126,6 +133,9 @@ class SpiralTree {
   private:
 	/// Generates an obstacle of the given shape.
 	Obstacle makeObstacle(Polygon<Inexact> shape);
+	/// Generates an obstacle of the given shape, which must be in
+	/// counter-clockwise order.
+	Obstacle makeCounterclockwiseObstacle(const Polygon<Inexact>& shape);
 	/// Subdivides edges of the given obstacle at every closest point (to the
 	/// root) and spiral point (relative to the root).
 	///
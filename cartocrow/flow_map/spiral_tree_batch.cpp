@@ -0,0 +1,86 @@
+/*
+The Flow Map library implements the algorithmic geo-visualization
+method by the same name, developed by Kevin Verbeek, Kevin Buchin,
+and Bettina Speckmann at TU Eindhoven
+(DOI: 10.1007/s00453-013-9867-z & 10.1109/TVCG.2011.202).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "spiral_tree_batch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../core/parallel.h"
+#include "reachable_region_algorithm.h"
+#include "spiral_tree_obstructed_algorithm.h"
+
+namespace cartocrow::flow_map {
+
+SpiralTreeBatch::SpiralTreeBatch(Number<Inexact> restrictingAngle)
+    : m_restrictingAngle(restrictingAngle) {}
+
+void SpiralTreeBatch::addObstacle(Polygon<Inexact> shape) {
+	if (!shape.is_counterclockwise_oriented()) {
+		shape.reverse_orientation();
+	}
+	m_obstacles.push_back(std::move(shape));
+}
+
+const std::vector<Polygon<Inexact>>& SpiralTreeBatch::obstacles() const {
+	return m_obstacles;
+}
+
+void SpiralTreeBatch::setShields(bool enabled) {
+	m_shields = enabled;
+}
+
+std::shared_ptr<SpiralTree> SpiralTreeBatch::addRoot(const Point<Inexact>& position) {
+	m_trees.push_back(std::make_shared<SpiralTree>(position, m_restrictingAngle));
+	return m_trees.back();
+}
+
+const std::vector<std::shared_ptr<SpiralTree>>& SpiralTreeBatch::trees() const {
+	return m_trees;
+}
+
+void SpiralTreeBatch::run(int threadCount) {
+	if (m_hasRun) {
+		throw std::runtime_error("SpiralTreeBatch::run() can only be called once");
+	}
+	m_hasRun = true;
+
+	// trees can differ a lot in size, so instead of splitting them up
+	// beforehand, every thread repeatedly takes the next tree that is left
+	parallel_for(static_cast<int>(m_trees.size()), threadCount, [this](int i) { runTree(i); });
+}
+
+void SpiralTreeBatch::runTree(int index) {
+	std::shared_ptr<SpiralTree> tree = m_trees[index];
+	// the obstacles have been normalized when they were added, so only the
+	// root-dependent part (the polar coordinates) is left to compute here
+	for (const Polygon<Inexact>& obstacle : m_obstacles) {
+		tree->addCounterclockwiseObstacle(obstacle);
+	}
+	if (m_shields) {
+		tree->addShields();
+	}
+	ReachableRegionAlgorithm::ReachableRegion reachableRegion =
+	    ReachableRegionAlgorithm(tree).run();
+	SpiralTreeObstructedAlgorithm(tree, reachableRegion).run();
+}
+
+} // namespace cartocrow::flow_map
@@ -0,0 +1,109 @@
+/*
+The Flow Map library implements the algorithmic geo-visualization
+method by the same name, developed by Kevin Verbeek, Kevin Buchin,
+and Bettina Speckmann at TU Eindhoven
+(DOI: 10.1007/s00453-013-9867-z & 10.1109/TVCG.2011.202).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_FLOW_MAP_SPIRAL_TREE_BATCH_H
+#define CARTOCROW_FLOW_MAP_SPIRAL_TREE_BATCH_H
+
+#include <memory>
+#include <vector>
+
+#include "../core/core.h"
+#include "spiral_tree.h"
+
+namespace cartocrow::flow_map {
+
+/// Computes obstructed spiral trees for many roots that share one set of
+/// obstacles, such as one flow map per source region in an origin-destination
+/// data set.
+///
+/// The obstacles are given once, in Cartesian coordinates, and are normalized
+/// to counter-clockwise orientation when they are added. After that, they are
+/// never modified, so that all roots can read them at the same time. Each root
+/// gets its own \ref SpiralTree, to which the caller adds the places for that
+/// root. Then \ref run() computes all trees concurrently: for each root, it
+/// passes the normalized obstacles to the tree with \ref
+/// SpiralTree::addCounterclockwiseObstacle(), which only converts them to
+/// polar coordinates around that root (which is inherently different for each
+/// root) without copying or reorienting them again, and runs the \ref
+/// ReachableRegionAlgorithm and the \ref SpiralTreeObstructedAlgorithm with
+/// their own sweep state.
+///
+/// ## Example
+///
+/// ```
+/// flow_map::SpiralTreeBatch batch(0.5);
+/// for (const Polygon<Inexact>& obstacle : obstacles) {
+///     batch.addObstacle(obstacle);
+/// }
+/// for (const Source& source : sources) {
+///     std::shared_ptr<flow_map::SpiralTree> tree = batch.addRoot(source.position);
+///     for (const Destination& destination : source.destinations) {
+///         tree->addPlace(destination.name, destination.position, destination.flow);
+///     }
+/// }
+/// batch.run();
+/// ```
+class SpiralTreeBatch {
+  public:
+	/// Constructs an empty batch, in which all spiral trees use the given
+	/// restricting angle.
+	explicit SpiralTreeBatch(Number<Inexact> restrictingAngle);
+
+	/// Adds an obstacle that is shared by all spiral trees in this batch.
+	void addObstacle(Polygon<Inexact> shape);
+	/// Returns the shared obstacles, in counter-clockwise orientation.
+	const std::vector<Polygon<Inexact>>& obstacles() const;
+
+	/// Sets whether \ref run() adds shields (see \ref SpiralTree::addShields())
+	/// around the places of each tree. This is enabled by default.
+	void setShields(bool enabled);
+
+	/// Adds a root to this batch and returns the spiral tree for it. Places
+	/// should be added to the returned tree before calling \ref run().
+	std::shared_ptr<SpiralTree> addRoot(const Point<Inexact>& position);
+	/// Returns the spiral trees in this batch, in the order in which their
+	/// roots were added.
+	const std::vector<std::shared_ptr<SpiralTree>>& trees() const;
+
+	/// Computes all spiral trees in this batch, using the given number of
+	/// threads (or \c 0 to use the number of hardware threads). This can only
+	/// be called once.
+	void run(int threadCount = 0);
+
+  private:
+	/// Computes the spiral tree with the given index.
+	void runTree(int index);
+
+	/// The restricting angle of all trees.
+	Number<Inexact> m_restrictingAngle;
+	/// The shared obstacles, in counter-clockwise orientation.
+	std::vector<Polygon<Inexact>> m_obstacles;
+	/// Whether to add shields to the trees.
+	bool m_shields = true;
+	/// The trees, one per root.
+	std::vector<std::shared_ptr<SpiralTree>> m_trees;
+	/// Whether \ref run() has been called already.
+	bool m_hasRun = false;
+};
+
+} // namespace cartocrow::flow_map
+
+#endif //CARTOCROW_FLOW_MAP_SPIRAL_TREE_BATCH_H
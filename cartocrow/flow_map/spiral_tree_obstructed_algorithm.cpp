@@ -21,7 +21,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "spiral_tree_obstructed_algorithm.h"
 
+#include <algorithm>
 #include <cmath>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -85,8 +87,7 @@ void SpiralTreeObstructedAlgorithm::Event::insertJoinEventFor(
 		} else {
 			nextEdge = std::next(rightEdge);
 		}
-		m_alg->m_queue.push(
-		    std::make_shared<JoinEvent>(*vanishingPoint, *rightEdge, *nextEdge, m_alg));
+		m_alg->pushJoinEvent(*vanishingPoint, *rightEdge, *nextEdge);
 	}
 }
 
@@ -99,19 +100,21 @@ void SpiralTreeObstructedAlgorithm::NodeEvent::handle() {
 	using enum SweepEdgeShape::Type;
 
 	// TODO
-	std::cout << "> \033[1mhandling \033[33mnode event\033[0m\n";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{240, 120, 0}, 1);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "node");
+	if (m_alg->m_debugOutput) {
+		std::cout << "> \033[1mhandling \033[33mnode event\033[0m\n";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{240, 120, 0}, 1);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "node");
+	}
 
 	m_alg->remainingNodeVertexEventCount--;
 
-	auto leftSpiral = std::make_shared<SweepEdge>(
+	auto leftSpiral = m_alg->makeEdge(
 	    SweepEdgeShape(LEFT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
-	auto rightSpiral = std::make_shared<SweepEdge>(
+	auto rightSpiral = m_alg->makeEdge(
 	    SweepEdgeShape(RIGHT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
 	auto result = m_alg->m_circle.splitFromInterval(leftSpiral, rightSpiral);
 	result.middleInterval->setType(REACHABLE);
@@ -130,27 +133,29 @@ SpiralTreeObstructedAlgorithm::VertexEvent::VertexEvent(PolarPoint position,
 void SpiralTreeObstructedAlgorithm::VertexEvent::handle() {
 	using enum SweepInterval::Type;
 
-	std::string side = "";
-	switch (m_side) {
-	case Side::LEFT:
-		side = "left";
-		break;
-	case Side::RIGHT:
-		side = "right";
-		break;
-	case Side::NEAR:
-		side = "near";
-		break;
-	case Side::FAR:
-		side = "far";
+	if (m_alg->m_debugOutput) {
+		std::string side = "";
+		switch (m_side) {
+		case Side::LEFT:
+			side = "left";
+			break;
+		case Side::RIGHT:
+			side = "right";
+			break;
+		case Side::NEAR:
+			side = "near";
+			break;
+		case Side::FAR:
+			side = "far";
+		}
+		std::cout << "> \033[1mhandling \033[35m" << side << " vertex event\033[0m\n";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{150, 150, 150}, 0.5);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), side);
 	}
-	std::cout << "> \033[1mhandling \033[35m" << side << " vertex event\033[0m\n";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{150, 150, 150}, 0.5);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), side);
 
 	m_alg->remainingNodeVertexEventCount--;
 
@@ -176,9 +181,9 @@ void SpiralTreeObstructedAlgorithm::VertexEvent::handleLeft() {
 		auto result = m_alg->m_circle.switchEdge(m_e1, m_e2);
 
 	} else if (outsideInterval->type() == REACHABLE) { // case 2
-		auto rightSpiral = std::make_shared<SweepEdge>(
+		auto rightSpiral = m_alg->makeEdge(
 		    SweepEdgeShape(RIGHT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
-		auto leftSpiral = std::make_shared<SweepEdge>(
+		auto leftSpiral = m_alg->makeEdge(
 		    SweepEdgeShape(LEFT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
 
 		if (rightSpiral->shape().departsInwardsToLeftOf(m_position.r(), m_e2->shape())) {
@@ -218,9 +223,9 @@ void SpiralTreeObstructedAlgorithm::VertexEvent::handleRight() {
 		auto result = m_alg->m_circle.switchEdge(m_e2, m_e1);
 
 	} else if (outsideInterval->type() == REACHABLE) { // case 2
-		auto rightSpiral = std::make_shared<SweepEdge>(
+		auto rightSpiral = m_alg->makeEdge(
 		    SweepEdgeShape(RIGHT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
-		auto leftSpiral = std::make_shared<SweepEdge>(
+		auto leftSpiral = m_alg->makeEdge(
 		    SweepEdgeShape(LEFT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
 
 		if (m_e1->shape().departsInwardsToLeftOf(m_position.r(), leftSpiral->shape())) {
@@ -294,25 +299,28 @@ SpiralTreeObstructedAlgorithm::VertexEvent::determineSide() {
 }
 
 SpiralTreeObstructedAlgorithm::JoinEvent::JoinEvent(PolarPoint position,
-                                                    std::weak_ptr<SweepEdge> rightEdge,
-                                                    std::weak_ptr<SweepEdge> leftEdge,
+                                                    std::shared_ptr<SweepEdge> rightEdge,
+                                                    std::shared_ptr<SweepEdge> leftEdge,
                                                     SpiralTreeObstructedAlgorithm* alg)
-    : Event(position, alg), m_rightEdge(rightEdge), m_leftEdge(leftEdge) {}
+    : Event(position, alg), m_rightEdge(rightEdge), m_leftEdge(leftEdge),
+      m_rightGeneration(rightEdge->generation()), m_leftGeneration(leftEdge->generation()) {}
 
 void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 	using enum SweepInterval::Type;
 	using enum SweepEdgeShape::Type;
 
-	std::shared_ptr<SweepEdge> rightEdge = m_rightEdge.lock();
-	std::shared_ptr<SweepEdge> leftEdge = m_leftEdge.lock();
-
-	std::cout << "> \033[1mhandling \033[34mjoin event\033[0m";
-	m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
-	m_alg->m_debugPainting->setStroke(Color{0, 120, 240}, 1);
-	m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
-	                             (m_position.toCartesian() - CGAL::ORIGIN));
-	m_alg->m_debugPainting->drawText(
-	    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "join");
+	std::shared_ptr<SweepEdge> rightEdge = m_rightEdge;
+	std::shared_ptr<SweepEdge> leftEdge = m_leftEdge;
+
+	if (m_alg->m_debugOutput) {
+		std::cout << "> \033[1mhandling \033[34mjoin event\033[0m";
+		m_alg->m_debugPainting->setMode(renderer::GeometryRenderer::stroke);
+		m_alg->m_debugPainting->setStroke(Color{0, 120, 240}, 1);
+		m_alg->m_debugPainting->draw(m_alg->m_tree->rootPosition() +
+		                             (m_position.toCartesian() - CGAL::ORIGIN));
+		m_alg->m_debugPainting->drawText(
+		    m_alg->m_tree->rootPosition() + (m_position.toCartesian() - CGAL::ORIGIN), "join");
+	}
 
 	SweepInterval* previousInterval = rightEdge->previousInterval();
 	SweepInterval* interval = rightEdge->nextInterval();
@@ -323,11 +331,15 @@ void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 
 	if (previousInterval->type() == OBSTACLE && nextInterval->type() == OBSTACLE) {
 		// ignore, this is handled by a vertex event
-		std::cout << " (ignored)\n";
+		if (m_alg->m_debugOutput) {
+			std::cout << " (ignored)\n";
+		}
 
 	} else if (previousInterval->type() == FREE && nextInterval->type() == FREE) {
 		// case 1: simply merge the intervals into a big reachable interval
-		std::cout << " (case 1)\n";
+		if (m_alg->m_debugOutput) {
+			std::cout << " (case 1)\n";
+		}
 
 		auto result = m_alg->m_circle.mergeToInterval(rightEdge, leftEdge);
 		rightEdge->shape().pruneNearSide(m_position);
@@ -336,15 +348,17 @@ void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 
 	} else if (previousInterval->type() == REACHABLE && nextInterval->type() == REACHABLE) {
 		// case 1.5: join and make new active node
-		std::cout << " (case 1.5)\n";
+		if (m_alg->m_debugOutput) {
+			std::cout << " (case 1.5)\n";
+		}
 
 		m_alg->m_circle.freeAllWithActiveDescendant(previousInterval->activeDescendant());
 		m_alg->m_circle.freeAllWithActiveDescendant(nextInterval->activeDescendant());
 		rightEdge->shape().pruneNearSide(m_position);
 		leftEdge->shape().pruneNearSide(m_position);
-		auto rightSpiral = std::make_shared<SweepEdge>(
+		auto rightSpiral = m_alg->makeEdge(
 			SweepEdgeShape(RIGHT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
-		auto leftSpiral = std::make_shared<SweepEdge>(
+		auto leftSpiral = m_alg->makeEdge(
 			SweepEdgeShape(LEFT_SPIRAL, m_position, m_alg->m_tree->restrictingAngle()));
 		//auto result = m_alg->m_circle.mergeAndSplit(rightEdge, leftEdge, leftSpiral, rightSpiral);
 		m_alg->m_circle.mergeToInterval(rightEdge, leftEdge);
@@ -370,7 +384,9 @@ void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 
 	} else if (previousInterval->type() == OBSTACLE) {
 		// case 2: right side is obstacle
-		std::cout << " (case 2)\n";
+		if (m_alg->m_debugOutput) {
+			std::cout << " (case 2)\n";
+		}
 
 		leftEdge->shape().pruneNearSide(m_position);
 		rightEdge->shape().pruneNearSide(m_position);
@@ -378,7 +394,9 @@ void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 
 	} else if (nextInterval->type() == OBSTACLE) {
 		// case 3: left side is obstacle
-		std::cout << " (case 3)\n";
+		if (m_alg->m_debugOutput) {
+			std::cout << " (case 3)\n";
+		}
 
 		rightEdge->shape().pruneNearSide(m_position);
 		leftEdge->shape().pruneNearSide(m_position);
@@ -389,61 +407,78 @@ void SpiralTreeObstructedAlgorithm::JoinEvent::handle() {
 }
 
 bool SpiralTreeObstructedAlgorithm::JoinEvent::isValid() const {
-	// a join event is invalid if one of its edges has already been deleted
-	return !m_rightEdge.expired() && !m_leftEdge.expired();
+	// a join event is invalid if one of its edges has been taken off the sweep
+	// circle in the meantime
+	return m_rightEdge->generation() == m_rightGeneration &&
+	       m_leftEdge->generation() == m_leftGeneration;
 }
 
 SpiralTreeObstructedAlgorithm::SpiralTreeObstructedAlgorithm(
     std::shared_ptr<SpiralTree> tree,
     ReachableRegionAlgorithm::ReachableRegion reachableRegion)
     : m_tree(tree), m_reachableRegion(std::move(reachableRegion)),
+      m_edgePool(std::make_shared<std::deque<SweepEdge>>()),
       m_debugPainting(std::make_shared<renderer::PaintingRenderer>()),
-      m_circle(SweepInterval::Type::FREE) {}
+      m_debugOutput(false), m_circle(SweepInterval::Type::FREE) {}
 
 void SpiralTreeObstructedAlgorithm::run() {
 
-	std::cout << "\033[1m────────────────────────────────────────────────────\033[0m\n"
-	          << "\033[1m Step 2: Inwards sweep to construct the spiral tree \033[0m\n"
-	          << "\033[1m────────────────────────────────────────────────────\033[0m\n";
+	if (m_debugOutput) {
+		std::cout << "\033[1m────────────────────────────────────────────────────\033[0m\n"
+		          << "\033[1m Step 2: Inwards sweep to construct the spiral tree \033[0m\n"
+		          << "\033[1m────────────────────────────────────────────────────\033[0m\n";
+	}
 
 	// insert all reachable nodes into the event queue
 	activeNodeCount = 0;
 	for (const std::shared_ptr<Node>& node : m_reachableRegion.reachableNodes) {
 		if (node->m_position.r() > 0 && node) {
-			m_queue.push(std::make_shared<NodeEvent>(node, this));
+			pushNodeEvent(node);
 			activeNodeCount++;
 		}
 	}
 
 	// insert vertices of the unreachable region
 	for (ReachableRegionAlgorithm::UnreachableRegionVertex& vertex : m_reachableRegion.boundary) {
-		m_queue.push(std::make_shared<VertexEvent>(vertex.m_location, vertex.m_e1, vertex.m_e2, this));
+		pushVertexEvent(vertex.m_location, vertex.m_e1, vertex.m_e2);
 	}
 	remainingNodeVertexEventCount = m_queue.size();
 
 	if (m_queue.size() == 0) {
 		return;
 	}
-	m_circle.grow(m_queue.top()->r());
+	m_circle.grow(m_queue.top().r);
+	m_statistics = SweepStatistics{};
+	m_statistics.sweeps = 1;
+	m_statistics.peakQueueSize = m_queue.size();
 
 	// main loop, handle all events
 	while (!m_queue.empty() && (activeNodeCount > 1 || remainingNodeVertexEventCount > 0)) {
-		std::shared_ptr<Event> event = m_queue.top();
+		QueuedEvent event = m_queue.top();
 		m_queue.pop();
-		if (!event->isValid()) {
+		if (!isValid(event)) {
+			m_statistics.skippedEvents++;
 			continue;
 		}
-		if (m_circle.edges().empty()) {
-			m_circle.m_onlyInterval->paintSweepShape(*m_debugPainting, event->r(), m_circle.r());
-		} else {
-			for (const auto& edge : m_circle.edges()) {
-				edge->nextInterval()->paintSweepShape(*m_debugPainting, event->r(), m_circle.r());
+		if (m_debugOutput) {
+			if (m_circle.edges().empty()) {
+				m_circle.m_onlyInterval->paintSweepShape(*m_debugPainting, event.r, m_circle.r());
+			} else {
+				for (const auto& edge : m_circle.edges()) {
+					edge->nextInterval()->paintSweepShape(*m_debugPainting, event.r, m_circle.r());
+				}
 			}
 		}
-		m_circle.shrink(event->r());
-		m_circle.print();
-		event->handle();
-		m_circle.print();
+		m_circle.shrink(event.r);
+		if (m_debugOutput) {
+			m_circle.print();
+		}
+		handle(event);
+		m_statistics.handledEvents++;
+		m_statistics.peakQueueSize = std::max(m_statistics.peakQueueSize, m_queue.size());
+		if (m_debugOutput) {
+			m_circle.print();
+		}
 		assert(m_circle.isValid());
 	}
 
@@ -453,6 +488,69 @@ void SpiralTreeObstructedAlgorithm::run() {
 	lastNode->m_parent = m_tree->m_root;
 }
 
+void SpiralTreeObstructedAlgorithm::pushNodeEvent(std::shared_ptr<Node> node) {
+	m_nodeEvents.emplace_back(node, this);
+	m_queue.push(QueuedEvent{m_nodeEvents.back().r(), EventType::NODE, m_nodeEvents.size() - 1});
+}
+
+void SpiralTreeObstructedAlgorithm::pushVertexEvent(PolarPoint position,
+                                                    std::shared_ptr<SweepEdge> e1,
+                                                    std::shared_ptr<SweepEdge> e2) {
+	m_vertexEvents.emplace_back(position, e1, e2, this);
+	m_queue.push(
+	    QueuedEvent{m_vertexEvents.back().r(), EventType::VERTEX, m_vertexEvents.size() - 1});
+}
+
+void SpiralTreeObstructedAlgorithm::pushJoinEvent(PolarPoint position,
+                                                  std::shared_ptr<SweepEdge> rightEdge,
+                                                  std::shared_ptr<SweepEdge> leftEdge) {
+	m_joinEvents.emplace_back(position, rightEdge, leftEdge, this);
+	m_queue.push(QueuedEvent{m_joinEvents.back().r(), EventType::JOIN, m_joinEvents.size() - 1});
+}
+
+bool SpiralTreeObstructedAlgorithm::isValid(const QueuedEvent& event) const {
+	switch (event.type) {
+	case EventType::NODE:
+		return m_nodeEvents[event.index].isValid();
+	case EventType::VERTEX:
+		return m_vertexEvents[event.index].isValid();
+	case EventType::JOIN:
+		return m_joinEvents[event.index].isValid();
+	}
+	return false;
+}
+
+void SpiralTreeObstructedAlgorithm::handle(const QueuedEvent& event) {
+	// note that handling an event may add new events to the pools; this is
+	// safe because adding to a std::deque does not move the existing elements
+	switch (event.type) {
+	case EventType::NODE:
+		m_nodeEvents[event.index].handle();
+		break;
+	case EventType::VERTEX:
+		m_vertexEvents[event.index].handle();
+		break;
+	case EventType::JOIN:
+		m_joinEvents[event.index].handle();
+		break;
+	}
+}
+
+std::shared_ptr<SweepEdge> SpiralTreeObstructedAlgorithm::makeEdge(SweepEdgeShape shape) {
+	m_edgePool->emplace_back(std::move(shape));
+	// aliasing constructor: the edge shares ownership of the pool, so this
+	// does not allocate a control block per edge
+	return std::shared_ptr<SweepEdge>(m_edgePool, &m_edgePool->back());
+}
+
+const SweepStatistics& SpiralTreeObstructedAlgorithm::statistics() const {
+	return m_statistics;
+}
+
+void SpiralTreeObstructedAlgorithm::setDebugOutput(bool enabled) {
+	m_debugOutput = enabled;
+}
+
 std::shared_ptr<renderer::GeometryPainting> SpiralTreeObstructedAlgorithm::debugPainting() {
 	return m_debugPainting;
 }
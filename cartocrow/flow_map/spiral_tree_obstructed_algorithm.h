@@ -22,6 +22,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_FLOW_MAP_SPIRAL_TREE_OBSTRUCTED_ALGORTIHM_H
 #define CARTOCROW_FLOW_MAP_SPIRAL_TREE_OBSTRUCTED_ALGORTIHM_H
 
+#include <deque>
+#include <queue>
 #include <variant>
 
 #include "../renderer/geometry_painting.h"
@@ -29,6 +31,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "reachable_region_algorithm.h"
 #include "spiral_tree.h"
 #include "sweep_circle.h"
+#include "sweep_statistics.h"
 
 namespace cartocrow::flow_map {
 
@@ -80,24 +83,29 @@ class SpiralTreeObstructedAlgorithm {
 	/// Runs the algorithm.
 	void run();
 
+	/// Enables or disables debug output. If enabled, \ref run() draws
+	/// information about the algorithm run into the \ref debugPainting() and
+	/// traces the handled events to \c std::cout.
+	/// Debug output is disabled by default, as it is expensive for large
+	/// inputs. It does not influence the result of the algorithm.
+	void setDebugOutput(bool enabled);
+
 	/// Returns a \ref GeometryPainting that shows some debug information. This
 	/// painting shows some debug information about the algorithm run. If this
-	/// method is called before \ref run(), this will result in an empty
-	/// painting.
+	/// method is called before \ref run(), or if debug output is disabled
+	/// (see \ref setDebugOutput()), this will result in an empty painting.
 	std::shared_ptr<renderer::GeometryPainting> debugPainting();
 
+	/// Returns statistics about the last run of the algorithm (see \ref
+	/// SweepStatistics).
+	const SweepStatistics& statistics() const;
+
   private:
 	/// The spiral tree we are computing.
 	std::shared_ptr<SpiralTree> m_tree;
 	/// The reachable region as produced by the \ref ReachableRegionAlgorithm.
 	ReachableRegionAlgorithm::ReachableRegion m_reachableRegion;
 
-	class Event;
-	class CompareEvents;
-
-	using EventQueue =
-	    std::priority_queue<std::shared_ptr<Event>, std::vector<std::shared_ptr<Event>>, CompareEvents>;
-
 	/// An event in the \ref SpiralTreeObstructedAlgorithm.
 	class Event {
 	  public:
@@ -109,10 +117,8 @@ class SpiralTreeObstructedAlgorithm {
 		Number<Inexact> r() const;
 		/// Returns the \f$\phi\f$ at which this event happens.
 		Number<Inexact> phi() const;
-		/// Handles this event.
-		virtual void handle() = 0;
 		/// Checks if this event is still valid.
-		virtual bool isValid() const;
+		bool isValid() const;
 
 		/// Inserts join events for all edges starting at the event position.
 		void insertJoinEvents();
@@ -138,7 +144,7 @@ class SpiralTreeObstructedAlgorithm {
 		/// Handles this event by starting a reachable region for the node.
 		///
 		/// \image html spiral-tree-algorithm-node-event.svg
-		void handle() override;
+		void handle();
 
 	  private:
 		std::shared_ptr<Node> m_node;
@@ -181,7 +187,7 @@ class SpiralTreeObstructedAlgorithm {
 			FAR,
 		};
 
-		void handle() override;
+		void handle();
 
 	  private:
 		Side determineSide();
@@ -237,26 +243,80 @@ class SpiralTreeObstructedAlgorithm {
 	/// event instead.
 	class JoinEvent : public Event {
 	  public:
-		JoinEvent(PolarPoint position, std::weak_ptr<SweepEdge> rightEdge,
-		          std::weak_ptr<SweepEdge> leftEdge, SpiralTreeObstructedAlgorithm* alg);
-		void handle() override;
-		virtual bool isValid() const override;
+		JoinEvent(PolarPoint position, std::shared_ptr<SweepEdge> rightEdge,
+		          std::shared_ptr<SweepEdge> leftEdge, SpiralTreeObstructedAlgorithm* alg);
+		void handle();
+		/// Checks if this event is still valid, that is, if neither of its
+		/// edges has been taken off the sweep circle since the event was
+		/// created (see \ref SweepEdge::generation()).
+		bool isValid() const;
 
 	  private:
 		/// The right edge involved in this join event.
-		std::weak_ptr<SweepEdge> m_rightEdge;
+		std::shared_ptr<SweepEdge> m_rightEdge;
 		/// The left edge involved in this join event.
-		std::weak_ptr<SweepEdge> m_leftEdge;
+		std::shared_ptr<SweepEdge> m_leftEdge;
+		/// The generation of \ref m_rightEdge when this event was created.
+		std::size_t m_rightGeneration;
+		/// The generation of \ref m_leftEdge when this event was created.
+		std::size_t m_leftGeneration;
+	};
+
+	/// The type of an event in the event queue.
+	enum class EventType { NODE, VERTEX, JOIN };
+
+	/// An entry in the event queue. Instead of the event itself, this stores
+	/// the type of the event and its index in the event pool of that type.
+	struct QueuedEvent {
+		/// The radius at which the event happens.
+		Number<Inexact> r;
+		/// The type of the event, which determines the pool it is stored in.
+		EventType type;
+		/// The index of the event in its pool.
+		std::size_t index;
 	};
 
 	/// Comparator for events that sorts them in descending order of distance to
 	/// the origin (compare \ref ReachableRegionAlgorithm::CompareEvents).
 	struct CompareEvents {
-		bool operator()(std::shared_ptr<Event>& a, std::shared_ptr<Event>& b) const {
-			return a->r() < b->r();
+		bool operator()(const QueuedEvent& a, const QueuedEvent& b) const {
+			return a.r < b.r;
 		}
 	};
 
+	using EventQueue = std::priority_queue<QueuedEvent, std::vector<QueuedEvent>, CompareEvents>;
+
+	/// Adds a node event for the given node to the event queue.
+	void pushNodeEvent(std::shared_ptr<Node> node);
+	/// Adds a vertex event for the obstacle vertex between the given edges to
+	/// the event queue.
+	void pushVertexEvent(PolarPoint position, std::shared_ptr<SweepEdge> e1,
+	                     std::shared_ptr<SweepEdge> e2);
+	/// Adds a join event for the interval between the given edges to the event
+	/// queue.
+	void pushJoinEvent(PolarPoint position, std::shared_ptr<SweepEdge> rightEdge,
+	                   std::shared_ptr<SweepEdge> leftEdge);
+	/// Checks whether the given queued event is still valid.
+	bool isValid(const QueuedEvent& event) const;
+	/// Handles the given queued event.
+	void handle(const QueuedEvent& event);
+
+	/// Creates a new sweep edge with the given shape in the edge pool of this
+	/// algorithm run.
+	std::shared_ptr<SweepEdge> makeEdge(SweepEdgeShape shape);
+
+	/// Pool of the sweep edges created during the algorithm run. The pointers
+	/// returned by \ref makeEdge() share ownership of the whole pool, so the
+	/// edges are only freed together after the last of them is released.
+	std::shared_ptr<std::deque<SweepEdge>> m_edgePool;
+	/// Pool of the node events created during the algorithm run.
+	std::deque<NodeEvent> m_nodeEvents;
+	/// Pool of the vertex events created during the algorithm run.
+	std::deque<VertexEvent> m_vertexEvents;
+	/// Pool of the join events created during the algorithm run. Most of these
+	/// become invalid before they are handled; they are then skipped.
+	std::deque<JoinEvent> m_joinEvents;
+
 	/// The sweep circle used in the algorithm.
 	SweepCircle m_circle;
 	/// The event queue storing the remaining events.
@@ -270,6 +330,10 @@ class SpiralTreeObstructedAlgorithm {
 	/// A painting that contains sweep shapes for each sweep interval
 	/// encountered during the execution of the algorithm.
 	std::shared_ptr<renderer::PaintingRenderer> m_debugPainting;
+	/// Whether to produce debug output (see \ref setDebugOutput()).
+	bool m_debugOutput;
+	/// Statistics about the algorithm run (see \ref statistics()).
+	SweepStatistics m_statistics;
 };
 
 } // namespace cartocrow::flow_map
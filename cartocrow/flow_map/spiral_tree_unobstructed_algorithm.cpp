@@ -21,6 +21,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "spiral_tree_unobstructed_algorithm.h"
 
+#include <algorithm>
 #include <optional>
 #include <ostream>
 
@@ -34,7 +35,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 namespace cartocrow::flow_map {
 
 SpiralTreeUnobstructedAlgorithm::SpiralTreeUnobstructedAlgorithm(SpiralTree& tree)
-    : m_tree(tree), m_debugPainting(std::make_shared<renderer::PaintingRenderer>()) {}
+    : m_tree(tree), m_debugPainting(std::make_shared<renderer::PaintingRenderer>()),
+      m_debugOutput(false) {}
 
 void SpiralTreeUnobstructedAlgorithm::run() {
 
@@ -48,6 +50,10 @@ void SpiralTreeUnobstructedAlgorithm::run() {
 		events.push(Event(node, node->m_position));
 	}
 
+	m_statistics = SweepStatistics{};
+	m_statistics.sweeps = 1;
+	m_statistics.peakQueueSize = events.size();
+
 	// main loop, handle all events
 	while (!events.empty()) {
 		Event event = events.top();
@@ -56,6 +62,7 @@ void SpiralTreeUnobstructedAlgorithm::run() {
 		// if we have reached the root, handle that and stop
 		if (event.m_relative_position.r() == 0) {
 			handleRootEvent(event, wavefront);
+			m_statistics.handledEvents++;
 			break;
 		}
 
@@ -66,6 +73,11 @@ void SpiralTreeUnobstructedAlgorithm::run() {
 		} else {
 			new_node = handleLeafEvent(event, wavefront);
 		}
+		if (new_node) {
+			m_statistics.handledEvents++;
+		} else {
+			m_statistics.skippedEvents++;
+		}
 
 		// insert join events involving the node that was newly added to the
 		// wavefront, with its two neighbors in the wavefront
@@ -75,15 +87,18 @@ void SpiralTreeUnobstructedAlgorithm::run() {
 			Circulator<Wavefront> ccw_iter = ++make_circulator(*new_node, wavefront);
 			insertJoinEvent(ccw_iter->second, event, events);
 		}
+		m_statistics.peakQueueSize = std::max(m_statistics.peakQueueSize, events.size());
 	}
 }
 
 void SpiralTreeUnobstructedAlgorithm::handleRootEvent(const Event& event, Wavefront& wavefront) {
 	std::shared_ptr<Node> root = event.m_node;
 
-	m_debugPainting->setStroke(Color{240, 120, 0}, 1);
-	m_debugPainting->draw(m_tree.rootPosition());
-	m_debugPainting->drawText(m_tree.rootPosition(), "root");
+	if (m_debugOutput) {
+		m_debugPainting->setStroke(Color{240, 120, 0}, 1);
+		m_debugPainting->draw(m_tree.rootPosition());
+		m_debugPainting->drawText(m_tree.rootPosition(), "root");
+	}
 
 	// if we reached the root, then the wavefront should have only one
 	// node left
@@ -108,10 +123,13 @@ SpiralTreeUnobstructedAlgorithm::handleJoinEvent(const Event& event, Wavefront&
 		return std::nullopt;
 	}
 
-	m_debugPainting->setStroke(Color{0, 120, 240}, 1);
-	m_debugPainting->draw(Circle<Inexact>(m_tree.rootPosition(), event.m_node->m_position.rSquared()));
-	m_debugPainting->drawText(
-	    m_tree.rootPosition() + (event.m_node->m_position.toCartesian() - CGAL::ORIGIN), "join");
+	if (m_debugOutput) {
+		m_debugPainting->setStroke(Color{0, 120, 240}, 1);
+		m_debugPainting->draw(
+		    Circle<Inexact>(m_tree.rootPosition(), event.m_node->m_position.rSquared()));
+		m_debugPainting->drawText(
+		    m_tree.rootPosition() + (event.m_node->m_position.toCartesian() - CGAL::ORIGIN), "join");
+	}
 
 	// add the join node to the wavefront and the collection of nodes
 	const Number<Inexact> angle = event.m_relative_position.phi();
@@ -133,10 +151,13 @@ SpiralTreeUnobstructedAlgorithm::handleJoinEvent(const Event& event, Wavefront&
 SpiralTreeUnobstructedAlgorithm::Wavefront::iterator
 SpiralTreeUnobstructedAlgorithm::handleLeafEvent(Event& event, Wavefront& wavefront) {
 
-	m_debugPainting->setStroke(Color{120, 0, 240}, 1);
-	m_debugPainting->draw(Circle<Inexact>(m_tree.rootPosition(), event.m_node->m_position.rSquared()));
-	m_debugPainting->drawText(
-	    m_tree.rootPosition() + (event.m_node->m_position.toCartesian() - CGAL::ORIGIN), "leaf");
+	if (m_debugOutput) {
+		m_debugPainting->setStroke(Color{120, 0, 240}, 1);
+		m_debugPainting->draw(
+		    Circle<Inexact>(m_tree.rootPosition(), event.m_node->m_position.rSquared()));
+		m_debugPainting->drawText(
+		    m_tree.rootPosition() + (event.m_node->m_position.toCartesian() - CGAL::ORIGIN), "leaf");
+	}
 
 	const Number<Inexact> angle = event.m_relative_position.phi();
 
@@ -189,6 +210,14 @@ void SpiralTreeUnobstructedAlgorithm::insertJoinEvent(const Event& first, const
 	events.push(Event(join, intersection));
 }
 
+const SweepStatistics& SpiralTreeUnobstructedAlgorithm::statistics() const {
+	return m_statistics;
+}
+
+void SpiralTreeUnobstructedAlgorithm::setDebugOutput(bool enabled) {
+	m_debugOutput = enabled;
+}
+
 std::shared_ptr<renderer::GeometryPainting> SpiralTreeUnobstructedAlgorithm::debugPainting() {
 	return m_debugPainting;
 }
@@ -23,6 +23,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define CARTOCROW_FLOW_MAP_SPIRAL_TREE_UNOBSTRUCTED_ALGORTIHM_H
 
 #include "spiral_tree.h"
+#include "sweep_statistics.h"
 
 #include "../renderer/geometry_painting.h"
 #include "../renderer/painting_renderer.h"
@@ -44,12 +45,22 @@ class SpiralTreeUnobstructedAlgorithm {
 
 	/// Runs the algorithm.
 	void run();
+	/// Enables or disables debug output. If enabled, \ref run() draws
+	/// information about the algorithm run into the \ref debugPainting().
+	/// Debug output is disabled by default, as it is expensive for large
+	/// inputs. It does not influence the result of the algorithm.
+	void setDebugOutput(bool enabled);
+
 	/// Returns a \ref GeometryPainting that shows some debug information. This
 	/// painting shows some debug information about the algorithm run. If this
-	/// method is called before \ref run(), this will result in an empty
-	/// painting.
+	/// method is called before \ref run(), or if debug output is disabled
+	/// (see \ref setDebugOutput()), this will result in an empty painting.
 	std::shared_ptr<renderer::GeometryPainting> debugPainting();
 
+	/// Returns statistics about the last run of the algorithm (see \ref
+	/// SweepStatistics).
+	const SweepStatistics& statistics() const;
+
   private:
 	/// The spiral tree we are computing.
 	SpiralTree& m_tree;
@@ -114,6 +125,10 @@ class SpiralTreeUnobstructedAlgorithm {
 	void insertJoinEvent(const Event& first, const Event& second, EventQueue& events);
 
 	std::shared_ptr<renderer::PaintingRenderer> m_debugPainting;
+	/// Whether to produce debug output (see \ref setDebugOutput()).
+	bool m_debugOutput;
+	/// Statistics about the algorithm run (see \ref statistics()).
+	SweepStatistics m_statistics;
 };
 
 } // namespace cartocrow::flow_map
@@ -19,6 +19,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "sweep_circle.h"
 
+#include <algorithm>
+
 #include "polar_segment.h"
 #include "spiral_segment.h"
 
@@ -152,13 +154,12 @@ SweepInterval* SweepCircle::intervalAt(Number<Inexact> phi) {
 	if (m_edges.empty()) {
 		return &*m_onlyInterval;
 	}
-	auto edgeIterator = m_edges.lower_bound(phi);
-	if (edgeIterator == m_edges.end()) {
+	std::size_t index = lowerBound(phi);
+	if (index == m_edges.size()) {
 		// next interval of the last edge
-		return &(*--m_edges.end())->m_nextInterval;
+		return &m_edges.back()->m_nextInterval;
 	}
-	std::shared_ptr<SweepEdge> edge = *edgeIterator;
-	return edge->previousInterval();
+	return m_edges[index]->previousInterval();
 }
 
 SweepCircle::EdgeMap::iterator SweepCircle::begin() {
@@ -167,7 +168,9 @@ SweepCircle::EdgeMap::iterator SweepCircle::begin() {
 
 std::pair<SweepCircle::EdgeMap::iterator, SweepCircle::EdgeMap::iterator>
 SweepCircle::edgesAt(Number<Inexact> phi) {
-	return m_edges.equal_range(phi);
+	auto first = m_edges.begin() + lowerBound(phi);
+	auto last = m_edges.begin() + upperBound(phi);
+	return {first, last};
 }
 
 SweepCircle::EdgeMap::iterator SweepCircle::end() {
@@ -175,18 +178,26 @@ SweepCircle::EdgeMap::iterator SweepCircle::end() {
 }
 
 void SweepCircle::mergeFreeIntervals() {
-	std::vector<EdgeMap::iterator> toRemove;
-	for (auto edge = m_edges.begin(); edge != m_edges.end(); ++edge) {
-		if ((*edge)->previousInterval()->type() == SweepInterval::Type::FREE &&
-		    (*edge)->nextInterval()->type() == SweepInterval::Type::FREE) {
-			(*edge)->previousInterval()->m_nextBoundary = (*edge)->nextEdge();
-			(*edge)->nextEdge()->m_previousInterval = &(*edge)->previousEdge()->m_nextInterval;
-			toRemove.push_back(edge);
+	// remove the edges in place, keeping the cached φ values with their edges
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < m_edges.size(); ++i) {
+		const std::shared_ptr<SweepEdge>& edge = m_edges[i];
+		if (edge->previousInterval()->type() == SweepInterval::Type::FREE &&
+		    edge->nextInterval()->type() == SweepInterval::Type::FREE) {
+			edge->previousInterval()->m_nextBoundary = edge->nextEdge();
+			edge->nextEdge()->m_previousInterval = &edge->previousEdge()->m_nextInterval;
+			edge->m_onCircle = false;
+			++edge->m_generation;
+			continue;
 		}
+		if (kept != i) {
+			m_edges[kept] = std::move(m_edges[i]);
+			m_phis[kept] = m_phis[i];
+			m_phiVersions[kept] = m_phiVersions[i];
+		}
+		++kept;
 	}
-	for (auto edge : toRemove) {
-		edge = m_edges.erase(edge);
-	}
+	eraseRange(kept, m_edges.size());
 }
 
 void SweepCircle::freeAllWithActiveDescendant(const std::shared_ptr<Node>& activeDescendant) {
@@ -212,14 +223,10 @@ SweepCircle::ThreeWaySplitResult SweepCircle::splitFromEdge(std::shared_ptr<Swee
 	SweepEdge* nextEdge = oldEdge->nextEdge();
 	SweepInterval nextInterval = oldEdge->m_nextInterval;
 
-	m_edges.erase(oldEdge);
-	oldEdge->m_onCircle = false;
-	m_edges.insert(newRightEdge);
-	newRightEdge->m_onCircle = true;
-	m_edges.insert(newMiddleEdge);
-	newMiddleEdge->m_onCircle = true;
-	m_edges.insert(newLeftEdge);
-	newLeftEdge->m_onCircle = true;
+	eraseEdge(oldEdge);
+	insertEdge(newRightEdge);
+	insertEdge(newMiddleEdge);
+	insertEdge(newLeftEdge);
 
 	if (previousEdge) {
 		previousEdge->m_nextInterval.m_nextBoundary = newRightEdge.get();
@@ -250,12 +257,9 @@ SweepCircle::SplitResult SweepCircle::splitFromEdge(std::shared_ptr<SweepEdge> o
 	SweepEdge* nextEdge = oldEdge->nextEdge();
 	SweepInterval nextInterval = oldEdge->m_nextInterval;
 
-	m_edges.erase(oldEdge);
-	oldEdge->m_onCircle = false;
-	m_edges.insert(newRightEdge);
-	newRightEdge->m_onCircle = true;
-	m_edges.insert(newLeftEdge);
-	newLeftEdge->m_onCircle = true;
+	eraseEdge(oldEdge);
+	insertEdge(newRightEdge);
+	insertEdge(newLeftEdge);
 
 	if (previousEdge) {
 		previousEdge->m_nextInterval.m_nextBoundary = newRightEdge.get();
@@ -285,12 +289,9 @@ SweepCircle::splitFromInterval(std::shared_ptr<SweepEdge> newRightEdge,
 	SweepEdge* previousEdge = interval->previousBoundary();
 	SweepEdge* nextEdge = interval->nextBoundary();
 
-	m_edges.insert(newRightEdge);
-	newRightEdge->m_onCircle = true;
-	m_edges.insert(newMiddleEdge);
-	newMiddleEdge->m_onCircle = true;
-	m_edges.insert(newLeftEdge);
-	newLeftEdge->m_onCircle = true;
+	insertEdge(newRightEdge);
+	insertEdge(newMiddleEdge);
+	insertEdge(newLeftEdge);
 
 	if (previousEdge) {
 		previousEdge->m_nextInterval =
@@ -330,10 +331,8 @@ SweepCircle::SplitResult SweepCircle::splitFromInterval(std::shared_ptr<SweepEdg
 	SweepEdge* previousEdge = interval->previousBoundary();
 	SweepEdge* nextEdge = interval->nextBoundary();
 
-	m_edges.insert(newRightEdge);
-	newRightEdge->m_onCircle = true;
-	m_edges.insert(newLeftEdge);
-	newLeftEdge->m_onCircle = true;
+	insertEdge(newRightEdge);
+	insertEdge(newLeftEdge);
 
 	if (previousEdge) {
 		previousEdge->m_nextInterval =
@@ -371,10 +370,8 @@ SweepCircle::SwitchResult SweepCircle::switchEdge(std::shared_ptr<SweepEdge> e,
 	newEdge->m_previousInterval = &previousEdge->m_nextInterval;
 	newEdge->m_nextInterval = SweepInterval(e->m_nextInterval, newEdge.get(), nextEdge);
 
-	m_edges.erase(e);
-	e->m_onCircle = false;
-	m_edges.insert(newEdge);
-	newEdge->m_onCircle = true;
+	eraseEdge(e);
+	insertEdge(newEdge);
 
 	nextEdge->m_previousInterval = &newEdge->m_nextInterval;
 
@@ -392,12 +389,17 @@ SweepCircle::SwitchResult SweepCircle::mergeToEdge(std::shared_ptr<SweepEdge> ri
 	newEdge->m_nextInterval = SweepInterval(leftEdge->m_nextInterval, newEdge.get(), nextEdge);
 	nextEdge->m_previousInterval = &newEdge->m_nextInterval;
 
-	m_edges.erase(rightEdge);
-	rightEdge->m_onCircle = false;
-	m_edges.erase(leftEdge);
-	leftEdge->m_onCircle = false;
-	m_edges.insert(newEdge);
-	newEdge->m_onCircle = true;
+	// if the new edge is one of the merged edges, it stays on the circle (and
+	// keeps its generation)
+	if (newEdge != rightEdge) {
+		eraseEdge(rightEdge);
+	}
+	if (newEdge != leftEdge) {
+		eraseEdge(leftEdge);
+	}
+	if (newEdge != rightEdge && newEdge != leftEdge) {
+		insertEdge(newEdge);
+	}
 
 	return SwitchResult{newEdge->previousInterval(), newEdge->nextInterval()};
 }
@@ -413,10 +415,8 @@ SweepCircle::MergeResult SweepCircle::mergeToInterval(std::shared_ptr<SweepEdge>
 		nextEdge->m_previousInterval = &previousEdge->m_nextInterval;
 	}
 
-	m_edges.erase(rightEdge);
-	rightEdge->m_onCircle = false;
-	m_edges.erase(leftEdge);
-	leftEdge->m_onCircle = false;
+	eraseEdge(rightEdge);
+	eraseEdge(leftEdge);
 
 	if (m_edges.empty()) {
 		m_onlyInterval = interval;
@@ -427,42 +427,134 @@ SweepCircle::MergeResult SweepCircle::mergeToInterval(std::shared_ptr<SweepEdge>
 }
 
 void SweepCircle::setRadius(Number<Inexact> r) {
+	if (r == m_r) {
+		return;
+	}
 	Number<Inexact> previousR = m_r;
+	std::size_t previousVersion = m_radiusVersion;
 	m_r = r;
+	++m_radiusVersion;
 
 	if (m_edges.empty()) {
 		return;
 	}
 
-	std::vector<EdgeMap::node_type> toReinsert;
-	// remove edges that moved counter-clockwise over the φ = π ray
-	for (auto e = --m_edges.end(); e != m_edges.begin(); --e) {
-		auto beforeGrowing = (*e)->shape().evalForR(previousR);
-		auto afterGrowing = (*e)->shape().evalForR(r);
-		if (beforeGrowing.phi() > M_PI / 2 && afterGrowing.phi() < 0) {
-			/*std::cout << "counter-clockwise wraparound at φ = " << afterGrowing.phi() / M_PI << "π"
-			          << std::endl;*/
-			toReinsert.push_back(m_edges.extract(e));
+	// φ of the i-th edge at the previous radius (normalized like evalForR()
+	// does), from the cache if possible
+	auto previousPhiAt = [&](std::size_t i) {
+		if (m_phiVersions[i] == previousVersion) {
+			return wrapAngle(m_phis[i], -M_PI);
+		}
+		return m_edges[i]->shape().evalForR(previousR).phi();
+	};
+
+	// find edges at the end that moved counter-clockwise over the φ = π ray
+	std::size_t ccwFirst = m_edges.size();
+	while (ccwFirst > 1) {
+		std::size_t i = ccwFirst - 1;
+		Number<Inexact> beforeGrowing = previousPhiAt(i);
+		Number<Inexact> afterGrowing = m_edges[i]->shape().evalForR(r).phi();
+		if (beforeGrowing > M_PI / 2 && afterGrowing < 0) {
+			--ccwFirst;
 		} else {
 			break;
 		}
 	}
-	// remove edges that moved clockwise over the φ = π ray
-	for (auto e = m_edges.begin(); e != --m_edges.end(); ++e) {
-		auto beforeGrowing = (*e)->shape().evalForR(previousR);
-		auto afterGrowing = (*e)->shape().evalForR(r);
-		if (beforeGrowing.phi() < -M_PI / 2 && afterGrowing.phi() > 0) {
-			/*std::cout << "clockwise wraparound at φ = " << afterGrowing.phi() / M_PI << "π"
-			          << std::endl;*/
-			toReinsert.push_back(m_edges.extract(e));
+	// find edges at the start that moved clockwise over the φ = π ray
+	std::size_t cwLast = 0;
+	while (cwLast + 1 < ccwFirst) {
+		Number<Inexact> beforeGrowing = previousPhiAt(cwLast);
+		Number<Inexact> afterGrowing = m_edges[cwLast]->shape().evalForR(r).phi();
+		if (beforeGrowing < -M_PI / 2 && afterGrowing > 0) {
+			++cwLast;
 		} else {
 			break;
 		}
 	}
-	// reinsert them
-	for (auto& node : toReinsert) {
-		m_edges.insert(std::move(node));
+	if (ccwFirst == m_edges.size() && cwLast == 0) {
+		return;
+	}
+
+	// remove them and reinsert them at the other side
+	std::vector<std::shared_ptr<SweepEdge>> toReinsert(m_edges.begin() + ccwFirst, m_edges.end());
+	toReinsert.insert(toReinsert.end(), m_edges.begin(), m_edges.begin() + cwLast);
+	eraseRange(ccwFirst, m_edges.size());
+	eraseRange(0, cwLast);
+	for (const std::shared_ptr<SweepEdge>& edge : toReinsert) {
+		insertEdge(edge);
+	}
+}
+
+Number<Inexact> SweepCircle::phiAt(std::size_t i) {
+	if (m_phiVersions[i] != m_radiusVersion) {
+		m_phis[i] = m_edges[i]->shape().phiForR(m_r);
+		m_phiVersions[i] = m_radiusVersion;
+	}
+	return m_phis[i];
+}
+
+std::size_t SweepCircle::lowerBound(Number<Inexact> phi) {
+	std::size_t first = 0;
+	std::size_t count = m_edges.size();
+	while (count > 0) {
+		std::size_t step = count / 2;
+		if (phiAt(first + step) < phi) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+std::size_t SweepCircle::upperBound(Number<Inexact> phi) {
+	std::size_t first = 0;
+	std::size_t count = m_edges.size();
+	while (count > 0) {
+		std::size_t step = count / 2;
+		if (!(phi < phiAt(first + step))) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+void SweepCircle::insertEdge(const std::shared_ptr<SweepEdge>& edge) {
+	Number<Inexact> phi = edge->shape().phiForR(m_r);
+	std::size_t index = upperBound(phi);
+	m_edges.insert(m_edges.begin() + index, edge);
+	m_phis.insert(m_phis.begin() + index, phi);
+	m_phiVersions.insert(m_phiVersions.begin() + index, m_radiusVersion);
+	edge->m_onCircle = true;
+}
+
+void SweepCircle::eraseEdge(const std::shared_ptr<SweepEdge>& edge) {
+	// look for the edge among the edges with the same φ first; fall back to a
+	// linear search in case floating-point inaccuracy put it elsewhere
+	Number<Inexact> phi = edge->shape().phiForR(m_r);
+	std::size_t index = lowerBound(phi);
+	std::size_t last = upperBound(phi);
+	while (index < last && m_edges[index] != edge) {
+		++index;
 	}
+	if (index == last) {
+		index = std::find(m_edges.begin(), m_edges.end(), edge) - m_edges.begin();
+	}
+	if (index < m_edges.size()) {
+		eraseRange(index, index + 1);
+	}
+	edge->m_onCircle = false;
+	++edge->m_generation;
+}
+
+void SweepCircle::eraseRange(std::size_t first, std::size_t last) {
+	m_edges.erase(m_edges.begin() + first, m_edges.begin() + last);
+	m_phis.erase(m_phis.begin() + first, m_phis.begin() + last);
+	m_phiVersions.erase(m_phiVersions.begin() + first, m_phiVersions.begin() + last);
 }
 
 const SweepCircle::EdgeMap& SweepCircle::edges() const {
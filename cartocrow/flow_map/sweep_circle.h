@@ -21,7 +21,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define CARTOCROW_FLOW_MAP_SWEEP_CIRCLE_H
 
 #include <ostream>
-#include <set>
+#include <vector>
 
 #include "../core/core.h"
 #include "cartocrow/flow_map/node.h"
@@ -111,32 +111,19 @@ class SweepCircle {
 	/// any structural changes to the sweep circle occur.
 	SweepInterval* intervalAt(Number<Inexact> phi);
 
-	/// Comparator that compares sweep edges by their phi value at the current
-	/// radius of the sweep circle.
-	struct SweepEdgeComparator {
-		SweepEdgeComparator(SweepCircle* owner) : m_owner(owner) {}
-		SweepCircle* m_owner;
-		bool operator()(std::shared_ptr<SweepEdge> e1, std::shared_ptr<SweepEdge> e2) const {
-			return e1->shape().phiForR(m_owner->m_r) < e2->shape().phiForR(m_owner->m_r);
-		}
-		bool operator()(Number<Inexact> phi1, std::shared_ptr<SweepEdge> e2) const {
-			return phi1 < e2->shape().phiForR(m_owner->m_r);
-		}
-		bool operator()(std::shared_ptr<SweepEdge> e1, Number<Inexact> phi2) const {
-			return e1->shape().phiForR(m_owner->m_r) < phi2;
-		}
-		struct is_transparent {};
-	};
-
-	/// The unordered set (actually a map, mapping edge shapes to SweepEdges)
-	/// storing the edges.
-	using EdgeMap = std::multiset<std::shared_ptr<SweepEdge>, SweepEdgeComparator>;
+	/// The edges on the sweep circle, ordered by their \f$\phi\f$ value at the
+	/// current radius of the sweep circle.
+	///
+	/// This is a sorted vector rather than a tree-based set, because the sweep
+	/// circle is queried much more often than it is changed. Note that
+	/// structural changes to the sweep circle invalidate iterators into it.
+	using EdgeMap = std::vector<std::shared_ptr<SweepEdge>>;
 
 	/// Returns an iterator pointing at the first edge on the sweep circle.
 	EdgeMap::iterator begin();
 
 	/// Returns a pair of iterators representing the range of edges at the given
-	/// angle \f$\phi\f$, like \ref std::multiset::equal_range().
+	/// angle \f$\phi\f$, like \ref std::equal_range().
 	std::pair<EdgeMap::iterator, EdgeMap::iterator> edgesAt(Number<Inexact> phi);
 
 	/// Returns a past-the-end iterator, pointing past the last edge on the
@@ -215,7 +202,8 @@ class SweepCircle {
 
 	/// Removes two edges and replaces them by a single new edge. Assumes that
 	/// the far endpoints of both edges coincides and lies currently on this
-	/// sweep circle.
+	/// sweep circle. The new edge may be one of the two edges, in which case
+	/// that edge simply stays on the circle.
 	SwitchResult mergeToEdge(std::shared_ptr<SweepEdge> rightEdge,
 	                         std::shared_ptr<SweepEdge> leftEdge, std::shared_ptr<SweepEdge> newEdge);
 	/// Removes two edges and replaces them by a new interval. Assumes that the
@@ -224,9 +212,8 @@ class SweepCircle {
 	MergeResult mergeToInterval(std::shared_ptr<SweepEdge> rightEdge,
 	                            std::shared_ptr<SweepEdge> leftEdge);
 
-	/// A map containing the sweep edges separating the intervals, indexed by
-	/// their edge shapes.
-	EdgeMap m_edges{SweepEdgeComparator(this)};
+	/// The sweep edges separating the intervals, in counter-clockwise order.
+	EdgeMap m_edges;
 	/// If \ref m_edges is empty, this stores the one interval on the sweep
 	/// circle.
 	std::optional<SweepInterval> m_onlyInterval;
@@ -247,6 +234,35 @@ class SweepCircle {
 	/// ray are properly handled, that is, they move to the other side of the
 	/// data structure.
 	void setRadius(Number<Inexact> r);
+
+	/// Returns the \f$\phi\f$ value of the <code>i</code>-th edge at the
+	/// current radius. This value is computed at most once per radius.
+	Number<Inexact> phiAt(std::size_t i);
+	/// Returns the index of the first edge with \f$\phi\f$ value not less
+	/// than the given angle.
+	std::size_t lowerBound(Number<Inexact> phi);
+	/// Returns the index of the first edge with \f$\phi\f$ value greater
+	/// than the given angle.
+	std::size_t upperBound(Number<Inexact> phi);
+	/// Inserts an edge at its position on the sweep circle (after any edges
+	/// with the same \f$\phi\f$ value) and marks it as being on the circle.
+	void insertEdge(const std::shared_ptr<SweepEdge>& edge);
+	/// Removes an edge from the sweep circle and marks it as not being on the
+	/// circle. Other edges with the same \f$\phi\f$ value are not removed.
+	void eraseEdge(const std::shared_ptr<SweepEdge>& edge);
+	/// Removes the edges with indices in the range <code>[first, last)</code>
+	/// from the sweep circle, without changing their on-circle state.
+	void eraseRange(std::size_t first, std::size_t last);
+
+	/// The cached \f$\phi\f$ value of each edge in \ref m_edges (at the same
+	/// index). The value is only valid if the corresponding entry in \ref
+	/// m_phiVersions equals \ref m_radiusVersion.
+	std::vector<Number<Inexact>> m_phis;
+	/// The radius version at which each value in \ref m_phis was computed.
+	std::vector<std::size_t> m_phiVersions;
+	/// Counter that is incremented every time the radius changes, so that all
+	/// cached \f$\phi\f$ values are invalidated at once.
+	std::size_t m_radiusVersion = 0;
 };
 
 } // namespace cartocrow::flow_map
@@ -170,6 +170,25 @@ std::optional<Number<Inexact>> SweepEdgeShape::intersectOutwardsWith(const Sweep
 	}
 	Number<Inexact> alpha = this->type() != Type::SEGMENT ? m_alpha : other.m_alpha;
 
+	Number<Inexact> rMax = std::numeric_limits<Number<Inexact>>::infinity();
+	if (farR()) {
+		rMax = std::min(rMax, *farR());
+	}
+	if (other.farR()) {
+		rMax = std::min(rMax, *other.farR());
+	}
+
+	// fast path: two spirals intersect in closed form
+	if (this->type() != Type::SEGMENT && other.type() != Type::SEGMENT) {
+		std::optional<Number<Inexact>> r = spiralCrossingFrom(other, rMin, true);
+		if (!r || *r > rMax) {
+			return std::nullopt;
+		}
+		if (isCrossingAt(other, *r)) {
+			return r;
+		}
+	}
+
 	auto isLeftOf = [&](Number<Inexact> r) {
 		return PolarSegment(evalForR(r), other.evalForR(r)).isLeftLine();
 	};
@@ -181,14 +200,6 @@ std::optional<Number<Inexact>> SweepEdgeShape::intersectOutwardsWith(const Sweep
 		initiallyLeftOfOther = isLeftOf(rMin);
 	}
 
-	Number<Inexact> rMax = std::numeric_limits<Number<Inexact>>::infinity();
-	if (farR()) {
-		rMax = std::min(rMax, *farR());
-	}
-	if (other.farR()) {
-		rMax = std::min(rMax, *other.farR());
-	}
-
 	Number<Inexact> rLower = rMin;
 	Number<Inexact> rUpper = rLower;
 	Number<Inexact> rLimit = std::min(rMax, rMin * std::exp(2 * M_PI / std::tan(alpha)));
@@ -248,6 +259,25 @@ std::optional<Number<Inexact>> SweepEdgeShape::intersectInwardsWith(const SweepE
 	}
 	Number<Inexact> alpha = this->type() != Type::SEGMENT ? m_alpha : other.m_alpha;
 
+	Number<Inexact> rMin = 0;
+	if (farR()) {
+		rMin = std::max(rMin, nearR());
+	}
+	if (other.farR()) {
+		rMin = std::max(rMin, other.nearR());
+	}
+
+	// fast path: two spirals intersect in closed form
+	if (this->type() != Type::SEGMENT && other.type() != Type::SEGMENT) {
+		std::optional<Number<Inexact>> r = spiralCrossingFrom(other, rMax, false);
+		if (!r || *r < rMin) {
+			return std::nullopt;
+		}
+		if (isCrossingAt(other, *r)) {
+			return r;
+		}
+	}
+
 	auto isLeftOf = [&](Number<Inexact> r) {
 		return PolarSegment(evalForR(r), other.evalForR(r)).isLeftLine();
 	};
@@ -259,14 +289,6 @@ std::optional<Number<Inexact>> SweepEdgeShape::intersectInwardsWith(const SweepE
 		initiallyLeftOfOther = isLeftOf(rMax);
 	}
 
-	Number<Inexact> rMin = 0;
-	if (farR()) {
-		rMin = std::max(rMin, nearR());
-	}
-	if (other.farR()) {
-		rMin = std::max(rMin, other.nearR());
-	}
-
 	Number<Inexact> rUpper = rMax;
 	Number<Inexact> rLower = rUpper;
 	Number<Inexact> rLimit = std::max(rMin, rMax / std::exp(2 * M_PI / std::tan(alpha)));
@@ -324,6 +346,37 @@ Number<Inexact> SweepEdgeShape::signedAlpha() const {
 	}
 }
 
+std::optional<Number<Inexact>> SweepEdgeShape::spiralCrossingFrom(const SweepEdgeShape& other,
+                                                                  Number<Inexact> r0,
+                                                                  bool outwards) const {
+	assert(m_type != Type::SEGMENT && other.m_type != Type::SEGMENT);
+	// a spiral has φ(r) = φ_s − tan(α) · log(r / r_s), so the angle difference
+	// d(r) = φ(r) − φ_other(r) changes by this amount per unit of log r
+	const Number<Inexact> slope = std::tan(other.signedAlpha()) - std::tan(signedAlpha());
+	if (slope == 0) {
+		return std::nullopt;
+	}
+	// the rate at which d changes while moving away from r0 in the search
+	// direction
+	const Number<Inexact> rate = outwards ? slope : -slope;
+
+	// current angle difference, in [0, 2π); if the spirals intersect at r0
+	// itself, this is 0 and we look for the next intersection
+	const Number<Inexact> d0 = wrapAngle(phiForR(r0) - other.phiForR(r0));
+	Number<Inexact> logDistance;
+	if (rate > 0) {
+		logDistance = (M_2xPI - d0) / rate;
+	} else {
+		logDistance = (d0 > 0 ? d0 : M_2xPI) / -rate;
+	}
+	return outwards ? r0 * std::exp(logDistance) : r0 * std::exp(-logDistance);
+}
+
+bool SweepEdgeShape::isCrossingAt(const SweepEdgeShape& other, Number<Inexact> r) const {
+	const Number<Inexact> tolerance = 1e-9;
+	return std::abs(wrapAngle(phiForR(r) - other.phiForR(r), -M_PI)) <= tolerance;
+}
+
 SweepEdge::SweepEdge(SweepEdgeShape shape)
     : m_shape(shape), m_previousInterval(nullptr),
       m_nextInterval(SweepInterval(SweepInterval::Type::REACHABLE)) {}
@@ -352,4 +405,8 @@ bool SweepEdge::isOnCircle() const {
 	return m_onCircle;
 }
 
+std::size_t SweepEdge::generation() const {
+	return m_generation;
+}
+
 } // namespace cartocrow::flow_map
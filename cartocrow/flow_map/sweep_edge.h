@@ -145,6 +145,11 @@ class SweepEdgeShape {
 	/// edge. Reports the smallest \f$r\f$ of the intersections larger than \c
 	/// rMin. If both this edge and the other edge are a segment, then this
 	/// returns \ref std::nullopt.
+	///
+	/// If both edges are spirals, the intersection is computed in closed form
+	/// (see \ref spiralCrossingFrom()). Otherwise, or if rounding errors make
+	/// the closed-form result unreliable, this falls back to a numerical
+	/// search.
 	/// \todo Not supporting segments is a bit weird...
 	std::optional<Number<Inexact>> intersectOutwardsWith(const SweepEdgeShape& other,
 	                                                     Number<Inexact> rMin) const;
@@ -155,6 +160,9 @@ class SweepEdgeShape {
 	/// edge. Reports the largest \f$r\f$ of the intersections smaller than \c
 	/// rMax. If both this edge and the other edge are a segment, then this
 	/// returns \ref std::nullopt.
+	///
+	/// As for \ref intersectOutwardsWith(), intersections of two spirals are
+	/// computed in closed form.
 	std::optional<Number<Inexact>> intersectInwardsWith(const SweepEdgeShape& other,
 	                                                    Number<Inexact> rMax) const;
 
@@ -167,6 +175,23 @@ class SweepEdgeShape {
 	/// Returns \f$\alpha\f$ for right spirals, \f$-\alpha\f$ for left spirals,
 	/// and `0` for segments.
 	Number<Inexact> signedAlpha() const;
+	/// For two spiral shapes, computes the first \f$r\f$ after `r0` (going
+	/// outwards or inwards) at which this shape and `other` intersect.
+	///
+	/// The angle difference \f$\phi(r) - \phi_\text{other}(r)\f$ between two
+	/// logarithmic spirals is linear in \f$\log r\f$, with slope
+	/// \f$\tan \alpha_\text{other} - \tan \alpha\f$ (using signed angles).
+	/// Hence the spirals intersect exactly where this linear function passes a
+	/// multiple of \f$2\pi\f$, which can be computed directly. Returns \ref
+	/// std::nullopt if the spirals are parallel (that is, of the same type), in
+	/// which case they don't intersect. Bounds of the shapes are not taken
+	/// into account.
+	std::optional<Number<Inexact>> spiralCrossingFrom(const SweepEdgeShape& other,
+	                                                  Number<Inexact> r0, bool outwards) const;
+	/// Checks if \f$r\f$, computed by \ref spiralCrossingFrom(), is indeed an
+	/// intersection of this shape and `other`, up to a small tolerance. This
+	/// filters out closed-form results that suffered from rounding errors.
+	bool isCrossingAt(const SweepEdgeShape& other, Number<Inexact> r) const;
 	/// The type of this sweep edge.
 	Type m_type;
 	/// The start point.
@@ -208,6 +233,13 @@ class SweepEdge {
 	/// Returns whether this edge is currently on the sweep circle. (This is
 	/// maintained by \ref SweepCircle.)
 	bool isOnCircle() const;
+	/// Returns the generation of this edge: the number of times it has been
+	/// taken off the sweep circle. (This is maintained by \ref SweepCircle.)
+	///
+	/// An event can store the generations of its edges when it is created, and
+	/// later check whether they have left the sweep circle in the meantime
+	/// without having to keep the edges alive or track them otherwise.
+	std::size_t generation() const;
 
   private:
 	/// The shape of this sweep edge.
@@ -219,6 +251,8 @@ class SweepEdge {
 	SweepInterval m_nextInterval;
 	/// Whether the edge is currently on the sweep circle.
 	bool m_onCircle = false;
+	/// The number of times the edge has been taken off the sweep circle.
+	std::size_t m_generation = 0;
 
 	friend class SweepCircle;
 };
@@ -0,0 +1,51 @@
+/*
+The Flow Map library implements the algorithmic geo-visualization
+method by the same name, developed by Kevin Verbeek, Kevin Buchin,
+and Bettina Speckmann at TU Eindhoven
+(DOI: 10.1007/s00453-013-9867-z & 10.1109/TVCG.2011.202).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_FLOW_MAP_SWEEP_STATISTICS_H
+#define CARTOCROW_FLOW_MAP_SWEEP_STATISTICS_H
+
+#include <cstddef>
+
+namespace cartocrow::flow_map {
+
+/// Counters describing a run of one of the sweep algorithms in this module
+/// (\ref ReachableRegionAlgorithm, \ref SpiralTreeObstructedAlgorithm, and
+/// \ref SpiralTreeUnobstructedAlgorithm). These are meant for benchmarking and
+/// don't influence the result of the algorithm.
+struct SweepStatistics {
+	/// The number of events that were handled.
+	std::size_t handledEvents = 0;
+	/// The number of events that were taken from the event queue, but skipped
+	/// because they had become invalid in the meantime.
+	std::size_t skippedEvents = 0;
+	/// The largest number of events in the event queue at any point during the
+	/// run.
+	std::size_t peakQueueSize = 0;
+	/// The number of separate sweeps. \ref ReachableRegionAlgorithm can sweep
+	/// independent angular sectors separately (see \ref
+	/// ReachableRegionAlgorithm::setThreadCount()); the other algorithms always
+	/// do a single sweep.
+	std::size_t sweeps = 0;
+};
+
+} // namespace cartocrow::flow_map
+
+#endif //CARTOCROW_FLOW_MAP_SWEEP_STATISTICS_H
@@ -0,0 +1,206 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "bezier_chain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace cartocrow::isoline_simplification {
+namespace {
+/// Tolerance on curve parameters, for roots just outside \f$[0, 1]\f$ and for roots that coincide.
+constexpr double PARAMETER_TOLERANCE = 1E-9;
+
+double evaluate_bezier(const double* p, double t) {
+	const double s = 1 - t;
+	return s * s * s * p[0] + 3 * s * s * t * p[1] + 3 * s * t * t * p[2] + t * t * t * p[3];
+}
+}
+
+int unit_cubic_roots(double c0, double c1, double c2, double c3, double roots[3]) {
+	const double scale = std::max({std::abs(c0), std::abs(c1), std::abs(c2), std::abs(c3)});
+	if (scale == 0) {
+		return 0;
+	}
+	const double eps = 1E-12 * scale;
+
+	double candidates[3];
+	int count = 0;
+	if (std::abs(c3) <= eps) {
+		if (std::abs(c2) <= eps) {
+			if (std::abs(c1) <= eps) {
+				return 0;
+			}
+			candidates[count++] = -c0 / c1;
+		} else {
+			const double discriminant = c1 * c1 - 4 * c2 * c0;
+			if (discriminant >= 0) {
+				// avoids cancellation between -c1 and the square root
+				const double q = -0.5 * (c1 + std::copysign(std::sqrt(discriminant), c1));
+				candidates[count++] = q / c2;
+				if (q != 0) {
+					candidates[count++] = c0 / q;
+				}
+			}
+		}
+	} else {
+		const double a = c2 / c3;
+		const double b = c1 / c3;
+		const double c = c0 / c3;
+		const double q = (a * a - 3 * b) / 9;
+		const double r = (2 * a * a * a - 9 * a * b + 27 * c) / 54;
+		const double q3 = q * q * q;
+		// with a double root r * r equals q3, but rounding may put it on either side; on the wrong side the double
+		// root would be lost, so near-equality is treated as three real roots
+		if (q3 > 0 && r * r < q3 * (1 + 1E-9)) {
+			const double theta = std::acos(std::clamp(r / std::sqrt(q3), -1.0, 1.0));
+			const double f = -2 * std::sqrt(q);
+			candidates[count++] = f * std::cos(theta / 3) - a / 3;
+			candidates[count++] = f * std::cos((theta + 2 * std::numbers::pi) / 3) - a / 3;
+			candidates[count++] = f * std::cos((theta - 2 * std::numbers::pi) / 3) - a / 3;
+		} else {
+			const double big = -std::copysign(std::cbrt(std::abs(r) + std::sqrt(r * r - q3)), r);
+			const double small = big == 0 ? 0 : q / big;
+			candidates[count++] = big + small - a / 3;
+		}
+	}
+
+	int found = 0;
+	for (int i = 0; i < count; i++) {
+		double t = candidates[i];
+		// dividing by a small c3 loses precision, which a Newton step on the original polynomial recovers
+		const double derivative = (3 * c3 * t + 2 * c2) * t + c1;
+		if (derivative != 0) {
+			t -= (((c3 * t + c2) * t + c1) * t + c0) / derivative;
+		}
+		if (t < -PARAMETER_TOLERANCE || t > 1 + PARAMETER_TOLERANCE) {
+			continue;
+		}
+		roots[found++] = std::clamp(t, 0.0, 1.0);
+	}
+	std::sort(roots, roots + found);
+	// double roots may be reported twice
+	return static_cast<int>(
+	    std::unique(roots, roots + found, [](double s, double t) { return t - s < PARAMETER_TOLERANCE; }) - roots);
+}
+
+void BezierChain::set_spline(const double* xs, const double* ys, int n) {
+	if (n < 2) {
+		throw std::runtime_error("A spline needs at least two control points");
+	}
+	const int m = std::max(1, n - 3);
+	m_x.resize(3 * m + 1);
+	m_y.resize(3 * m + 1);
+
+	if (n == 2) {
+		for (int i = 0; i <= 3; i++) {
+			m_x[i] = xs[0] + (xs[1] - xs[0]) * i / 3;
+			m_y[i] = ys[0] + (ys[1] - ys[0]) * i / 3;
+		}
+	} else if (n == 3) {
+		// degree elevation of the quadratic Bézier curve
+		m_x[0] = xs[0];
+		m_y[0] = ys[0];
+		m_x[1] = (xs[0] + 2 * xs[1]) / 3;
+		m_y[1] = (ys[0] + 2 * ys[1]) / 3;
+		m_x[2] = (2 * xs[1] + xs[2]) / 3;
+		m_y[2] = (2 * ys[1] + ys[2]) / 3;
+		m_x[3] = xs[2];
+		m_y[3] = ys[2];
+	} else {
+		// With knots 0, 0, 0, 0, 1, ..., m - 1, m, m, m, m, blossoming shows that the inner control points of curve j
+		// lie on the leg between control points j + 1 and j + 2, which spans the knots max(j - 1, 0) to
+		// min(j + 2, m). Every junction is the midpoint of the control points next to it.
+		for (int j = 0; j < m; j++) {
+			const double lo = std::max(j - 1, 0);
+			const double hi = std::min(j + 2, m);
+			const double w1 = (j - lo) / (hi - lo);
+			const double w2 = (j + 1 - lo) / (hi - lo);
+			m_x[3 * j + 1] = xs[j + 1] + w1 * (xs[j + 2] - xs[j + 1]);
+			m_y[3 * j + 1] = ys[j + 1] + w1 * (ys[j + 2] - ys[j + 1]);
+			m_x[3 * j + 2] = xs[j + 1] + w2 * (xs[j + 2] - xs[j + 1]);
+			m_y[3 * j + 2] = ys[j + 1] + w2 * (ys[j + 2] - ys[j + 1]);
+		}
+		m_x[0] = xs[0];
+		m_y[0] = ys[0];
+		m_x[3 * m] = xs[n - 1];
+		m_y[3 * m] = ys[n - 1];
+		for (int j = 1; j < m; j++) {
+			m_x[3 * j] = (m_x[3 * j - 1] + m_x[3 * j + 1]) / 2;
+			m_y[3 * j] = (m_y[3 * j - 1] + m_y[3 * j + 1]) / 2;
+		}
+	}
+}
+
+int BezierChain::curve_count() const {
+	return static_cast<int>(m_x.size() - 1) / 3;
+}
+
+int BezierChain::intersect_line(double a, double b, double c, double& x, double& y) {
+	const int size = static_cast<int>(m_x.size());
+	m_side.resize(size);
+	for (int i = 0; i < size; i++) {
+		m_side[i] = a * m_x[i] + b * m_y[i] + c;
+	}
+
+	int count = 0;
+	bool previous_ends_on_line = false;
+	for (int j = 0; j < curve_count(); j++) {
+		const double* d = &m_side[3 * j];
+		const bool ends_on_line = previous_ends_on_line;
+		previous_ends_on_line = false;
+		// by the convex hull property, a curve whose control points lie strictly on one side misses the line
+		if ((d[0] > 0 && d[1] > 0 && d[2] > 0 && d[3] > 0) || (d[0] < 0 && d[1] < 0 && d[2] < 0 && d[3] < 0)) {
+			continue;
+		}
+		// the line equation along the curve, converted from the Bernstein to the power basis
+		double roots[3];
+		const int root_count = unit_cubic_roots(d[0], 3 * (d[1] - d[0]), 3 * (d[0] - 2 * d[1] + d[2]),
+		                                        d[3] - d[0] + 3 * (d[1] - d[2]), roots);
+		for (int k = 0; k < root_count; k++) {
+			const double t = roots[k];
+			if (t > 1 - PARAMETER_TOLERANCE) {
+				previous_ends_on_line = true;
+			}
+			// an intersection at a junction was already found on the previous curve
+			if (t < PARAMETER_TOLERANCE && ends_on_line) {
+				continue;
+			}
+			if (++count > 1) {
+				return count;
+			}
+			x = evaluate_bezier(&m_x[3 * j], t);
+			y = evaluate_bezier(&m_y[3 * j], t);
+		}
+	}
+	return count;
+}
+
+BezierSpline BezierChain::to_spline() const {
+	BezierSpline spline;
+	for (int j = 0; j < curve_count(); j++) {
+		const int i = 3 * j;
+		spline.appendCurve(Point<Inexact>(m_x[i], m_y[i]), Point<Inexact>(m_x[i + 1], m_y[i + 1]),
+		                   Point<Inexact>(m_x[i + 2], m_y[i + 2]), Point<Inexact>(m_x[i + 3], m_y[i + 3]));
+	}
+	return spline;
+}
+}
@@ -0,0 +1,64 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_BEZIER_CHAIN_H
+#define CARTOCROW_BEZIER_CHAIN_H
+
+#include "../core/bezier.h"
+
+#include <vector>
+
+namespace cartocrow::isoline_simplification {
+/// Computes the real roots in \f$[0, 1]\f$ of \f$c_0 + c_1 t + c_2 t^2 + c_3 t^3\f$ in closed form, followed by a
+/// Newton step to polish them. Stores the roots in increasing order in \p roots and returns their number. A
+/// polynomial that vanishes everywhere has no isolated roots, so 0 is returned for it.
+int unit_cubic_roots(double c0, double c1, double c2, double c3, double roots[3]);
+
+/// A continuous chain of cubic Bézier curves.
+///
+/// The \f$m\f$ curves are stored as \f$3m + 1\f$ control points, consecutive curves sharing an endpoint. The x- and
+/// y-coordinates are kept in separate arrays so that the loops over control points vectorise, and the storage is
+/// reused when the chain is set again, so a chain that is kept around does not allocate once it has grown to the
+/// largest size needed.
+class BezierChain {
+  public:
+	/// Sets this chain to the clamped uniform cubic B-spline with the \p n given control points, which interpolates
+	/// the first and last control point. For two and three control points this is the line segment and the
+	/// quadratic Bézier curve through them.
+	void set_spline(const double* xs, const double* ys, int n);
+	/// Returns the number of Bézier curves in this chain.
+	int curve_count() const;
+
+	/// Intersects this chain with the line \f$ax + by + c = 0\f$. Returns the number of intersections, but stops
+	/// counting at two; if there is exactly one, it is stored in \p x and \p y. A chain that overlaps the line has no
+	/// isolated intersections, and 0 is returned for it.
+	int intersect_line(double a, double b, double c, double& x, double& y);
+
+	/// Returns the curves of this chain as a spline, for drawing.
+	BezierSpline to_spline() const;
+
+  private:
+	std::vector<double> m_x;
+	std::vector<double> m_y;
+	/// Scratch space for the values of the line equation at the control points.
+	std::vector<double> m_side;
+};
+}
+
+#endif //CARTOCROW_BEZIER_CHAIN_H
@@ -18,83 +18,145 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "collapse.h"
+#include "bezier_chain.h"
 
+#include <cmath>
+#include <iostream>
+#include <limits>
 #include <utility>
 #include <variant>
-#include "ipeshape.h"
-#include "ipegeo.h"
-#include "ipe_bezier_wrapper.h"
+#include <vector>
 
 namespace cartocrow::isoline_simplification {
-SplineCollapse::SplineCollapse(int repetitions, int samples) : m_repetitions(repetitions), m_samples(samples) {};
+namespace {
+/// Scratch space for fitting the splines of \ref SplineCollapse. Each thread keeps one around, so evaluating the
+/// cost of a ladder does not allocate once the buffers have grown to the longest ladder.
+struct SplineFit {
+	/// For every rung, the area-preservation line \f$ax + by + c = 0\f$ on which its new vertex is placed.
+	std::vector<double> a, b, c;
+	/// For every rung, the projection of its midpoint on its line, and the offset between consecutive samples.
+	std::vector<double> mid_x, mid_y, step_x, step_y;
+	/// For every rung, the vertices \f$s, t, u, v\f$ around it in isoline order.
+	std::vector<Point<K>> s, t, u, v;
+	/// The number of samples on the left of the midpoints.
+	int cutoff;
+
+	/// The control points of the current spline, and scratch space for the next.
+	std::vector<double> x, y, next_x, next_y;
+	/// The control points of the best spline so far.
+	std::vector<double> best_x, best_y;
+	BezierChain chain;
+
+	int size() const {
+		return static_cast<int>(a.size());
+	}
+
+	void prepare(const SlopeLadder& ladder, const PointToPoint& p_prev, const PointToPoint& p_next, int samples) {
+		const int n = static_cast<int>(ladder.m_rungs.size());
+		for (auto* values : {&a, &b, &c, &mid_x, &mid_y, &step_x, &step_y, &x, &y, &next_x, &next_y}) {
+			values->resize(n);
+		}
+		for (auto* points : {&s, &t, &u, &v}) {
+			points->resize(n);
+		}
+
+		double left_dist = std::numeric_limits<double>::infinity();
+		double right_dist = std::numeric_limits<double>::infinity();
+		for (int j = 0; j < n; j++) {
+			const auto& rung = ladder.m_rungs[j];
+			auto reversed = p_next.contains(rung.target()) && p_next.at(rung.target()) == rung.source();
+			Point<K> line_s = reversed ? p_next.at(rung.target()) : p_prev.at(rung.source());
+			Point<K> line_v = reversed ? p_prev.at(rung.source()) : p_next.at(rung.target());
+			auto area_l = area_preservation_line(line_s, rung.source(), rung.target(), line_v);
+			a[j] = area_l.a();
+			b[j] = area_l.b();
+			c[j] = area_l.c();
+
+			std::optional<Point<K>> first;
+			std::optional<Point<K>> last;
+			for (auto p : {line_s, rung.source(), rung.target(), line_v}) {
+				auto proj = area_l.projection(p);
+				if (!first.has_value() || point_order_on_line(area_l, proj, *first)) {
+					first = proj;
+				}
+				if (!last.has_value() || point_order_on_line(area_l, *last, proj)) {
+					last = proj;
+				}
+			}
 
-std::vector<ipe::Bezier> SplineCollapse::controls_to_beziers(const std::vector<ipe::Vector>& control_points) const {
-	ipe::Curve curve;
-	curve.appendSpline(control_points);
-	if (curve.countSegments() > 1) {
-		throw std::runtime_error("Expected only one segment in spline.");
+			auto mid = area_l.projection(midpoint(rung));
+			left_dist = std::min(left_dist, sqrt((mid - *first).squared_length()));
+			right_dist = std::min(right_dist, sqrt((*last - mid).squared_length()));
+			mid_x[j] = mid.x();
+			mid_y[j] = mid.y();
+			const auto diff = *last - *first;
+			const double length = sqrt(diff.squared_length());
+			step_x[j] = diff.x() / length;
+			step_y[j] = diff.y() / length;
+
+			t[j] = reversed ? rung.target() : rung.source();
+			u[j] = reversed ? rung.source() : rung.target();
+			s[j] = p_prev.at(t[j]);
+			v[j] = p_next.at(u[j]);
+		}
+
+		const double step = (left_dist + right_dist) / (samples - 1);
+		for (int j = 0; j < n; j++) {
+			step_x[j] *= step;
+			step_y[j] *= step;
+		}
+		cutoff = left_dist / (left_dist + right_dist) * samples;
+	}
+
+	/// Places the control points of the given sample on the lines, and then repeatedly moves each control point to
+	/// the intersection of the spline with its line, if that is unique.
+	void fit(int sample, int repetitions) {
+		const int n = size();
+		const double offset = sample <= cutoff ? -sample : sample - cutoff;
+		for (int j = 0; j < n; j++) {
+			x[j] = mid_x[j] + step_x[j] * offset;
+			y[j] = mid_y[j] + step_y[j] * offset;
+		}
+		for (int r = 0; r < repetitions; r++) {
+			chain.set_spline(x.data(), y.data(), n);
+			for (int j = 0; j < n; j++) {
+				if (chain.intersect_line(a[j], b[j], c[j], next_x[j], next_y[j]) != 1) {
+					next_x[j] = x[j];
+					next_y[j] = y[j];
+				}
+			}
+			std::swap(x, next_x);
+			std::swap(y, next_y);
+		}
 	}
 
-	std::vector<ipe::Bezier> bzs;
-	auto curved_segment = curve.segment(0);
-	curved_segment.beziers(bzs);
-	return bzs;
-}
-
-std::optional<Point<K>> SplineCollapse::intersection(const std::vector<ipe::Bezier>& bzs, const Line<K>& l) const {
-	ipe::Line line = ipe::Line::through(pv(l.point(0)), pv(l.point(1)));
-	std::vector<ipe::Vector> inters;
-	for (auto& b : bzs) {
-		b.intersect(line, inters);
-	}
-	if (inters.size() != 1) {
-		return std::optional<Point<K>>();
+	/// Returns whether a control point nearly coincides with the vertex before or after its rung.
+	bool too_close() const {
+		for (int j = 0; j < size(); j++) {
+			const double sx = s[j].x() - x[j];
+			const double sy = s[j].y() - y[j];
+			const double vx = v[j].x() - x[j];
+			const double vy = v[j].y() - y[j];
+			if (sx * sx + sy * sy < 1E-6 || vx * vx + vy * vy < 1E-6) {
+				return true;
+			}
+		}
+		return false;
 	}
-	return std::optional(vp(inters.front()));
-}
 
-std::vector<ipe::Vector> SplineCollapse::controls_from_intersections(const std::vector<Line<K>>& lines,
-                                            const std::optional<ipe::Vector>& start,
-                                            const std::vector<ipe::Vector>& control_points,
-                                            const std::optional<ipe::Vector>& end) const {
-	std::vector<ipe::Vector> new_controls;
-	std::vector<ipe::Vector> all_controls;
-	if (start.has_value()) {
-		all_controls.push_back(*start);
-	}
-	for (const auto& cp : control_points) {
-		all_controls.push_back(cp);
-	}
-	if (end.has_value()) {
-		all_controls.push_back(*end);
+	double cost() const {
+		double cost = 0.0;
+		for (int j = 0; j < size(); j++) {
+			cost += symmetric_difference(s[j], t[j], u[j], v[j], Point<K>(x[j], y[j]));
+		}
+		return cost;
 	}
-	auto bzs = controls_to_beziers(all_controls);
-	for (int i = 0; i < lines.size(); i++) {
-		auto& l = lines.at(i);
-		Point<K> new_vertex;
+};
 
-		auto inter = intersection(bzs, l);
-		new_vertex = inter.has_value() ? *inter : vp(control_points.at(i));
-		new_controls.push_back(pv(new_vertex));
-	}
-	return new_controls;
+thread_local SplineFit spline_fit;
 }
 
-double SplineCollapse::cost(const SlopeLadder& ladder, const PointToPoint& p_prev, const PointToPoint& p_next, const std::vector<ipe::Vector>& new_vertices) const {
-	double cost = 0.0;
-
-	for (int i = 0; i < ladder.m_rungs.size(); i++) {
-		const auto& rung = ladder.m_rungs[i];
-		auto reversed = p_next.contains(rung.target()) && p_next.at(rung.target()) == rung.source();
-		auto t = reversed ? rung.target() : rung.source();
-		auto u = reversed ? rung.source() : rung.target();
-		Point<K> s = p_prev.at(t);
-		Point<K> v = p_next.at(u);
-		cost += symmetric_difference(s, t, u, v, vp(new_vertices[i]));
-	}
-
-	return cost;
-}
+SplineCollapse::SplineCollapse(int repetitions, int samples) : m_repetitions(repetitions), m_samples(samples) {};
 
 void SplineCollapse::operator()(SlopeLadder& ladder, const PointToPoint& p_prev, const PointToPoint& p_next) {
 	if (!ladder.m_valid)
@@ -106,103 +168,19 @@ void SplineCollapse::operator()(SlopeLadder& ladder, const PointToPoint& p_prev,
 		return;
 	}
 
-	std::optional<ipe::Vector> start;
-//	if (ladder.m_cap.contains(CGAL::LEFT_TURN)) {
-//		start = pv(ladder.m_cap.at(CGAL::LEFT_TURN));
-//	}
-
-	std::optional<ipe::Vector> end;
-//	if (ladder.m_cap.contains(CGAL::RIGHT_TURN)) {
-//		end = pv(ladder.m_cap.at(CGAL::RIGHT_TURN));
-//	}
-
-	std::vector<ipe::Vector> best_controls;
+	SplineFit& fit = spline_fit;
+	fit.prepare(ladder, p_prev, p_next, m_samples);
 	double best_cost = std::numeric_limits<double>::infinity();
 
-	std::vector<std::pair<Point<K>, Point<K>>> intervals;
-	double left_dist = std::numeric_limits<double>::infinity();
-	double right_dist = std::numeric_limits<double>::infinity();
-	std::vector<Line<K>> lines;
-	for (const auto& rung : ladder.m_rungs) {
-		auto reversed =
-		    p_next.contains(rung.target()) && p_next.at(rung.target()) == rung.source();
-		auto t = rung.source();
-		auto u = rung.target();
-		Point<K> s = reversed ? p_next.at(u) : p_prev.at(t);
-		Point<K> v = reversed ? p_prev.at(t) : p_next.at(u);
-		auto area_l = area_preservation_line(s, t, u, v);
-		lines.push_back(area_l);
-
-		std::optional<Point<K>> first;
-		std::optional<Point<K>> last;
-
-		for (auto p : {s, t, u, v}) {
-			auto proj = area_l.projection(p);
-			if (!first.has_value() || point_order_on_line(area_l, proj, *first)) {
-				first = proj;
-			}
-			if (!last.has_value() || point_order_on_line(area_l, *last, proj)) {
-				last = proj;
-			}
-		}
-
-		auto mid = area_l.projection(midpoint(rung));
-		double this_left_dist = sqrt((mid - *first).squared_length());
-		double this_right_dist = sqrt((*last - mid).squared_length());
-		if (this_left_dist < left_dist) {
-			left_dist = this_left_dist;
-		}
-		if (this_right_dist < right_dist) {
-			right_dist = this_right_dist;
-		}
-		intervals.emplace_back(*first, *last);
-	}
-
 	for (int i = 0; i < m_samples; i++) {
-		std::vector<ipe::Vector> initial_controls;
-		for (int j = 0; j < ladder.m_rungs.size(); j++) {
-			const auto& rung = ladder.m_rungs[j];
-			const double step = (left_dist + right_dist) / (m_samples - 1);
-			const auto& [a, b] = intervals[j];
-			const auto diff = (b - a);
-			int cutoff = left_dist / (left_dist + right_dist) * m_samples;
-			auto mid = lines[j].projection(midpoint(rung));
-			const auto step_v = diff / sqrt(diff.squared_length()) * step;
-			if (i <= cutoff) {
-				initial_controls.push_back(pv(mid - step_v * i));
-			} else {
-				initial_controls.push_back(pv(mid + step_v * (i - cutoff)));
-			}
-		}
-
-		if (initial_controls.size() > 1 || start.has_value() || end.has_value()) {
-			for (int j = 0; j < m_repetitions; j++) {
-				initial_controls = controls_from_intersections(lines, start, initial_controls, end);
-			}
-		}
-
-		bool too_close = false;
-		for (int j = 0; j < ladder.m_rungs.size(); j++) {
-			const auto& rung = ladder.m_rungs[j];
-			auto reversed =
-			    p_next.contains(rung.target()) && p_next.at(rung.target()) == rung.source();
-			auto t = reversed ? rung.target() : rung.source();
-			auto u = reversed ? rung.source() : rung.target();
-			Point<K> s = p_prev.at(t);
-			Point<K> v = p_next.at(u);
-			auto p = vp(initial_controls.at(j));
-			if (CGAL::squared_distance(s, p) < 1E-6 || CGAL::squared_distance(p, v) < 1E-6) {
-				too_close = true;
-			}
-		}
-
-		if (too_close) {
+		fit.fit(i, m_repetitions);
+		if (fit.too_close()) {
 			continue;
 		}
-
-		double the_cost = cost(ladder, p_prev, p_next, initial_controls);
+		double the_cost = fit.cost();
 		if (the_cost < best_cost) {
-			best_controls = initial_controls;
+			fit.best_x = fit.x;
+			fit.best_y = fit.y;
 			best_cost = the_cost;
 		}
 	}
@@ -212,9 +190,9 @@ void SplineCollapse::operator()(SlopeLadder& ladder, const PointToPoint& p_prev,
 		MidpointCollapse()(ladder, p_prev, p_next);
 	} else {
 		ladder.m_collapsed.clear();
-		std::transform(best_controls.begin(), best_controls.end(),
-		               std::back_inserter(ladder.m_collapsed),
-		               [](const ipe::Vector& v) { return vp(v); });
+		for (int j = 0; j < fit.size(); j++) {
+			ladder.m_collapsed.emplace_back(fit.best_x[j], fit.best_y[j]);
+		}
 	}
 }
 
@@ -235,17 +213,8 @@ void SplineCollapsePainting::paint(cartocrow::renderer::GeometryRenderer& render
 		return;
 	}
 
-	std::optional<ipe::Vector> start;
-//	if (m_ladder.m_cap.contains(CGAL::LEFT_TURN)) {
-//		start = pv(m_ladder.m_cap.at(CGAL::LEFT_TURN));
-//	}
-
-	std::optional<ipe::Vector> end;
-//	if (m_ladder.m_cap.contains(CGAL::RIGHT_TURN)) {
-//		end = pv(m_ladder.m_cap.at(CGAL::RIGHT_TURN));
-//	}
-
-	auto draw_controls = [&](std::vector<ipe::Vector>& controls, bool best) {
+	SplineFit fit;
+	auto draw_controls = [&](const std::vector<double>& xs, const std::vector<double>& ys, bool best) {
 		renderer.setMode(renderer::GeometryRenderer::stroke);
 		if (!best) {
 			renderer.setStroke(Color{20, 20, 255}, 1.0);
@@ -254,104 +223,33 @@ void SplineCollapsePainting::paint(cartocrow::renderer::GeometryRenderer& render
 			renderer.setStroke(Color{20, 20, 255}, 3.0);
 		}
 
-	    for (const auto& v : controls) {
-	  	  renderer.draw(vp(v));
-	    }
+		for (int j = 0; j < xs.size(); j++) {
+			renderer.draw(Point<K>(xs[j], ys[j]));
+		}
 
-		if (controls.size() > 1 || start.has_value() || end.has_value()) {
-			std::vector<ipe::Vector> all_controls;
-			if (start.has_value()) {
-				all_controls.push_back(*start);
-			}
-			for (const auto& cp : controls) {
-				all_controls.push_back(cp);
-			}
-			if (end.has_value()) {
-				all_controls.push_back(*end);
-			}
-			auto bzs = m_spline_collapse.controls_to_beziers(all_controls);
-			BezierSpline spline;
-			for (const auto& bz : bzs) {
-				spline.appendCurve(vp(bz.iV[0]), vp(bz.iV[1]), vp(bz.iV[2]), vp(bz.iV[3]));
-			}
-			renderer.draw(spline);
+		if (xs.size() > 1) {
+			fit.chain.set_spline(xs.data(), ys.data(), static_cast<int>(xs.size()));
+			renderer.draw(fit.chain.to_spline());
 		}
 	};
 
-	std::vector<ipe::Vector> best_controls;
+	fit.prepare(m_ladder, m_p_prev, m_p_next, m_spline_collapse.m_samples);
 	double best_cost = std::numeric_limits<double>::infinity();
 
-	std::vector<std::pair<Point<K>, Point<K>>> intervals;
-	double left_dist = std::numeric_limits<double>::infinity();
-	double right_dist = std::numeric_limits<double>::infinity();
-	std::vector<Line<K>> lines;
-	for (const auto& rung : m_ladder.m_rungs) {
-		auto reversed = m_p_next.contains(rung.target()) && m_p_next.at(rung.target()) == rung.source();
-		auto t = rung.source();
-		auto u = rung.target();
-		Point<K> s = reversed ? m_p_next.at(u) : m_p_prev.at(t);
-		Point<K> v = reversed ? m_p_prev.at(t) : m_p_next.at(u);
-		lines.emplace_back(area_preservation_line(s, t, u, v));
-		auto& area_l = lines.back();
-
-		std::optional<Point<K>> first;
-		std::optional<Point<K>> last;
-
-		for (auto p : {s, t, u, v}) {
-			auto proj = area_l.projection(p);
-			if (!first.has_value() || point_order_on_line(area_l, proj, *first)) {
-				first = proj;
-			}
-			if (!last.has_value() || point_order_on_line(area_l, *last, proj)) {
-				last = proj;
-			}
-		}
-
-		auto mid = area_l.projection(midpoint(rung));
-		double this_left_dist = sqrt((mid - *first).squared_length());
-		double this_right_dist = sqrt((*last - mid).squared_length());
-		if (this_left_dist < left_dist) {
-			left_dist = this_left_dist;
-		}
-		if (this_right_dist < right_dist) {
-			right_dist = this_right_dist;
-		}
-		intervals.emplace_back(*first, *last);
-	}
-
 	for (int i = 0; i < m_spline_collapse.m_samples; i++) {
-		std::vector<ipe::Vector> initial_controls;
-		for (int j = 0; j < m_ladder.m_rungs.size(); j++) {
-			const auto& rung = m_ladder.m_rungs[j];
-			const double step = (left_dist + right_dist) / (m_spline_collapse.m_samples - 1);
-			const auto& [a, b] = intervals[j];
-			const auto diff = (b - a);
-			int cutoff = left_dist / (left_dist + right_dist) * m_spline_collapse.m_samples;
-			auto mid = lines[j].projection(midpoint(rung));
-			const auto step_v = diff / sqrt(diff.squared_length()) * step;
-			if (i <= cutoff) {
-				initial_controls.push_back(pv(mid - step_v * i));
-			} else {
-				initial_controls.push_back(pv(mid + step_v * (i - cutoff)));
-			}
-		}
-
-		if (initial_controls.size() > 1 || start.has_value() || end.has_value()) {
-			for (int j = 0; j < m_spline_collapse.m_repetitions - 1; j++) { // note the -1 for drawing purposes
-				initial_controls = m_spline_collapse.controls_from_intersections(lines, start, initial_controls, end);
-			}
-		}
+		fit.fit(i, m_spline_collapse.m_repetitions - 1); // note the -1 for drawing purposes
 
-		double the_cost = m_spline_collapse.cost(m_ladder, m_p_prev, m_p_next, initial_controls);
+		double the_cost = fit.cost();
 		if (the_cost < best_cost) {
-			best_controls = initial_controls;
+			fit.best_x = fit.x;
+			fit.best_y = fit.y;
 			best_cost = the_cost;
 		}
 
-		draw_controls(initial_controls, false);
+		draw_controls(fit.x, fit.y, false);
 	}
 
-	draw_controls(best_controls, true);
+	draw_controls(fit.best_x, fit.best_y, true);
 }
 
 Point<K> min_sym_diff_point(Point<K> s, Point<K> t, Point<K> u, Point<K> v, Line<K> l) {
@@ -20,22 +20,33 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_COLLAPSE_H
 #define CARTOCROW_COLLAPSE_H
 
+#include "isoline_topology.h"
 #include "types.h"
 #include "cartocrow/renderer/geometry_painting.h"
-#include "ipeshape.h"
-#include "ipegeo.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
 
 namespace cartocrow::isoline_simplification {
 class SlopeLadder {
   public:
 	SlopeLadder() = default;
 	std::deque<Segment<K>> m_rungs;
+	/// The topology vertices of the source and target of each rung, in the same order as \ref m_rungs. These stay
+	/// valid as long as the ladder is not \ref m_old, because collapsing a vertex marks its ladders old.
+	std::vector<std::pair<VertexId, VertexId>> m_rung_vertices;
 	std::unordered_map<CGAL::Sign, Point<K>> m_cap;
 	std::vector<Point<K>> m_collapsed;
 	double m_cost = 0.0;
 	bool m_valid = true;
 	bool m_old = false;
 	bool m_intersects = false;
+	/// Whether collapsing this ladder was found to violate topology. Such a ladder is kept out of the heap until a
+	/// segment Delaunay vertex in its neighbourhood changes.
+	bool m_blocked = false;
+	/// Incremented whenever the ladder is pushed onto the heap; heap entries with an older version are stale.
+	int m_version = 0;
 	void compute_cost(const PointToPoint& p_prev, const PointToPoint& p_next);
 };
 
@@ -60,14 +71,6 @@ class SplineCollapse : public LadderCollapse {
 
 	int m_repetitions;
 	int m_samples;
-
-	std::vector<ipe::Vector> controls_from_intersections(const std::vector<Line<K>>& lines,
-																	     const std::optional<ipe::Vector>& start,
-																	     const std::vector<ipe::Vector>& control_points,
-																	     const std::optional<ipe::Vector>& end) const;
-	std::vector<ipe::Bezier> controls_to_beziers(const std::vector<ipe::Vector>& control_points) const;
-	std::optional<Point<K>> intersection(const std::vector<ipe::Bezier>& bzs, const Line<K>& l) const;
-	double cost(const SlopeLadder& ladder, const PointToPoint& p_prev, const PointToPoint& p_next, const std::vector<ipe::Vector>& new_vertices) const;
 };
 
 class SplineCollapsePainting : public renderer::GeometryPainting {
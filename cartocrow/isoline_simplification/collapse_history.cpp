@@ -0,0 +1,116 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "collapse_history.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace cartocrow::isoline_simplification {
+void CollapseHistory::clear() {
+	m_nodes.clear();
+	m_step_end.clear();
+	m_complexity.clear();
+}
+
+HistoryNodeId CollapseHistory::add_vertex(const Point<K>& point, int isoline) {
+	m_nodes.push_back(HistoryNode{point, isoline});
+	return static_cast<HistoryNodeId>(m_nodes.size()) - 1;
+}
+
+void CollapseHistory::start(int complexity) {
+	m_step_end = {static_cast<HistoryNodeId>(m_nodes.size())};
+	m_complexity = {complexity};
+}
+
+HistoryNodeId CollapseHistory::collapse(HistoryNodeId first, HistoryNodeId second, const Point<K>& point) {
+	if (m_complexity.empty()) {
+		throw std::runtime_error("Cannot record a collapse before the input is complete");
+	}
+	const int step = step_count() + 1;
+	m_nodes[first].death = step;
+	m_nodes[second].death = step;
+	HistoryNode& node = m_nodes.emplace_back();
+	node.point = point;
+	node.isoline = m_nodes[first].isoline;
+	node.first = first;
+	node.second = second;
+	node.birth = step;
+	return static_cast<HistoryNodeId>(m_nodes.size()) - 1;
+}
+
+void CollapseHistory::finish_step(int complexity) {
+	m_step_end.push_back(static_cast<HistoryNodeId>(m_nodes.size()));
+	m_complexity.push_back(complexity);
+}
+
+int CollapseHistory::step_count() const {
+	return std::max(0, static_cast<int>(m_complexity.size()) - 1);
+}
+
+int CollapseHistory::complexity(int step) const {
+	return m_complexity.at(step);
+}
+
+int CollapseHistory::step_for(int target) const {
+	// the complexity is decreasing, so this is a binary search
+	auto it = std::partition_point(m_complexity.begin(), m_complexity.end(), [target](int c) { return c > target; });
+	if (it == m_complexity.end()) {
+		return step_count();
+	}
+	return static_cast<int>(it - m_complexity.begin());
+}
+
+std::pair<HistoryNodeId, HistoryNodeId> CollapseHistory::created_in(int step) const {
+	if (step < 1 || step > step_count()) {
+		throw std::out_of_range("Step " + std::to_string(step) + " does not exist");
+	}
+	return {m_step_end[step - 1], m_step_end[step]};
+}
+
+const std::vector<HistoryNode>& CollapseHistory::nodes() const {
+	return m_nodes;
+}
+
+bool CollapseHistory::exists_after(HistoryNodeId node, int step) const {
+	const HistoryNode& n = m_nodes.at(node);
+	return n.birth <= step && (n.death == -1 || n.death > step);
+}
+
+void CollapseHistory::expand(HistoryNodeId node, int step, std::vector<Point<K>>& out) const {
+	// a removed node is not part of the simplification after this step
+	if (m_nodes.at(node).death != -1 && m_nodes[node].death <= step) {
+		throw std::invalid_argument("Node " + std::to_string(node) + " was removed in step " +
+		                            std::to_string(m_nodes[node].death));
+	}
+	// chains of repeated collapses can be deep, so we use an explicit stack instead of recursion
+	std::vector<HistoryNodeId> stack = {node};
+	while (!stack.empty()) {
+		const HistoryNode& current = m_nodes[stack.back()];
+		stack.pop_back();
+		if (current.birth <= step) {
+			out.push_back(current.point);
+		} else {
+			stack.push_back(current.second);
+			stack.push_back(current.first);
+		}
+	}
+}
+}
@@ -0,0 +1,102 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_COLLAPSE_HISTORY_H
+#define CARTOCROW_COLLAPSE_HISTORY_H
+
+#include "types.h"
+
+#include <utility>
+#include <vector>
+
+namespace cartocrow::isoline_simplification {
+/// Index of a node in a \ref CollapseHistory.
+typedef int HistoryNodeId;
+/// Value of \ref HistoryNodeId that does not refer to any node.
+constexpr HistoryNodeId NO_HISTORY_NODE = -1;
+
+/// A vertex that existed at some point during simplification.
+struct HistoryNode {
+	/// The location of this vertex.
+	Point<K> point;
+	/// The index of the isoline this vertex is part of.
+	int isoline;
+	/// The two consecutive vertices, in isoline order, that were replaced by this vertex, or \ref NO_HISTORY_NODE
+	/// for input vertices.
+	HistoryNodeId first = NO_HISTORY_NODE;
+	HistoryNodeId second = NO_HISTORY_NODE;
+	/// The step in which this vertex was created; 0 for input vertices.
+	int birth = 0;
+	/// The step in which this vertex was removed, or -1 if it was not removed.
+	int death = -1;
+};
+
+/// The sequence of collapses performed by an \ref IsolineSimplifier, from which the simplification after any number
+/// of steps can be reconstructed.
+///
+/// Every collapse replaces two consecutive vertices of an isoline by a new vertex, so the vertices form a binary
+/// forest whose leaves are the input vertices. The simplification after step \f$k\f$ consists of the vertices
+/// created at or before step \f$k\f$ that were not removed by then. These are found by expanding the vertices of
+/// the final simplification top-down, which takes time linear in the size of the output.
+///
+/// Nodes are stored in order of creation, so the nodes created in a step form a contiguous range (see \ref
+/// created_in). Each of them, together with its two children, describes an edge collapse that can be sent to a
+/// client as a level-of-detail delta: applying the collapses of steps \f$k+1, \dots, l\f$ to the simplification
+/// after step \f$k\f$ gives the one after step \f$l\f$, and undoing them in reverse goes back.
+class CollapseHistory {
+  public:
+	/// Removes all nodes and steps.
+	void clear();
+	/// Adds an input vertex.
+	HistoryNodeId add_vertex(const Point<K>& point, int isoline);
+	/// Marks the end of the input, which consists of \p complexity vertices.
+	void start(int complexity);
+	/// Records that the consecutive vertices \p first and \p second are replaced by a vertex at \p point in the
+	/// current step.
+	HistoryNodeId collapse(HistoryNodeId first, HistoryNodeId second, const Point<K>& point);
+	/// Marks the end of the current step, after which \p complexity vertices remain.
+	void finish_step(int complexity);
+
+	/// Returns the number of completed steps.
+	int step_count() const;
+	/// Returns the number of vertices after the given step; step 0 is the input.
+	int complexity(int step) const;
+	/// Returns the first step after which at most \p target vertices remain, or the last step if there is none.
+	int step_for(int target) const;
+	/// Returns the range of indices of the nodes created in the given step.
+	std::pair<HistoryNodeId, HistoryNodeId> created_in(int step) const;
+	const std::vector<HistoryNode>& nodes() const;
+
+	/// Checks whether the given node existed after the given step, that is, whether it was created at or before
+	/// that step and not removed by then.
+	bool exists_after(HistoryNodeId node, int step) const;
+	/// Appends to \p out the vertices, in isoline order, that the given node consisted of after the given step.
+	/// Throws \c std::invalid_argument if the node was removed by then.
+	void expand(HistoryNodeId node, int step, std::vector<Point<K>>& out) const;
+
+  private:
+	std::vector<HistoryNode> m_nodes;
+	/// For every step, the index of the first node created after it.
+	std::vector<HistoryNodeId> m_step_end;
+	/// For every step, the number of vertices after it.
+	std::vector<int> m_complexity;
+};
+}
+
+#endif //CARTOCROW_COLLAPSE_HISTORY_H
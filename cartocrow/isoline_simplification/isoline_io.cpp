@@ -0,0 +1,267 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "isoline_io.h"
+#include "ipe_isolines.h"
+
+#include <gdal/ogrsf_frmts.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace cartocrow::isoline_simplification {
+namespace {
+struct DatasetCloser {
+	void operator()(GDALDataset* dataset) const {
+		GDALClose(dataset);
+	}
+};
+typedef std::unique_ptr<GDALDataset, DatasetCloser> DatasetPtr;
+
+void appendCurve(const OGRSimpleCurve& curve, bool closed, std::vector<Point<K>>& buffer,
+                 std::vector<Isoline<K>>& isolines) {
+	const int n = curve.getNumPoints();
+	buffer.clear();
+	buffer.reserve(n);
+	for (int i = 0; i < n; i++) {
+		buffer.emplace_back(curve.getX(i), curve.getY(i));
+	}
+	if (buffer.size() > 1 && buffer.front() == buffer.back()) {
+		buffer.pop_back();
+		closed = true;
+	}
+	if (!buffer.empty()) {
+		isolines.emplace_back(buffer, closed);
+	}
+}
+
+void appendGeometry(const OGRGeometry& geometry, std::vector<Point<K>>& buffer, std::vector<Isoline<K>>& isolines) {
+	switch (wkbFlatten(geometry.getGeometryType())) {
+	case wkbLineString:
+		appendCurve(*geometry.toLineString(), false, buffer, isolines);
+		break;
+	case wkbPolygon:
+		for (const auto& ring : *geometry.toPolygon()) {
+			appendCurve(*ring, true, buffer, isolines);
+		}
+		break;
+	case wkbMultiLineString:
+	case wkbMultiPolygon:
+	case wkbGeometryCollection:
+		for (const auto& part : *geometry.toGeometryCollection()) {
+			appendGeometry(*part, buffer, isolines);
+		}
+		break;
+	default:
+		std::cerr << "Skipping geometry of type " << geometry.getGeometryName() << std::endl;
+	}
+}
+
+constexpr std::array<char, 8> BINARY_MAGIC = {'C', 'C', 'I', 'S', 'O', 'L', 'N', 'S'};
+constexpr std::uint32_t BINARY_VERSION = 1;
+
+struct BinaryHeader {
+	std::array<char, 8> magic;
+	std::uint32_t version;
+	std::uint32_t reserved;
+	std::uint64_t isolineCount;
+	std::uint64_t pointCount;
+};
+static_assert(sizeof(BinaryHeader) == 32);
+
+std::size_t closedFlagsSize(std::uint64_t isolineCount) {
+	return (isolineCount + 7) / 8 * 8;
+}
+}
+
+std::vector<Isoline<K>> gdalToIsolines(const std::filesystem::path& file,
+                                       const std::optional<std::string>& layerName) {
+	GDALAllRegister();
+	DatasetPtr dataset(static_cast<GDALDataset*>(
+	    GDALOpenEx(file.string().c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr)));
+	if (!dataset) {
+		throw std::runtime_error("Cannot open " + file.string() + " as a vector dataset");
+	}
+	OGRLayer* layer =
+	    layerName.has_value() ? dataset->GetLayerByName(layerName->c_str()) : dataset->GetLayer(0);
+	if (layer == nullptr) {
+		throw std::runtime_error("Cannot find the isoline layer in " + file.string());
+	}
+
+	std::vector<Isoline<K>> isolines;
+	// only reserve if the driver knows the count without scanning the file
+	if (GIntBig count = layer->GetFeatureCount(false); count > 0) {
+		isolines.reserve(count);
+	}
+	std::vector<Point<K>> buffer;
+	layer->ResetReading();
+	for (const auto& feature : *layer) {
+		if (const OGRGeometry* geometry = feature->GetGeometryRef()) {
+			appendGeometry(*geometry, buffer, isolines);
+		}
+	}
+	return isolines;
+}
+
+void isolinesToGdal(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file,
+                    const std::string& driverName, const std::string& layerName) {
+	GDALAllRegister();
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName(driverName.c_str());
+	if (driver == nullptr) {
+		throw std::runtime_error("GDAL driver " + driverName + " is not available");
+	}
+	DatasetPtr dataset(driver->Create(file.string().c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+	if (!dataset) {
+		throw std::runtime_error("Cannot create " + file.string());
+	}
+	OGRLayer* layer = dataset->CreateLayer(layerName.c_str(), nullptr, wkbLineString, nullptr);
+	if (layer == nullptr) {
+		throw std::runtime_error("Cannot create layer " + layerName + " in " + file.string());
+	}
+
+	// a single transaction avoids a commit per feature for database formats such as GeoPackage
+	dataset->StartTransaction();
+	for (const auto& isoline : isolines) {
+		OGRLineString line;
+		line.setNumPoints(static_cast<int>(isoline.m_points.size() + (isoline.m_closed ? 1 : 0)), false);
+		int i = 0;
+		for (const auto& point : isoline.m_points) {
+			line.setPoint(i++, point.x(), point.y());
+		}
+		if (isoline.m_closed && !isoline.m_points.empty()) {
+			line.setPoint(i, isoline.m_points.front().x(), isoline.m_points.front().y());
+		}
+		OGRFeature feature(layer->GetLayerDefn());
+		feature.SetGeometry(&line);
+		if (layer->CreateFeature(&feature) != OGRERR_NONE) {
+			throw std::runtime_error("Cannot write isoline to " + file.string());
+		}
+	}
+	dataset->CommitTransaction();
+}
+
+std::vector<Isoline<K>> binaryToIsolines(const std::filesystem::path& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Cannot open " + file.string());
+	}
+	BinaryHeader header;
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!in || header.magic != BINARY_MAGIC) {
+		throw std::runtime_error(file.string() + " is not a binary isoline file");
+	}
+	if (header.version != BINARY_VERSION) {
+		throw std::runtime_error("Unsupported binary isoline file version " + std::to_string(header.version));
+	}
+
+	// check the counts against the file size before allocating anything based on them (the divisions avoid
+	// overflow in the computation of the expected size)
+	const std::uintmax_t remaining = std::filesystem::file_size(file) - sizeof(header);
+	if (header.isolineCount >= remaining / sizeof(std::uint64_t) ||
+	    header.pointCount > remaining / (2 * sizeof(double))) {
+		throw std::runtime_error(file.string() + " is truncated");
+	}
+	const std::uintmax_t expectedSize = (header.isolineCount + 1) * sizeof(std::uint64_t) +
+	                                    closedFlagsSize(header.isolineCount) +
+	                                    header.pointCount * 2 * sizeof(double);
+	if (expectedSize > remaining) {
+		throw std::runtime_error(file.string() + " is truncated");
+	} else if (expectedSize < remaining) {
+		throw std::runtime_error(file.string() + " is corrupt");
+	}
+
+	std::vector<std::uint64_t> offsets(header.isolineCount + 1);
+	in.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+	std::vector<std::uint8_t> closed(closedFlagsSize(header.isolineCount));
+	in.read(reinterpret_cast<char*>(closed.data()), closed.size());
+	// with non-decreasing offsets from 0 to pointCount, every isoline fits in the coordinate section
+	if (!in || offsets.front() != 0 || offsets.back() != header.pointCount ||
+	    !std::is_sorted(offsets.begin(), offsets.end())) {
+		throw std::runtime_error(file.string() + " is corrupt");
+	}
+
+	std::vector<Isoline<K>> isolines;
+	isolines.reserve(header.isolineCount);
+	std::vector<double> coordinates;
+	std::vector<Point<K>> buffer;
+	for (std::uint64_t i = 0; i < header.isolineCount; i++) {
+		const std::size_t n = offsets[i + 1] - offsets[i];
+		coordinates.resize(2 * n);
+		in.read(reinterpret_cast<char*>(coordinates.data()), coordinates.size() * sizeof(double));
+		if (!in) {
+			throw std::runtime_error(file.string() + " is truncated");
+		}
+		buffer.clear();
+		buffer.reserve(n);
+		for (std::size_t j = 0; j < n; j++) {
+			buffer.emplace_back(coordinates[2 * j], coordinates[2 * j + 1]);
+		}
+		isolines.emplace_back(buffer, closed[i] != 0);
+	}
+	return isolines;
+}
+
+void isolinesToBinary(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("Cannot create " + file.string());
+	}
+
+	std::vector<std::uint64_t> offsets = {0};
+	offsets.reserve(isolines.size() + 1);
+	std::vector<std::uint8_t> closed(closedFlagsSize(isolines.size()), 0);
+	for (std::size_t i = 0; i < isolines.size(); i++) {
+		offsets.push_back(offsets.back() + isolines[i].m_points.size());
+		closed[i] = isolines[i].m_closed ? 1 : 0;
+	}
+	BinaryHeader header{BINARY_MAGIC, BINARY_VERSION, 0, isolines.size(), offsets.back()};
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+	out.write(reinterpret_cast<const char*>(closed.data()), closed.size());
+
+	std::vector<double> coordinates;
+	for (const auto& isoline : isolines) {
+		coordinates.clear();
+		for (const auto& point : isoline.m_points) {
+			coordinates.push_back(point.x());
+			coordinates.push_back(point.y());
+		}
+		out.write(reinterpret_cast<const char*>(coordinates.data()), coordinates.size() * sizeof(double));
+	}
+	if (!out) {
+		throw std::runtime_error("Cannot write isolines to " + file.string());
+	}
+}
+
+std::vector<Isoline<K>> readIsolines(const std::filesystem::path& file) {
+	if (file.extension() == ".ipe") {
+		return ipeToIsolines(file);
+	} else if (file.extension() == ".isolines") {
+		return binaryToIsolines(file);
+	} else {
+		return gdalToIsolines(file);
+	}
+}
+}
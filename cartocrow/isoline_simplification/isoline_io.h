@@ -0,0 +1,62 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_ISOLINE_IO_H
+#define CARTOCROW_ISOLINE_IO_H
+
+#include "isoline.h"
+#include "types.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace cartocrow::isoline_simplification {
+/// Reads isolines from the line geometries of a vector file readable by GDAL, such as a GeoPackage or Shapefile.
+/// Line strings become open isolines, or closed ones if their first and last point coincide; the rings of polygons
+/// become closed isolines. Features are read one at a time, so only the isolines themselves are kept in memory.
+/// If no layer name is given, the first layer is read.
+std::vector<Isoline<K>> gdalToIsolines(const std::filesystem::path& file,
+                                       const std::optional<std::string>& layerName = std::nullopt);
+/// Writes isolines as line strings to a new vector file, using the given GDAL driver.
+void isolinesToGdal(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file,
+                    const std::string& driverName = "GPKG", const std::string& layerName = "isolines");
+
+/// Reads isolines from a file in the binary isoline format written by \ref isolinesToBinary.
+///
+/// The format consists of, in native (in practice little-endian) byte order:
+/// - the magic bytes `CCISOLNS`, followed by the version (1) and a reserved field as 32-bit unsigned integers;
+/// - the number of isolines \f$n\f$ and the total number of points as 64-bit unsigned integers;
+/// - \f$n + 1\f$ 64-bit unsigned point offsets, such that isoline \f$i\f$ consists of the points with indices in
+///   \f$[\mathrm{offset}_i, \mathrm{offset}_{i+1})\f$;
+/// - \f$n\f$ bytes that are 1 for closed isolines and 0 for open ones, padded with zeroes to a multiple of 8 bytes;
+/// - the coordinates of the points as pairs of doubles.
+///
+/// All sections are 8-byte aligned, so the file can also be memory-mapped and used in place. Throws
+/// \c std::runtime_error if the file is not in this format, or if its size does not match the counts in the header.
+std::vector<Isoline<K>> binaryToIsolines(const std::filesystem::path& file);
+/// Writes isolines in the binary isoline format (see \ref binaryToIsolines).
+void isolinesToBinary(const std::vector<Isoline<K>>& isolines, const std::filesystem::path& file);
+
+/// Reads isolines from an Ipe file (extension `.ipe`), a binary isoline file (extension `.isolines`), or otherwise
+/// any vector file readable by GDAL.
+std::vector<Isoline<K>> readIsolines(const std::filesystem::path& file);
+}
+
+#endif //CARTOCROW_ISOLINE_IO_H
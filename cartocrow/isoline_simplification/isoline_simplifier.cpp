@@ -21,6 +21,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "collapse.h"
 #include "symmetric_difference.h"
 #include "voronoi_helpers.h"
+#include "../core/parallel.h"
 #include <CGAL/Arr_conic_traits_2.h>
 #include <CGAL/CORE_algebraic_number_traits.h>
 #include <CGAL/Cartesian.h>
@@ -29,6 +30,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <CGAL/Constrained_triangulation_plus_2.h>
 #include <CGAL/Polyline_simplification_2/simplify.h>
 
+#include <stdexcept>
 #include <utility>
 #include <variant>
 #include "ipe_bezier_wrapper.h"
@@ -46,49 +48,56 @@ typedef CGAL::Constrained_triangulation_plus_2<CDT>     CT;
 
 IsolineSimplifier::IsolineSimplifier(std::vector<Isoline<K>> isolines, std::shared_ptr<LadderCollapse> collapse,
                                      double angle_filter, double alignment_filter):
-      m_isolines(std::move(isolines)), m_angle_filter(angle_filter), m_alignment_filter(alignment_filter), m_collapse_ladder(std::move(collapse)) {
+      IsolineSimplifier(std::move(isolines), 1, std::move(collapse), angle_filter, alignment_filter) {}
+
+IsolineSimplifier::IsolineSimplifier(std::vector<Isoline<K>> isolines, int thread_count,
+                                     std::shared_ptr<LadderCollapse> collapse, double angle_filter,
+                                     double alignment_filter):
+      m_isolines(std::move(isolines)), m_angle_filter(angle_filter), m_alignment_filter(alignment_filter),
+      m_thread_count(thread_count), m_collapse_ladder(std::move(collapse)) {
 	clean_isolines();
 	m_simplified_isolines = m_isolines;
-	initialize_sdg();
 	initialize_point_data();
+	initialize_sdg();
 	m_separator = medial_axis_separator(m_delaunay, m_p_isoline, m_p_prev, m_p_next);
-	m_matching = matching(m_delaunay, m_separator, m_p_prev, m_p_next, m_p_isoline, m_p_vertex, m_angle_filter, m_alignment_filter);
+	m_matching = matching(m_delaunay, m_separator, m_p_prev, m_p_next, m_p_isoline, m_p_vertex, m_angle_filter,
+	                      m_alignment_filter, m_thread_count);
 	initialize_slope_ladders();
 }
 
+std::shared_ptr<LadderCollapse> IsolineSimplifier::default_collapse() {
+	return std::make_shared<LineSplineHybridCollapse>(SplineCollapse(3, 15), HarmonyLineCollapse(15));
+}
+
 void IsolineSimplifier::initialize_point_data() {
-	m_current_complexity = 0;
-	for (auto& isoline : m_simplified_isolines) {
+	m_topology.clear();
+	m_history.clear();
+	for (int i = 0; i < m_simplified_isolines.size(); i++) {
+		auto& isoline = m_simplified_isolines[i];
+		VertexId first = NO_VERTEX;
+		VertexId previous = NO_VERTEX;
 		for (auto pit = isoline.m_points.begin(); pit != isoline.m_points.end(); pit++) {
-			++m_current_complexity;
-			Point<K> p = *pit;
-			if (m_p_isoline.contains(p)) {
-				std::cerr << "Point " << p << " belongs to multiple isolines" << std::endl;
-			}
-			m_p_isoline[p] = &isoline;
-			m_p_iterator[p] = pit;
-			if (pit != isoline.m_points.begin()) {
-				auto prev = pit;
-				prev--;
-				m_p_prev[p] = *prev;
-			} else if (isoline.m_closed) {
-				m_p_prev[p] = isoline.m_points.back();
-			}
-			if (pit != --isoline.m_points.end()) {
-				auto next = pit;
-				next++;
-				m_p_next[p] = *next;
-			} else if (isoline.m_closed) {
-				m_p_next[p] = isoline.m_points.front();
+			VertexId vertex = m_topology.add(*pit, &isoline, pit);
+			m_topology[vertex].history_node = m_history.add_vertex(*pit, i);
+			if (previous != NO_VERTEX) {
+				m_topology.link(previous, vertex);
+			} else {
+				first = vertex;
 			}
+			previous = vertex;
+		}
+		if (isoline.m_closed && first != NO_VERTEX) {
+			m_topology.link(previous, first);
 		}
 	}
+	m_current_complexity = m_topology.vertex_count();
+	m_history.start(m_current_complexity);
+	m_area_error = 0;
+	m_isoline_area_error.assign(m_simplified_isolines.size(), 0);
 }
 
 void IsolineSimplifier::initialize_sdg() {
 	m_delaunay.clear();
-	m_e_vertex.clear();
-	m_p_vertex.clear();
 	std::vector<Segment<K>> segments;
 	for (const auto& isoline : m_simplified_isolines) {
 		auto polyline = isoline.polyline();
@@ -99,9 +108,9 @@ void IsolineSimplifier::initialize_sdg() {
 	for (auto vit = m_delaunay.finite_vertices_begin(); vit != m_delaunay.finite_vertices_end(); vit++) {
 		auto site = vit->site();
 		if (site.is_point()) {
-			m_p_vertex[site.point()] = vit;
+			m_topology[m_topology.id(site.point())].delaunay_vertex = vit;
 		} else {
-			m_e_vertex[site.segment()] = vit;
+			m_topology[m_topology.id(site.segment().source())].next_edge_delaunay_vertex = vit;
 		}
 	}
 }
@@ -118,6 +127,37 @@ bool IsolineSimplifier::simplify(int target, bool debug) {
 	return true;
 }
 
+bool IsolineSimplifier::simplify_batched(int target, int batch_size, bool debug) {
+	while (m_current_complexity > target) {
+		if (debug) {
+			std::cout << "\r#Vertices: " << m_current_complexity << std::flush;
+		}
+		if (step_batched(batch_size, target) == 0) return false;
+		update_matching();
+		update_ladders();
+	}
+	return true;
+}
+
+bool IsolineSimplifier::simplify_to_error(double max_error, bool debug) {
+	m_started = true;
+	while (true) {
+		if (debug) {
+			std::cout << "\r#Vertices: " << m_current_complexity << " error: " << m_area_error << std::flush;
+		}
+		auto next = next_ladder();
+		if (!next.has_value()) return false;
+		if (m_area_error + collapse_area(**next) > max_error) {
+			// put the ladder back, so that simplification can continue with a larger budget
+			m_slope_ladders.push({*next, (*next)->m_cost, (*next)->m_version});
+			return true;
+		}
+		collapse(*next);
+		update_matching();
+		update_ladders();
+	}
+}
+
 bool IsolineSimplifier::dyken_simplify(int target, double sep_dist) {
 	m_started = true;
 	int start_complexity = m_current_complexity;
@@ -168,6 +208,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 			do {
 				if (ic->storage_site().is_defined()) {
 					m_changed_vertices.insert(ic);
+					unblock_ladders(ic);
 				} else {
 //					std::cout << "Encountered undefined storage site" << std::endl;
 				}
@@ -180,6 +221,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 	 	insert_adj(vertex);
 	  	m_changed_vertices.erase(vertex);
 	  	m_deleted_points.push_back(p);
+		unblock_ladders(vertex);
 
 	    if (!m_delaunay.remove(vertex)) {
 			throw std::runtime_error("Point removal failed\nThe point is likely incident to a segment that has not yet been deleted.");
@@ -201,6 +243,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 	    insert_adj(seg_vertex);
 
 	  	m_changed_vertices.erase(seg_vertex);
+		unblock_ladders(seg_vertex);
 	    if (!m_delaunay.remove(seg_vertex)) {
 			throw std::runtime_error("Delaunay segment vertex removal failed!");
 		}
@@ -209,80 +252,86 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 	auto delaunay_insert_p = [this, &insert_adj](const Point<K>& p, const SDG2::Vertex_handle near) {
 	  	auto handle = m_delaunay.insert(p, near);
 	    m_changed_vertices.insert(handle);
-	  	m_p_vertex[p] = handle;
 	  	insert_adj(handle);
 		return handle;
 	};
 
 	auto delaunay_insert_e = [this, &insert_adj](const Point<K>& p1, const Point<K>& p2, const SDG2::Vertex_handle near) {
 	  	auto handle = m_delaunay.insert(p1, p2, near);
-	  	m_e_vertex[Segment<K>(p1, p2)] = handle;
 		m_changed_vertices.insert(handle);
 	  	insert_adj(handle);
 		return handle;
 	};
 
+	// The vertices t and u of the edge tu of a rung, and their neighbors s and v, in isoline order.
+	struct RungVertices {
+		VertexId s, t, u, v;
+	};
+	std::vector<RungVertices> rung_vertices;
+	rung_vertices.reserve(ladder.m_rungs.size());
+	for (const auto& [a, b] : ladder.m_rung_vertices) {
+		bool reversed = m_topology[b].next == a;
+		VertexId t = reversed ? b : a;
+		VertexId u = reversed ? a : b;
+		assert(m_topology[t].next == u && m_topology[u].prev == t);
+		rung_vertices.push_back({m_topology[t].prev, t, u, m_topology[u].next});
+	}
+
 	// Remove from Delaunay
-	for (auto edge : ladder.m_rungs) {
-		bool reversed =
-		    m_p_next.contains(edge.target()) && m_p_next.at(edge.target()) == edge.source();
-		const Point<K>& t = reversed ? edge.target() : edge.source();
-		const Point<K>& u = reversed ? edge.source() : edge.target();
-		const Point<K>& s = m_p_prev.at(t);
-		const Point<K>& v = m_p_next.at(u);
-		const Segment<K> st = Segment<K>(s, t);
-		const Segment<K> uv = Segment<K>(u, v);
-
-		delaunay_remove_e(edge);
-		delaunay_remove_e(st);
-		delaunay_remove_p(t);
-		delaunay_remove_e(uv);
-		delaunay_remove_p(u);
+	for (int i = 0; i < ladder.m_rungs.size(); i++) {
+		const auto& [s, t, u, v] = rung_vertices[i];
+		delaunay_remove_e(ladder.m_rungs[i]);
+		delaunay_remove_e(Segment<K>(m_topology[s].point, m_topology[t].point));
+		delaunay_remove_p(m_topology[t].point);
+		delaunay_remove_e(Segment<K>(m_topology[u].point, m_topology[v].point));
+		delaunay_remove_p(m_topology[u].point);
 	}
 
 	// Insert into Delaunay
+	struct InsertedHandles {
+		SDG2::Vertex_handle s_new, new_v, new_point;
+	};
+	std::vector<InsertedHandles> inserted;
+	inserted.reserve(ladder.m_rungs.size());
 	for (int i = 0; i < ladder.m_rungs.size(); i++) {
-		auto edge = ladder.m_rungs.at(i);
-		auto new_point = ladder.m_collapsed.at(i);
-
-		bool reversed = m_p_next.contains(edge.target()) && m_p_next.at(edge.target()) == edge.source();
-		const Point<K>& t = reversed ? edge.target() : edge.source();
-		const Point<K>& u = reversed ? edge.source() : edge.target();
-		assert(m_p_next.at(t) == u && m_p_prev.at(u) == t);
-		const Point<K>& s = m_p_prev.at(t);
-		const Point<K>& v = m_p_next.at(u);
-
-		delaunay_insert_e(s, new_point, m_p_vertex.at(s));
-		auto seg_handle = delaunay_insert_e(new_point, v, m_p_vertex.at(v));
-		delaunay_insert_p(new_point, seg_handle);
+		const auto& [s, t, u, v] = rung_vertices[i];
+		const Point<K>& new_point = ladder.m_collapsed.at(i);
+		const Point<K>& s_point = m_topology[s].point;
+		const Point<K>& v_point = m_topology[v].point;
+
+		auto s_new = delaunay_insert_e(s_point, new_point, m_topology[s].delaunay_vertex);
+		auto new_v = delaunay_insert_e(new_point, v_point, m_topology[v].delaunay_vertex);
+		auto new_handle = delaunay_insert_p(new_point, new_v);
+		inserted.push_back({s_new, new_v, new_handle});
 	}
 
 	// Update the rest
 	for (int i = 0; i < ladder.m_rungs.size(); i++) {
 		--m_current_complexity;
 
-		auto edge = ladder.m_rungs.at(i);
-		auto new_point = ladder.m_collapsed.at(i);
-
-		bool reversed = m_p_next.contains(edge.target()) && m_p_next.at(edge.target()) == edge.source();
-		const Point<K> t = reversed ? edge.target() : edge.source();
-		const Point<K> u = reversed ? edge.source() : edge.target();
-		assert(m_p_next.at(t) == u && m_p_prev.at(u) == t);
-		const Point<K> s = m_p_prev.at(t);
-		const Point<K> v = m_p_next.at(u);
-		const Segment<K> st = Segment<K>(s, t);
-		const Segment<K> uv = Segment<K>(u, v);
-
-		auto t_it = m_p_iterator.at(t);
-		auto u_it = m_p_iterator.at(u);
-		Isoline<K>* t_iso = m_p_isoline.at(t);
-		Isoline<K>* u_iso = m_p_isoline.at(u);
-		assert(t_iso == u_iso);
+		const auto edge = ladder.m_rungs.at(i);
+		const auto new_point = ladder.m_collapsed.at(i);
+		const auto [s, t, u, v] = rung_vertices[i];
+		// copies, as adding a vertex to the topology below invalidates references
+		const Point<K> t_point = m_topology[t].point;
+		const Point<K> u_point = m_topology[u].point;
+		const Segment<K> st = Segment<K>(m_topology[s].point, t_point);
+		const Segment<K> uv = Segment<K>(u_point, m_topology[v].point);
+
+		auto t_it = m_topology[t].iterator;
+		auto u_it = m_topology[u].iterator;
+		Isoline<K>* t_iso = m_topology[t].isoline;
+		assert(t_iso == m_topology[u].isoline);
+
+		const double area =
+		    symmetric_difference(m_topology[s].point, t_point, u_point, m_topology[v].point, new_point);
+		m_area_error += area;
+		m_isoline_area_error[t_iso - m_simplified_isolines.data()] += area;
 
 		// Remove points from isolines
 		auto new_it = t_iso->m_points.insert(u_it, new_point);
 		t_iso->m_points.erase(t_it);
-		u_iso->m_points.erase(u_it);
+		t_iso->m_points.erase(u_it);
 
 		auto remove_ladder_p = [this](Point<K> point) {
 			if (m_p_ladder.contains(point)) {
@@ -301,34 +350,23 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 		remove_ladder_e(edge);
 		remove_ladder_e(edge.opposite());
 
-		remove_ladder_p(t);
-		remove_ladder_p(u);
-
-		// Update m_p_iterator
-		m_p_iterator.erase(t);
-		m_p_iterator.erase(u);
-		m_p_iterator[new_point] = new_it;
-
-		// Update m_p_isoline
-		m_p_isoline.erase(t);
-		m_p_isoline.erase(u);
-		m_p_isoline[new_point] = t_iso;
-
-		// Update prev and next
-		m_p_prev.erase(t);
-		m_p_next.erase(t);
-		m_p_prev.erase(u);
-		m_p_next.erase(u);
-		m_p_prev[v] = new_point;
-		m_p_next[s] = new_point;
-		if (m_p_prev.contains(new_point)) {
-			std::cerr << "Collapsed to existing point!" << std::endl;
-		}
-		m_p_prev[new_point] = s;
-		if (m_p_next.contains(new_point)) {
-			std::cerr << "Collapsed to existing point!" << std::endl;
-		}
-		m_p_next[new_point] = v;
+		remove_ladder_p(t_point);
+		remove_ladder_p(u_point);
+
+		// Replace t and u by the new vertex
+		const HistoryNodeId t_history = m_topology[t].history_node;
+		const HistoryNodeId u_history = m_topology[u].history_node;
+		m_topology.remove(t);
+		m_topology.remove(u);
+		// next_ladder() does not return ladders that collapse onto another vertex
+		assert(!m_topology.contains(new_point));
+		VertexId new_vertex = m_topology.add(new_point, t_iso, new_it);
+		m_topology[new_vertex].history_node = m_history.collapse(t_history, u_history, new_point);
+		m_topology.link(s, new_vertex);
+		m_topology.link(new_vertex, v);
+		m_topology[s].next_edge_delaunay_vertex = inserted[i].s_new;
+		m_topology[new_vertex].next_edge_delaunay_vertex = inserted[i].new_v;
+		m_topology[new_vertex].delaunay_vertex = inserted[i].new_point;
 
 		// Update intersects
 		const auto update_intersects_e = [this](Segment<K> seg) {
@@ -337,7 +375,7 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 					if (!l->m_old) {
 						l->m_intersects = false;
 						l->compute_cost(m_p_prev, m_p_next);
-						m_slope_ladders.increase(m_ladder_heap_handle.at(l));
+						push_ladder(l);
 					}
 				}
 			}
@@ -350,6 +388,24 @@ void IsolineSimplifier::collapse_ladder(SlopeLadder& ladder) {
 		update_intersects_e(edge);
 		update_intersects_e(edge.opposite());
 	}
+
+	m_history.finish_step(m_current_complexity);
+}
+
+std::vector<Isoline<K>> IsolineSimplifier::simplification_at(int target) const {
+	const int step = m_history.step_for(target);
+	std::vector<Isoline<K>> result;
+	for (const auto& isoline : m_simplified_isolines) {
+		std::vector<Point<K>> points;
+		// look up the first vertex only, and follow the links from there
+		VertexId vertex = isoline.m_points.empty() ? NO_VERTEX : m_topology.id(isoline.m_points.front());
+		for (int i = 0; i < isoline.m_points.size(); i++) {
+			m_history.expand(m_topology[vertex].history_node, step, points);
+			vertex = m_topology[vertex].next;
+		}
+		result.emplace_back(std::move(points), isoline.m_closed);
+	}
+	return result;
 }
 
 void IsolineSimplifier::update_matching() {
@@ -565,156 +621,201 @@ void IsolineSimplifier::update_ladders() {
 		remove_subset_ladders(seg);
 		remove_subset_ladders(seg.opposite());
 	}
+
+	// the collapses have made ladders old, some of which may be blocked
+	prune_blocked_ladders();
 }
 
 // same as next_ladder() but does not pop the next ladder from the heap.
 std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::get_next_ladder() {
-	if (m_slope_ladders.empty())
-		return std::nullopt;
-
-	// Note that m_slope_ladders is a heap
-	auto current = m_slope_ladders.top();
-
-	// Non-valid slope ladders have very high cost so this means no valid slope ladders are left
-	if (!current->m_valid)
-		return std::nullopt;
-
-	std::vector<std::shared_ptr<SlopeLadder>> temp;
-	std::optional<std::shared_ptr<SlopeLadder>> result;
-
-	bool found = false;
+	auto next = next_ladder();
+	if (next.has_value()) {
+		// it was popped with its current version, so this entry is not stale
+		m_slope_ladders.push({*next, (*next)->m_cost, (*next)->m_version});
+	}
+	return next;
+}
 
-	do {
-		if (current->m_old) {
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
-		} else if (current->m_intersects) {
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
-		} else if (IntersectionResult ir = check_ladder_intersections_Voronoi(*current)) {
-			auto irv = *ir;
-			// self-intersects
-			if (holds_alternative<std::monostate>(irv)) {
-			} else { // intersects another segment
-				Segment<K> intersected = std::get<Segment<K>>(irv);
-				m_e_intersects[intersected].push_back(current);
-			}
-			current->m_intersects = true;
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
+std::vector<std::shared_ptr<SlopeLadder>> IsolineSimplifier::pending_ladders() const {
+	std::vector<std::shared_ptr<SlopeLadder>> result;
+	std::unordered_set<const SlopeLadder*> seen;
+	const auto add = [&](const std::shared_ptr<SlopeLadder>& ladder) {
+		if (ladder->m_valid && is_pending(*ladder) && seen.insert(ladder.get()).second) {
+			result.push_back(ladder);
 		}
-		else if (check_ladder_collapse_topology(*current)) {
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
-		}
-		else {
-			found = true;
-			break;
-		}
-		current = m_slope_ladders.top();
-		if (!current->m_valid) {
-			break;
+	};
+	for (const auto& entry : m_slope_ladders) {
+		if (!entry.stale()) {
+			add(entry.ladder);
 		}
-	} while (!m_slope_ladders.empty());
-
-	if (!found) {
-		result = std::nullopt;
-	} else {
-		result = current;
 	}
-
-	for (const auto& ladder : temp) {
-		m_ladder_heap_handle[ladder] = m_slope_ladders.push(ladder);
+	for (const auto& [_, ladders] : m_blocked_ladders) {
+		for (const auto& ladder : ladders) {
+			if (ladder->m_blocked) {
+				add(ladder);
+			}
+		}
 	}
-
 	return result;
 }
 
-std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_ladder() {
-	if (m_slope_ladders.empty())
-		return std::nullopt;
+void IsolineSimplifier::revalidate_blocked_ladders() {
+	while (!m_blocked_ladders.empty()) {
+		unblock_ladders(m_blocked_ladders.begin()->first);
+	}
+}
 
-	// Note that m_slope_ladders is a heap
-	auto current = m_slope_ladders.top();
+bool IsolineSimplifier::is_pending(const SlopeLadder& ladder) const {
+	return !ladder.m_old && !ladder.m_intersects && !is_frozen(ladder);
+}
 
-	// Non-valid slope ladders have very high cost so this means no valid slope ladders are left
-	if (!current->m_valid)
-		return std::nullopt;
+bool IsolineSimplifier::is_frozen(const SlopeLadder& ladder) const {
+	if (!m_frozen) return false;
+	return std::any_of(ladder.m_rungs.begin(), ladder.m_rungs.end(), [this](const Segment<K>& rung) {
+		return m_frozen(rung.source()) || m_frozen(rung.target());
+	});
+}
 
-	std::vector<std::shared_ptr<SlopeLadder>> temp;
-	std::optional<std::shared_ptr<SlopeLadder>> result;
+std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_ladder() {
+	while (auto candidate = next_candidate()) {
+		if (accept_candidate(*candidate, check_candidate(**candidate))) {
+			return candidate;
+		}
+	}
+	return std::nullopt;
+}
 
-	bool found = false;
+std::optional<std::shared_ptr<SlopeLadder>> IsolineSimplifier::next_candidate() {
+	// Ladders that cannot be collapsed at the moment are not put back on the heap. Intersecting ladders return when
+	// the edge they intersect changes (see collapse_ladder), blocked ladders when their neighbourhood changes (see
+	// unblock_ladders), and ladders that are old, frozen or self-intersecting never become collapsible again.
+	while (!m_slope_ladders.empty()) {
+		const LadderHeapEntry entry = m_slope_ladders.top();
+		const auto& current = entry.ladder;
+		if (entry.stale()) {
+			m_slope_ladders.pop();
+			continue;
+		}
+		// Non-valid slope ladders have very high cost so this means no valid slope ladders are left
+		if (!current->m_valid) {
+			return std::nullopt;
+		}
+		m_slope_ladders.pop();
 
-	do {
 		bool old_but_not_correctly_updated = false;
 
-		for (const auto& rung : current->m_rungs) {
-			old_but_not_correctly_updated |= !m_p_iterator.contains(rung.source());
-			old_but_not_correctly_updated |= !m_p_iterator.contains(rung.target());
+		for (const auto& [a, b] : current->m_rung_vertices) {
+			old_but_not_correctly_updated |= a == NO_VERTEX || m_topology[a].removed;
+			old_but_not_correctly_updated |= b == NO_VERTEX || m_topology[b].removed;
 		}
 
-		if (current->m_old) {
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
+		if (!is_pending(*current)) {
+			continue;
 		} else if (old_but_not_correctly_updated) {
 			std::cerr << "Incorrectly updated" << std::endl;
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
-		}
-		else if (current->m_intersects) {
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
-		}
-		else if (IntersectionResult ir = check_ladder_intersections_Voronoi(*current)) {
-			auto irv = *ir;
-			// self-intersects
-			if (holds_alternative<std::monostate>(irv)) {
-			} else { // intersects another segment
-				Segment<K> intersected = std::get<Segment<K>>(irv);
-				m_e_intersects[intersected].push_back(current);
-			}
-			current->m_intersects = true;
-			current->m_cost = std::numeric_limits<double>::infinity();
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
+		} else if (collapses_onto_other_vertex(*current)) {
+			// the other vertex may still move away, which changes the neighbourhood
+			block_ladder(current);
+		} else {
+			return current;
 		}
-		else if (check_ladder_collapse_topology(*current)) {
-			temp.push_back(current);
-			m_ladder_heap_handle.erase(current);
-			m_slope_ladders.pop();
+	}
+
+	return std::nullopt;
+}
+
+IsolineSimplifier::CandidateCheck IsolineSimplifier::check_candidate(const SlopeLadder& ladder) {
+	CandidateCheck check;
+	check.intersection = check_ladder_intersections_Voronoi(ladder);
+	if (!check.intersection) {
+		check.topology_violation = check_ladder_collapse_topology(ladder);
+	}
+	return check;
+}
+
+bool IsolineSimplifier::accept_candidate(const std::shared_ptr<SlopeLadder>& ladder, const CandidateCheck& check) {
+	if (check.intersection) {
+		auto irv = *check.intersection;
+		// self-intersects
+		if (holds_alternative<std::monostate>(irv)) {
+		} else { // intersects another segment
+			Segment<K> intersected = std::get<Segment<K>>(irv);
+			m_e_intersects[intersected].push_back(ladder);
 		}
-		else {
-			found = true;
-			break;
+		ladder->m_intersects = true;
+		ladder->m_cost = std::numeric_limits<double>::infinity();
+		return false;
+	}
+	if (check.topology_violation) {
+		block_ladder(ladder);
+		return false;
+	}
+	return true;
+}
+
+bool IsolineSimplifier::collapses_onto_other_vertex(const SlopeLadder& ladder) const {
+	// the rung vertices themselves are removed before the new vertices are added, so they do not count
+	std::unordered_set<Point<K>> new_points;
+	for (int i = 0; i < ladder.m_collapsed.size(); i++) {
+		const Point<K>& p = ladder.m_collapsed[i];
+		const auto vertex = m_topology.find(p);
+		const auto& [a, b] = ladder.m_rung_vertices[i];
+		if (vertex && *vertex != a && *vertex != b) {
+			return true;
 		}
-		current = m_slope_ladders.top();
-		if (!current->m_valid) {
-			break;
+		if (!new_points.insert(p).second) {
+			return true;
 		}
-	} while (!m_slope_ladders.empty());
-
-	if (!found) {
-		result = std::nullopt;
-	} else {
-		result = current;
 	}
+	return false;
+}
 
-	if (result.has_value()) {
-		m_ladder_heap_handle.erase(current);
-		m_slope_ladders.pop();
+void IsolineSimplifier::push_ladder(const std::shared_ptr<SlopeLadder>& ladder) {
+	// any entries already on the heap for this ladder become stale
+	++ladder->m_version;
+	m_slope_ladders.push({ladder, ladder->m_cost, ladder->m_version});
+}
+
+void IsolineSimplifier::block_ladder(const std::shared_ptr<SlopeLadder>& ladder) {
+	ladder->m_blocked = true;
+	for (const auto& vh : ladder_neighbourhood(*ladder)) {
+		m_blocked_ladders[vh].push_back(ladder);
+		++m_blocked_registrations;
 	}
+}
 
-	for (const auto& ladder : temp) {
-		m_ladder_heap_handle[ladder] = m_slope_ladders.push(ladder);
+void IsolineSimplifier::unblock_ladders(SDG2::Vertex_handle vertex) {
+	auto it = m_blocked_ladders.find(vertex);
+	if (it == m_blocked_ladders.end()) return;
+	for (const auto& ladder : it->second) {
+		// a ladder is registered at several vertices, so it may have been unblocked already
+		if (ladder->m_blocked && !ladder->m_old) {
+			ladder->m_blocked = false;
+			push_ladder(ladder);
+		}
 	}
+	m_blocked_registrations -= it->second.size();
+	m_blocked_ladders.erase(it);
+}
 
-	return result;
+void IsolineSimplifier::prune_blocked_ladders() {
+	// Ladders that have become old, or that were unblocked through another vertex, stay registered at the vertices of
+	// their neighbourhood until those change, which for vertices far from later collapses may be never. Removing them
+	// whenever the number of registrations has doubled keeps the map proportional to the number of blocked ladders,
+	// at amortized constant cost per registration.
+	if (m_blocked_registrations <= 2 * m_blocked_registrations_after_pruning + 64) return;
+	for (auto it = m_blocked_ladders.begin(); it != m_blocked_ladders.end();) {
+		auto& ladders = it->second;
+		m_blocked_registrations -= std::erase_if(ladders, [](const std::shared_ptr<SlopeLadder>& ladder) {
+			return ladder->m_old || !ladder->m_blocked;
+		});
+		if (ladders.empty()) {
+			it = m_blocked_ladders.erase(it);
+		} else {
+			++it;
+		}
+	}
+	m_blocked_registrations_after_pruning = m_blocked_registrations;
 }
 
 bool IsolineSimplifier::step() {
@@ -722,23 +823,131 @@ bool IsolineSimplifier::step() {
 
 	auto next = next_ladder();
 	if (!next.has_value()) return false;
-	auto slope_ladder = *next;
+	collapse(*next);
+
+	return true;
+}
 
+void IsolineSimplifier::collapse(const std::shared_ptr<SlopeLadder>& slope_ladder) {
 	m_changed_vertices.clear();
 	m_deleted_points.clear();
 	collapse_ladder(*slope_ladder);
 
 	slope_ladder->m_old = true;
+}
 
-	return true;
+double IsolineSimplifier::collapse_area(const SlopeLadder& ladder) const {
+	double area = 0;
+	for (int i = 0; i < ladder.m_rung_vertices.size(); i++) {
+		auto [t, u] = ladder.m_rung_vertices[i];
+		if (m_topology[u].next == t) {
+			std::swap(t, u);
+		}
+		area += symmetric_difference(m_topology[m_topology[t].prev].point, m_topology[t].point, m_topology[u].point,
+		                             m_topology[m_topology[u].next].point, ladder.m_collapsed[i]);
+	}
+	return area;
+}
+
+int IsolineSimplifier::step_batched(int batch_size, int target) {
+	if (batch_size <= 0) {
+		throw std::invalid_argument("The batch size must be positive");
+	}
+	m_started = true;
+	m_changed_vertices.clear();
+	m_deleted_points.clear();
+
+	// Select ladders in order of cost, skipping those whose neighbourhood overlaps with that of an already selected
+	// ladder. Every selected ladder has been checked against the current isolines; as the neighbourhoods of the
+	// selected ladders are disjoint, collapsing one of them does not invalidate these checks for the others.
+	std::vector<std::shared_ptr<SlopeLadder>> batch;
+	std::vector<std::shared_ptr<SlopeLadder>> skipped;
+	std::unordered_set<SDG2::Vertex_handle> claimed;
+	int complexity = m_current_complexity;
+	while (batch.size() < batch_size && skipped.size() < batch_size && complexity > target) {
+		// Take as many candidates as still fit in the batch, and run the expensive checks (which only read the
+		// segment Delaunay graph and the topology) on them concurrently. Their results are then applied in order of
+		// cost, exactly as next_ladder() would, so a batch size of 1 gives the same result as step().
+		std::vector<std::shared_ptr<SlopeLadder>> candidates;
+		while (candidates.size() < batch_size - batch.size()) {
+			auto next = next_candidate();
+			if (!next.has_value()) break;
+			candidates.push_back(*next);
+		}
+		if (candidates.empty()) break;
+
+		std::vector<CandidateCheck> checks(candidates.size());
+		std::vector<std::unordered_set<SDG2::Vertex_handle>> neighbourhoods(candidates.size());
+		parallel_for(static_cast<int>(candidates.size()), m_thread_count, [&](int i) {
+			checks[i] = check_candidate(*candidates[i]);
+			if (!checks[i].intersection && !checks[i].topology_violation) {
+				neighbourhoods[i] = ladder_neighbourhood(*candidates[i]);
+			}
+		});
+
+		for (int i = 0; i < candidates.size(); i++) {
+			if (!accept_candidate(candidates[i], checks[i])) continue;
+			const auto& neighbourhood = neighbourhoods[i];
+			if (complexity <= target || std::any_of(neighbourhood.begin(), neighbourhood.end(),
+			                                        [&claimed](const auto& vh) { return claimed.contains(vh); })) {
+				skipped.push_back(candidates[i]);
+				continue;
+			}
+			claimed.insert(neighbourhood.begin(), neighbourhood.end());
+			complexity -= static_cast<int>(candidates[i]->m_rungs.size());
+			batch.push_back(candidates[i]);
+		}
+	}
+
+	for (const auto& ladder : skipped) {
+		push_ladder(ladder);
+	}
+
+	// Collapsing modifies the segment Delaunay graph, so this is done sequentially.
+	for (const auto& ladder : batch) {
+		collapse_ladder(*ladder);
+		ladder->m_old = true;
+	}
+
+	return static_cast<int>(batch.size());
+}
+
+std::unordered_set<SDG2::Vertex_handle> IsolineSimplifier::ladder_neighbourhood(const SlopeLadder& ladder) {
+	// The Voronoi cells crossed by the new edges, plus the cells adjacent to those, as removing and inserting sites
+	// changes the cells of their neighbours.
+	std::unordered_set<SDG2::Vertex_handle> region;
+	for (int i = 0; i < ladder.m_rungs.size(); i++) {
+		auto rung_region = intersected_region(ladder.m_rungs[i], ladder.m_collapsed[i]);
+		region.insert(rung_region.begin(), rung_region.end());
+	}
+
+	std::unordered_set<SDG2::Vertex_handle> neighbourhood = region;
+	for (const auto& vh : region) {
+		auto ic_start = m_delaunay.incident_vertices(vh);
+		auto ic = ic_start;
+		if (ic != nullptr) {
+			do {
+				neighbourhood.insert(ic);
+			} while (++ic != ic_start);
+		}
+	}
+	return neighbourhood;
 }
 
 void IsolineSimplifier::create_slope_ladder(Segment<K> seg) {
+	auto slope_ladder = find_slope_ladder(seg);
+	if (!slope_ladder) return;
+	(*m_collapse_ladder)(*slope_ladder, m_p_prev, m_p_next);
+	slope_ladder->compute_cost(m_p_prev, m_p_next);
+	push_ladder(slope_ladder);
+}
+
+std::shared_ptr<SlopeLadder> IsolineSimplifier::find_slope_ladder(Segment<K> seg) {
 	if (m_e_ladder.contains(seg) &&
 	        std::any_of(m_e_ladder.at(seg).begin(), m_e_ladder.at(seg).end(), [](const auto& l) { return !l->m_old; }) ||
 	    m_e_ladder.contains(seg.opposite()) &&
 			std::any_of(m_e_ladder.at(seg.opposite()).begin(), m_e_ladder.at(seg.opposite()).end(), [](const auto& l) { return !l->m_old; }))
-	    return;
+	    return nullptr;
 
 	bool reversed = m_p_next.contains(seg.target()) && m_p_next.at(seg.target()) == seg.source();
 	Point<K> s = reversed ? seg.target() : seg.source();
@@ -882,7 +1091,11 @@ void IsolineSimplifier::create_slope_ladder(Segment<K> seg) {
 	search(s, t, CGAL::LEFT_TURN, CGAL::LEFT_TURN, slope_ladder, search);
 	search(s, t, CGAL::RIGHT_TURN, CGAL::RIGHT_TURN, slope_ladder, search);
 
+	slope_ladder->m_rung_vertices.reserve(slope_ladder->m_rungs.size());
 	for (const auto& rung : slope_ladder->m_rungs) {
+		const auto a_vertex = m_topology.find(rung.source());
+		const auto b_vertex = m_topology.find(rung.target());
+		slope_ladder->m_rung_vertices.emplace_back(a_vertex.value_or(NO_VERTEX), b_vertex.value_or(NO_VERTEX));
 		const auto& a = rung.source();
 		const auto& b = rung.target();
 		if (!m_p_prev.contains(a) || !m_p_next.contains(b) || !m_p_prev.contains(b) || !m_p_next.contains(a) || m_p_prev.at(a) == m_p_next.at(b) || m_p_next.at(a) == m_p_prev.at(b)) {
@@ -890,19 +1103,31 @@ void IsolineSimplifier::create_slope_ladder(Segment<K> seg) {
 		}
 	}
 
-	(*m_collapse_ladder)(*slope_ladder, m_p_prev, m_p_next);
-	slope_ladder->compute_cost(m_p_prev, m_p_next);
-
-	m_ladder_heap_handle[slope_ladder] = m_slope_ladders.push(slope_ladder);
+	return slope_ladder;
 }
 
 void IsolineSimplifier::initialize_slope_ladders() {
+	// Finding the rungs updates m_e_ladder, so it is done sequentially. Collapsing the ladders and computing their
+	// costs, which dominates, only reads the isolines and is done in parallel. The ladders are pushed in the order in
+	// which they were found, so the heap does not depend on the number of threads.
+	std::vector<std::shared_ptr<SlopeLadder>> ladders;
 	for (const auto& isoline : m_simplified_isolines) {
 		auto polyline = isoline.polyline();
 		for (auto eit = polyline.edges_begin(); eit != polyline.edges_end(); ++eit) {
-			create_slope_ladder(*eit);
+			if (auto slope_ladder = find_slope_ladder(*eit)) {
+				ladders.push_back(slope_ladder);
+			}
 		}
 	}
+
+	parallel_for(static_cast<int>(ladders.size()), m_thread_count, [this, &ladders](int i) {
+		(*m_collapse_ladder)(*ladders[i], m_p_prev, m_p_next);
+		ladders[i]->compute_cost(m_p_prev, m_p_next);
+	});
+
+	for (const auto& slope_ladder : ladders) {
+		push_ladder(slope_ladder);
+	}
 }
 
 void IsolineSimplifier::clean_isolines() {
@@ -931,6 +1156,28 @@ void IsolineSimplifier::clean_isolines() {
 			isoline.m_points.pop_back();
 		}
 	}
+
+	// The topology needs a distinct vertex for every point, so drop later occurrences of a point that touch an
+	// earlier isoline (or an earlier part of the same isoline).
+	std::unordered_set<Point<K>> seen;
+	int duplicates = 0;
+	for (auto& isoline : m_isolines) {
+		for (auto pit = isoline.m_points.begin(); pit != isoline.m_points.end();) {
+			if (seen.insert(*pit).second) {
+				++pit;
+			} else {
+				pit = isoline.m_points.erase(pit);
+				++duplicates;
+			}
+		}
+		if (isoline.m_closed && isoline.m_points.size() < 3) {
+			isoline.m_closed = false;
+		}
+	}
+	if (duplicates > 0) {
+		std::cerr << "Removed " << duplicates << " vertices that coincide with an earlier isoline vertex" << std::endl;
+		erase_if(m_isolines, [](const auto& iso) { return iso.m_points.empty(); });
+	}
 }
 
 bool IsolineSimplifier::check_ladder_intersections_naive(const SlopeLadder& ladder) const {
@@ -1430,28 +1677,26 @@ std::pair<double, double> IsolineSimplifier::average_max_vertex_alignment() cons
 
 void IsolineSimplifier::clear() {
 	m_delaunay.clear();
-	m_p_isoline.clear();
-	m_p_prev.clear();
-	m_p_next.clear();
-	m_p_iterator.clear();
+	m_topology.clear();
 	m_p_ladder.clear();
 	m_e_ladder.clear();
-	m_p_vertex.clear();
-	m_e_vertex.clear();
 	m_e_intersects.clear();
 	m_delaunay.clear();
 	m_separator.clear();
 	m_matching.clear();
 	m_slope_ladders.clear();
+	m_blocked_ladders.clear();
+	m_blocked_registrations = 0;
+	m_blocked_registrations_after_pruning = 0;
 }
 
 int IsolineSimplifier::ladder_count() {
 	clear();
-	initialize_sdg();
 	initialize_point_data();
+	initialize_sdg();
 	m_separator = medial_axis_separator(m_delaunay, m_p_isoline, m_p_prev, m_p_next);
 	m_matching = matching(m_delaunay, m_separator, m_p_prev, m_p_next, m_p_isoline, m_p_vertex,
-	                     m_angle_filter, m_alignment_filter);
+	                     m_angle_filter, m_alignment_filter, m_thread_count);
 	initialize_slope_ladders();
 	return m_slope_ladders.size();
 }
@@ -20,22 +20,36 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef CARTOCROW_ISOLINE_SIMPLIFICATION_H
 #define CARTOCROW_ISOLINE_SIMPLIFICATION_H
 #include "collapse.h"
+#include "collapse_history.h"
 #include "isoline.h"
+#include "isoline_topology.h"
 #include "types.h"
 #include "voronoi_helpers.h"
 #include <boost/heap/d_ary_heap.hpp>
+#include <functional>
 
 namespace cartocrow::isoline_simplification {
+/// An entry of the slope ladder heap. Entries are never updated in place: when the cost of a ladder changes, a new
+/// entry is pushed, and entries whose version is older than that of their ladder are discarded when they are popped.
+struct LadderHeapEntry {
+	std::shared_ptr<SlopeLadder> ladder;
+	double cost;
+	int version;
+	bool stale() const {
+		return version != ladder->m_version;
+	}
+};
+
 struct slope_ladder_comp {
-	inline bool operator()(const std::shared_ptr<SlopeLadder>& sl1, const std::shared_ptr<SlopeLadder>& sl2) const {
-		return sl1->m_cost > sl2->m_cost;
+	inline bool operator()(const LadderHeapEntry& e1, const LadderHeapEntry& e2) const {
+		return e1.cost > e2.cost;
 	}
 };
 
 typedef std::optional<std::variant<Segment<K>, std::monostate>> IntersectionResult;
 
-typedef boost::heap::d_ary_heap<std::shared_ptr<SlopeLadder>, boost::heap::arity<2>, boost::heap::compare<slope_ladder_comp>, boost::heap::mutable_<true>> Heap;
-typedef std::unordered_map<std::shared_ptr<SlopeLadder>, Heap::handle_type> LadderToHandle;
+typedef boost::heap::d_ary_heap<LadderHeapEntry, boost::heap::arity<2>, boost::heap::compare<slope_ladder_comp>> Heap;
+typedef std::unordered_map<SDG2::Vertex_handle, std::vector<std::shared_ptr<SlopeLadder>>> VertexToSlopeLadders;
 
 /// An algorithm that simplifies isolines simultaneously such that common features are maintained.
 ///
@@ -91,18 +105,53 @@ class IsolineSimplifier {
 	/// The parameters can be set to negative values. Then all slope ladders consists of only one edge and the
 	/// simplifier will perform only single edge collapses.
 	IsolineSimplifier(std::vector<Isoline<K>> isolines = std::vector<Isoline<K>>(),
-	                  std::shared_ptr<LadderCollapse> collapse = std::make_shared<LineSplineHybridCollapse>(SplineCollapse(3, 15), HarmonyLineCollapse(15)),
+	                  std::shared_ptr<LadderCollapse> collapse = default_collapse(),
+	                  double angle_filter = 100.0, double alignment_filter = 100.0);
+	/// Like \ref IsolineSimplifier(), but computes the matching and the initial slope ladders, as well as the checks
+	/// of \ref simplify_batched, on \p thread_count threads (0 uses one per hardware core). The collapse method must
+	/// then be safe to call concurrently. The result does not depend on the number of threads.
+	IsolineSimplifier(std::vector<Isoline<K>> isolines, int thread_count,
+	                  std::shared_ptr<LadderCollapse> collapse = default_collapse(),
 	                  double angle_filter = 100.0, double alignment_filter = 100.0);
+	/// The collapse method used if none is given: a hybrid of spline and line collapses.
+	static std::shared_ptr<LadderCollapse> default_collapse();
+	// The point maps below are views on m_topology, and the topology points into m_simplified_isolines.
+	IsolineSimplifier(const IsolineSimplifier&) = delete;
+	IsolineSimplifier& operator=(const IsolineSimplifier&) = delete;
 	/// Collapses slope ladders until the number of vertices is at or below the specified target or no slope ladder
 	/// exists that preserves topology.
 	bool simplify(int target, bool debug = false);
+	/// Like \ref simplify, but collapses slope ladders in batches. Each batch consists of up to \p batch_size of the
+	/// cheapest collapsible slope ladders whose neighbourhoods in the segment Voronoi diagram are disjoint, so that
+	/// collapsing one does not affect the validity of the others. The topology checks of the ladders in a batch run
+	/// concurrently on the threads given to the constructor, and the matching and slope ladders are updated once per
+	/// batch instead of once per collapse. Larger batches are faster, but ladders are not necessarily collapsed in
+	/// order of increasing cost, which may reduce quality; a batch size of 1 behaves like \ref simplify. Throws
+	/// \c std::invalid_argument if \p batch_size is not positive.
+	bool simplify_batched(int target, int batch_size, bool debug = false);
+	/// Collapses slope ladders as long as \ref m_area_error stays within \p max_error and a slope ladder exists that
+	/// preserves topology. Returns true if simplification stopped because the next collapse would exceed the budget.
+	bool simplify_to_error(double max_error, bool debug = false);
 	/// A convenience function that simplifies isolines using the CGAL implementation of the method of Dyken et al.
 	/// This does perform the redundant preprocessing step of computing slope ladders so it is not the most efficient.
 	bool dyken_simplify(int target, double sep_dist = 1);
 	// Perform one simplification step; returns whether there was progress.
 	bool step();
+	// Perform one batched simplification step without going below the target; returns the number of collapsed ladders.
+	int step_batched(int batch_size, int target);
+	/// Reconstructs the simplification at the first step at which at most \p target vertices remained, from \ref
+	/// m_history. This takes time linear in the size of the output, so after simplifying once to the coarsest level
+	/// needed, all finer levels can be extracted without simplifying again.
+	std::vector<Isoline<K>> simplification_at(int target) const;
 	/// Gets the next ladder that will be simplified (only for debugging purposes).
 	std::optional<std::shared_ptr<SlopeLadder>> get_next_ladder();
+	/// Returns each slope ladder that may still be collapsed once: the valid ladders on the heap that pass the same
+	/// inexpensive checks as \ref get_next_ladder, and the blocked ladders (only for debugging purposes).
+	std::vector<std::shared_ptr<SlopeLadder>> pending_ladders() const;
+	/// Puts all blocked ladders back on the heap, so that they are checked again before they are collapsed. This is
+	/// never needed, as blocked ladders return to the heap when their neighbourhood changes; it only serves to verify
+	/// that.
+	void revalidate_blocked_ladders();
 
 	void update_ladders();
 	void update_matching();
@@ -111,22 +160,26 @@ class IsolineSimplifier {
 	std::vector<Isoline<K>> m_isolines;
 	/// The simplified isolines.
 	std::vector<Isoline<K>> m_simplified_isolines;
+	/// The vertices of the simplified isolines and their connectivity.
+	IsolineTopology m_topology;
+	/// The collapses performed since initialization. Collapses by \ref dyken_simplify are not recorded.
+	CollapseHistory m_history;
 	/// Maps point to the isoline it is part of.
-	PointToIsoline m_p_isoline;
+	PointToIsoline m_p_isoline{m_topology, &TopologyVertex::isoline};
 	/// Maps point to the previous point on the isoline.
-	PointToPoint m_p_prev;
+	PointToPoint m_p_prev{m_topology, &TopologyVertex::prev};
 	/// Maps point to the next point on the isoline.
-	PointToPoint m_p_next;
+	PointToPoint m_p_next{m_topology, &TopologyVertex::next};
 	/// Maps point to the iterator of the isoline it is a part of for efficient removal.
-	PointToIterator m_p_iterator;
+	PointToIterator m_p_iterator{m_topology, &TopologyVertex::iterator};
 	/// Maps point to the ladders it is a cap of.
 	PointToSlopeLadders m_p_ladder;
 	/// Maps an edge to the slope ladders it is a part of.
 	EdgeToSlopeLadders m_e_ladder;
 	/// Maps a point to the corresponding Delaunay vertex.
-	PointToVertex m_p_vertex;
+	PointToVertex m_p_vertex{m_topology, &TopologyVertex::delaunay_vertex};
 	/// Maps an edge to the corresponding segment Delaunay vertex.
-	EdgeToVertex m_e_vertex;
+	EdgeToVertex m_e_vertex{m_topology};
 	/// Maps an edge to slope ladders it has been detected to intersect.
 	EdgeToSlopeLadders m_e_intersects;
 	/// The segment Delaunay graph
@@ -135,18 +188,35 @@ class IsolineSimplifier {
 	Separator m_separator;
 	/// The matching from which slope ladders are derived.
 	Matching m_matching;
-	/// The slope ladders in a min heap keyed on their simplification cost.
+	/// The slope ladders in a min heap keyed on their simplification cost; may contain stale entries.
 	Heap m_slope_ladders;
-	LadderToHandle m_ladder_heap_handle;
+	/// Maps a segment Delaunay vertex to the blocked slope ladders that have it in their neighbourhood. This may also
+	/// contain ladders that are no longer blocked, until they are pruned.
+	VertexToSlopeLadders m_blocked_ladders;
+	/// The total number of entries in \ref m_blocked_ladders.
+	std::size_t m_blocked_registrations = 0;
+	/// The value of \ref m_blocked_registrations after \ref m_blocked_ladders was last pruned.
+	std::size_t m_blocked_registrations_after_pruning = 0;
 	std::unordered_set<SDG2::Vertex_handle> m_changed_vertices;
 	std::vector<Point<K>> m_deleted_points;
 	/// The number of vertices present in the current isoline simplification.
 	int m_current_complexity = 0;
+	/// The sum of the areas of the symmetric differences of all collapses since initialization. This is an upper
+	/// bound on \ref total_symmetric_difference, maintained in constant time per collapse.
+	double m_area_error = 0;
+	/// Per simplified isoline, the part of \ref m_area_error caused by collapses on that isoline.
+	std::vector<double> m_isoline_area_error;
 	bool m_started = false;
 	double m_angle_filter;
 	double m_alignment_filter;
+	/// The number of threads used for preprocessing and for the checks in \ref simplify_batched.
+	int m_thread_count;
 	/// The method used to collapse slope ladders.
 	std::shared_ptr<LadderCollapse> m_collapse_ladder;
+	/// Optional predicate for vertices that may not be removed; slope ladders with a rung incident to such a vertex
+	/// are never collapsed. Vertices created by collapses are subject to the predicate as well. It should be set before
+	/// simplification starts.
+	std::function<bool(const Point<K>&)> m_frozen;
 	bool check_ladder_intersections_naive(const SlopeLadder& ladder) const;
 	IntersectionResult check_ladder_intersections_Voronoi(const SlopeLadder& ladder);
 	std::unordered_set<SDG2::Vertex_handle> intersected_region(Segment<K> rung, Point<K> p);
@@ -164,10 +234,41 @@ class IsolineSimplifier {
 	void initialize_sdg();
 	void initialize_slope_ladders();
 	void collapse_ladder(SlopeLadder& ladder);
+	/// Collapses a ladder returned by \ref next_ladder and marks it as old.
+	void collapse(const std::shared_ptr<SlopeLadder>& slope_ladder);
+	/// The amount by which collapsing \p ladder would increase \ref m_area_error.
+	double collapse_area(const SlopeLadder& ladder) const;
+	std::unordered_set<SDG2::Vertex_handle> ladder_neighbourhood(const SlopeLadder& ladder);
 	void create_slope_ladder(Segment<K> seg);
+	std::shared_ptr<SlopeLadder> find_slope_ladder(Segment<K> seg);
 	void clean_isolines();
 	void remove_ladder_e(Segment<K> seg);
 	std::optional<std::shared_ptr<SlopeLadder>> next_ladder();
+	/// The results of the checks of \ref check_candidate().
+	struct CandidateCheck {
+		/// The segment that the collapsed ladder would intersect, or \c std::monostate if it would intersect itself.
+		IntersectionResult intersection;
+		/// Whether the collapse would sweep over a vertex (only checked if there is no intersection).
+		bool topology_violation = false;
+	};
+	/// Pops ladders from the heap until one passes the inexpensive checks, and returns it.
+	std::optional<std::shared_ptr<SlopeLadder>> next_candidate();
+	/// Checks whether collapsing a candidate ladder would violate topology. This only reads the simplifier state, so
+	/// it can be called on several ladders concurrently.
+	CandidateCheck check_candidate(const SlopeLadder& ladder);
+	/// Applies the result of \ref check_candidate() to the ladder, and returns whether it may be collapsed.
+	bool accept_candidate(const std::shared_ptr<SlopeLadder>& ladder, const CandidateCheck& check);
+	/// Whether the ladder may still be collapsed now or later, ignoring the expensive checks.
+	bool is_pending(const SlopeLadder& ladder) const;
+	bool is_frozen(const SlopeLadder& ladder) const;
+	/// Checks whether collapsing the ladder would put a vertex on top of another vertex (other than the rung vertices
+	/// that are removed by the collapse itself).
+	bool collapses_onto_other_vertex(const SlopeLadder& ladder) const;
+	void push_ladder(const std::shared_ptr<SlopeLadder>& ladder);
+	void block_ladder(const std::shared_ptr<SlopeLadder>& ladder);
+	void unblock_ladders(SDG2::Vertex_handle vertex);
+	/// Removes ladders that are old or no longer blocked from \ref m_blocked_ladders, if there are many of them.
+	void prune_blocked_ladders();
 };
 }
 
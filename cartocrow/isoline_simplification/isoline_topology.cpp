@@ -0,0 +1,129 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "isoline_topology.h"
+
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+namespace cartocrow::isoline_simplification {
+VertexId IsolineTopology::add(const Point<K>& point, Isoline<K>* isoline,
+                              std::list<Point<K>>::iterator iterator) {
+	VertexId vertex = static_cast<VertexId>(m_vertices.size());
+	auto [it, inserted] = m_ids.insert({point, vertex});
+	if (!inserted) {
+		std::stringstream message;
+		message << "Point " << point << " belongs to multiple isolines";
+		throw std::invalid_argument(message.str());
+	}
+	TopologyVertex& data = m_vertices.emplace_back();
+	data.point = point;
+	data.isoline = isoline;
+	data.iterator = iterator;
+	++m_vertex_count;
+	return vertex;
+}
+
+void IsolineTopology::remove(VertexId vertex) {
+	TopologyVertex& data = m_vertices[vertex];
+	if (data.removed) return;
+	data.removed = true;
+	assert(m_ids.at(data.point) == vertex);
+	m_ids.erase(data.point);
+	--m_vertex_count;
+}
+
+void IsolineTopology::link(VertexId a, VertexId b) {
+	m_vertices[a].next = b;
+	m_vertices[b].prev = a;
+}
+
+void IsolineTopology::clear() {
+	m_vertices.clear();
+	m_ids.clear();
+	m_vertex_count = 0;
+}
+
+std::optional<VertexId> IsolineTopology::find(const Point<K>& point) const {
+	auto it = m_ids.find(point);
+	if (it == m_ids.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+VertexId IsolineTopology::id(const Point<K>& point) const {
+	return m_ids.at(point);
+}
+
+bool IsolineTopology::contains(const Point<K>& point) const {
+	return m_ids.contains(point);
+}
+
+TopologyVertex& IsolineTopology::operator[](VertexId vertex) {
+	return m_vertices[vertex];
+}
+
+const TopologyVertex& IsolineTopology::operator[](VertexId vertex) const {
+	return m_vertices[vertex];
+}
+
+int IsolineTopology::vertex_count() const {
+	return m_vertex_count;
+}
+
+PointToPoint::PointToPoint(const IsolineTopology& topology, VertexId TopologyVertex::*link)
+    : m_topology(&topology), m_link(link) {}
+
+bool PointToPoint::contains(const Point<K>& point) const {
+	auto vertex = m_topology->find(point);
+	return vertex && (*m_topology)[*vertex].*m_link != NO_VERTEX;
+}
+
+const Point<K>& PointToPoint::at(const Point<K>& point) const {
+	VertexId neighbor = (*m_topology)[m_topology->id(point)].*m_link;
+	if (neighbor == NO_VERTEX) {
+		throw std::out_of_range("Point has no neighbor in this direction");
+	}
+	return (*m_topology)[neighbor].point;
+}
+
+EdgeToVertex::EdgeToVertex(const IsolineTopology& topology) : m_topology(&topology) {}
+
+std::optional<VertexId> EdgeToVertex::source(const Segment<K>& edge) const {
+	auto vertex = m_topology->find(edge.source());
+	if (!vertex) return std::nullopt;
+	VertexId next = (*m_topology)[*vertex].next;
+	if (next == NO_VERTEX || (*m_topology)[next].point != edge.target()) return std::nullopt;
+	return vertex;
+}
+
+bool EdgeToVertex::contains(const Segment<K>& edge) const {
+	return source(edge).has_value();
+}
+
+const SDG2::Vertex_handle& EdgeToVertex::at(const Segment<K>& edge) const {
+	auto vertex = source(edge);
+	if (!vertex) {
+		throw std::out_of_range("Segment is not an edge of an isoline");
+	}
+	return (*m_topology)[*vertex].next_edge_delaunay_vertex;
+}
+}
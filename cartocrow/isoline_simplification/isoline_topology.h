@@ -0,0 +1,163 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_ISOLINE_TOPOLOGY_H
+#define CARTOCROW_ISOLINE_TOPOLOGY_H
+
+#include "collapse_history.h"
+#include "isoline.h"
+#include "types.h"
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace cartocrow::isoline_simplification {
+/// Index of a vertex in an \ref IsolineTopology.
+typedef int VertexId;
+/// Value of \ref VertexId that does not refer to any vertex.
+constexpr VertexId NO_VERTEX = -1;
+
+/// A vertex of the isolines that are being simplified.
+struct TopologyVertex {
+	/// The location of this vertex.
+	Point<K> point;
+	/// The previous vertex on the isoline, or \ref NO_VERTEX.
+	VertexId prev = NO_VERTEX;
+	/// The next vertex on the isoline, or \ref NO_VERTEX.
+	VertexId next = NO_VERTEX;
+	/// The isoline this vertex is part of.
+	Isoline<K>* isoline = nullptr;
+	/// The position of this vertex in the point list of \ref isoline.
+	std::list<Point<K>>::iterator iterator;
+	/// The segment Delaunay vertex of this point.
+	SDG2::Vertex_handle delaunay_vertex;
+	/// The segment Delaunay vertex of the edge from this vertex to \ref next.
+	SDG2::Vertex_handle next_edge_delaunay_vertex;
+	/// The node of this vertex in the collapse history of the simplifier.
+	HistoryNodeId history_node = NO_HISTORY_NODE;
+	/// Whether this vertex has been removed by a collapse.
+	bool removed = false;
+};
+
+/// The vertices of a set of isolines and how they are connected, stored in a
+/// flat array indexed by \ref VertexId.
+///
+/// Vertices are linked to their neighbors on the isoline by index, so walking
+/// along an isoline does not require any lookups. Identifiers of removed
+/// vertices are not reused. The only coordinate-keyed structure is the index
+/// from points to vertex identifiers, which is needed because the segment
+/// Delaunay graph and the matching refer to points. Slope ladders store the
+/// identifiers of their rung vertices, so collapsing them does not need it.
+///
+/// No two vertices that have not been removed may lie at the same point, as
+/// the point index would then be ambiguous. \ref IsolineSimplifier removes
+/// coincident points from its input to guarantee this.
+class IsolineTopology {
+  public:
+	/// Adds a vertex at the given point, without any neighbors. Throws
+	/// \c std::invalid_argument if there is already a (non-removed) vertex at
+	/// this point.
+	VertexId add(const Point<K>& point, Isoline<K>* isoline, std::list<Point<K>>::iterator iterator);
+	/// Removes the given vertex. Its neighbors are not relinked. Afterwards,
+	/// a new vertex can be added at its point.
+	void remove(VertexId vertex);
+	/// Makes \c b the next vertex of \c a (and \c a the previous vertex of \c b).
+	void link(VertexId a, VertexId b);
+	/// Removes all vertices.
+	void clear();
+
+	/// Returns the vertex at the given point, if it exists.
+	std::optional<VertexId> find(const Point<K>& point) const;
+	/// Returns the vertex at the given point. Throws \c std::out_of_range if
+	/// there is no such vertex.
+	VertexId id(const Point<K>& point) const;
+	/// Checks whether there is a vertex at the given point.
+	bool contains(const Point<K>& point) const;
+
+	TopologyVertex& operator[](VertexId vertex);
+	const TopologyVertex& operator[](VertexId vertex) const;
+
+	/// Returns the number of vertices that have not been removed.
+	int vertex_count() const;
+
+  private:
+	std::vector<TopologyVertex> m_vertices;
+	std::unordered_map<Point<K>, VertexId> m_ids;
+	int m_vertex_count = 0;
+};
+
+/// A read-only view of an \ref IsolineTopology that maps each point to the
+/// previous or next point on its isoline, with the interface of a map.
+class PointToPoint {
+  public:
+	PointToPoint(const IsolineTopology& topology, VertexId TopologyVertex::*link);
+	/// Checks if the point exists and has a previous / next point.
+	bool contains(const Point<K>& point) const;
+	/// Returns the previous / next point. Throws \c std::out_of_range if
+	/// \ref contains() is false.
+	const Point<K>& at(const Point<K>& point) const;
+
+  private:
+	const IsolineTopology* m_topology;
+	VertexId TopologyVertex::*m_link;
+};
+
+/// A read-only view of an \ref IsolineTopology that maps each point to an
+/// attribute of its vertex, with the interface of a map.
+template <typename T> class PointToAttribute {
+  public:
+	PointToAttribute(const IsolineTopology& topology, T TopologyVertex::*attribute)
+	    : m_topology(&topology), m_attribute(attribute) {}
+	bool contains(const Point<K>& point) const {
+		return m_topology->contains(point);
+	}
+	const T& at(const Point<K>& point) const {
+		return (*m_topology)[m_topology->id(point)].*m_attribute;
+	}
+
+  private:
+	const IsolineTopology* m_topology;
+	T TopologyVertex::*m_attribute;
+};
+
+typedef PointToAttribute<Isoline<K>*> PointToIsoline;
+typedef PointToAttribute<std::list<Point<K>>::iterator> PointToIterator;
+typedef PointToAttribute<SDG2::Vertex_handle> PointToVertex;
+
+/// A read-only view of an \ref IsolineTopology that maps each isoline edge,
+/// oriented along its isoline, to its segment Delaunay vertex.
+class EdgeToVertex {
+  public:
+	explicit EdgeToVertex(const IsolineTopology& topology);
+	/// Checks if the segment is an edge of an isoline, in this orientation.
+	bool contains(const Segment<K>& edge) const;
+	/// Returns the segment Delaunay vertex of the edge. Throws
+	/// \c std::out_of_range if \ref contains() is false.
+	const SDG2::Vertex_handle& at(const Segment<K>& edge) const;
+
+  private:
+	std::optional<VertexId> source(const Segment<K>& edge) const;
+
+	const IsolineTopology* m_topology;
+};
+}
+
+#endif //CARTOCROW_ISOLINE_TOPOLOGY_H
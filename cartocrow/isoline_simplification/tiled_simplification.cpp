@@ -0,0 +1,414 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "tiled_simplification.h"
+#include "isoline_simplifier.h"
+#include "../core/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cartocrow::isoline_simplification {
+namespace {
+typedef std::pair<long, long> TileIndex;
+
+/// Anchor of a replacement for the vertices before the first frozen vertex of an open isoline.
+constexpr int HEAD = -1;
+/// Anchor of a replacement for an entire isoline without frozen vertices.
+constexpr int WHOLE = -2;
+
+struct Tiling {
+	double origin_x;
+	double origin_y;
+	double size;
+	double margin;
+
+	TileIndex tile(const Point<K>& p) const {
+		return {static_cast<long>(std::floor((p.x() - origin_x) / size)),
+		        static_cast<long>(std::floor((p.y() - origin_y) / size))};
+	}
+	/// Whether \p p lies in tile \p t expanded by the margin.
+	bool in_expanded(const Point<K>& p, TileIndex t) const {
+		double x = origin_x + t.first * size;
+		double y = origin_y + t.second * size;
+		return p.x() >= x - margin && p.x() <= x + size + margin && p.y() >= y - margin &&
+		       p.y() <= y + size + margin;
+	}
+	/// Whether \p p lies in tile \p t at distance at least the margin from its boundary.
+	bool in_interior(const Point<K>& p, TileIndex t) const {
+		double x = origin_x + t.first * size;
+		double y = origin_y + t.second * size;
+		return p.x() >= x + margin && p.x() <= x + size - margin && p.y() >= y + margin &&
+		       p.y() <= y + size - margin;
+	}
+	/// The tiles whose expansion contains \p p.
+	std::vector<TileIndex> expanded_tiles(const Point<K>& p) const {
+		std::vector<TileIndex> result;
+		TileIndex t = tile(p);
+		for (long dx = -1; dx <= 1; dx++) {
+			for (long dy = -1; dy <= 1; dy++) {
+				TileIndex neighbour{t.first + dx, t.second + dy};
+				if (in_expanded(p, neighbour)) {
+					result.push_back(neighbour);
+				}
+			}
+		}
+		return result;
+	}
+};
+
+/// A maximal run of consecutive vertices of an isoline within an expanded tile.
+struct Piece {
+	int isoline;
+	std::vector<int> indices;
+	/// Whether the piece is an entire closed isoline.
+	bool closed;
+};
+
+struct TileWork {
+	TileIndex tile;
+	std::vector<Piece> pieces;
+	int removable_count = 0;
+	bool failed = false;
+};
+
+/// The simplified vertices that follow vertex \c anchor of an isoline, up to the next vertex that is kept.
+struct Replacement {
+	int isoline;
+	int anchor;
+	std::vector<Point<K>> points;
+};
+
+struct PassResult {
+	std::vector<std::vector<Point<K>>> lines;
+	/// Whether each input vertex could be removed in this pass.
+	std::vector<std::vector<char>> removable;
+};
+
+// Matches the frozen vertices of a piece to its simplification, and records the simplified vertices between them.
+bool collect_replacements(const Piece& piece, const std::vector<Point<K>>& line, std::vector<Point<K>> simplified,
+                          const std::unordered_set<Point<K>>& frozen, std::vector<Replacement>& out) {
+	std::vector<int> order = piece.indices;
+	auto first_frozen =
+	    std::find_if(order.begin(), order.end(), [&](int j) { return frozen.contains(line[j]); });
+	if (first_frozen == order.end()) {
+		// the piece is an entire isoline
+		out.push_back({piece.isoline, WHOLE, std::move(simplified)});
+		return true;
+	}
+	if (piece.closed) {
+		auto start = std::find(simplified.begin(), simplified.end(), line[*first_frozen]);
+		if (start == simplified.end()) return false;
+		std::rotate(order.begin(), first_frozen, order.end());
+		std::rotate(simplified.begin(), start, simplified.end());
+	}
+
+	int anchor = HEAD;
+	std::vector<Point<K>> pending;
+	int q = 0;
+	for (int j : order) {
+		if (!frozen.contains(line[j])) continue;
+		while (q < simplified.size() && simplified[q] != line[j]) {
+			pending.push_back(simplified[q++]);
+		}
+		if (q == simplified.size()) return false;
+		q++;
+		if (!pending.empty()) {
+			out.push_back({piece.isoline, anchor, std::move(pending)});
+			pending.clear();
+		}
+		anchor = j;
+	}
+	pending.insert(pending.end(), simplified.begin() + q, simplified.end());
+	if (!pending.empty()) {
+		out.push_back({piece.isoline, anchor, std::move(pending)});
+	}
+	return true;
+}
+
+// Simplifies, per tile, the vertices in the interior of the tile for which eligible returns true.
+PassResult simplify_pass(const std::vector<std::vector<Point<K>>>& lines, const std::vector<bool>& closed,
+                         int target, const Tiling& tiling,
+                         const std::function<bool(const Point<K>&)>& eligible, int thread_count) {
+	PassResult result{lines, std::vector<std::vector<char>>(lines.size())};
+	auto& removable = result.removable;
+
+	// A tile simplifier only sees the edges with both endpoints in its expanded tile. This includes every edge that
+	// comes near the tile, unless that edge is at least as long as the margin. Nothing is removed from tiles near
+	// such edges. (tiled_simplify() chooses the margin such that the input has no such edges, but the first pass
+	// creates longer edges that the seam pass may encounter.)
+	std::set<TileIndex> unsafe;
+	for (int i = 0; i < lines.size(); i++) {
+		const auto& line = lines[i];
+		const int n = line.size();
+		const int edge_count = n < 2 ? 0 : closed[i] ? n : n - 1;
+		for (int j = 0; j < edge_count; j++) {
+			const Point<K>& a = line[j];
+			const Point<K>& b = line[(j + 1) % n];
+			if (tiling.tile(a) == tiling.tile(b) || CGAL::squared_distance(a, b) < tiling.margin * tiling.margin) {
+				continue;
+			}
+			TileIndex low = tiling.tile(Point<K>(std::min(a.x(), b.x()) - tiling.margin,
+			                                     std::min(a.y(), b.y()) - tiling.margin));
+			TileIndex high = tiling.tile(Point<K>(std::max(a.x(), b.x()) + tiling.margin,
+			                                      std::max(a.y(), b.y()) + tiling.margin));
+			for (long x = low.first; x <= high.first; x++) {
+				for (long y = low.second; y <= high.second; y++) {
+					unsafe.insert({x, y});
+				}
+			}
+		}
+	}
+
+	std::map<TileIndex, int> tile_ids;
+	std::vector<TileWork> tiles;
+	int total = 0;
+	int removable_total = 0;
+	for (int i = 0; i < lines.size(); i++) {
+		const auto& line = lines[i];
+		const int n = line.size();
+		total += n;
+		removable[i].assign(n, false);
+		for (int j = 0; j < n; j++) {
+			const Point<K>& p = line[j];
+			TileIndex t = tiling.tile(p);
+			if (!eligible(p) || !tiling.in_interior(p, t) || unsafe.contains(t)) continue;
+			// the edges incident to a removed vertex have to lie within the expanded tile
+			if ((closed[i] || j > 0) && !tiling.in_expanded(line[(j + n - 1) % n], t)) continue;
+			if ((closed[i] || j + 1 < n) && !tiling.in_expanded(line[(j + 1) % n], t)) continue;
+			removable[i][j] = true;
+			removable_total++;
+			auto [it, inserted] = tile_ids.try_emplace(t, tiles.size());
+			if (inserted) {
+				tiles.push_back(TileWork{t});
+			}
+			tiles[it->second].removable_count++;
+		}
+	}
+	if (removable_total == 0 || total <= target) {
+		return result;
+	}
+
+	for (int i = 0; i < lines.size(); i++) {
+		const auto& line = lines[i];
+		const int n = line.size();
+		std::map<int, std::vector<int>> tile_indices;
+		for (int j = 0; j < n; j++) {
+			for (TileIndex t : tiling.expanded_tiles(line[j])) {
+				if (auto it = tile_ids.find(t); it != tile_ids.end()) {
+					tile_indices[it->second].push_back(j);
+				}
+			}
+		}
+		for (auto& [tile, indices] : tile_indices) {
+			std::vector<std::vector<int>> runs;
+			for (int j : indices) {
+				if (runs.empty() || runs.back().back() != j - 1) {
+					runs.emplace_back();
+				}
+				runs.back().push_back(j);
+			}
+			if (closed[i] && runs.size() > 1 && runs.front().front() == 0 && runs.back().back() == n - 1) {
+				runs.back().insert(runs.back().end(), runs.front().begin(), runs.front().end());
+				runs.erase(runs.begin());
+			}
+			for (auto& run : runs) {
+				if (run.size() < 2) continue;
+				bool whole = closed[i] && run.size() == n;
+				tiles[tile].pieces.push_back(Piece{i, std::move(run), whole});
+			}
+		}
+	}
+
+	const double reduce_ratio = std::min(1.0, static_cast<double>(total - target) / removable_total);
+	std::vector<std::vector<Replacement>> replacements(tiles.size());
+	auto simplify_tile = [&](int k) {
+		TileWork& work = tiles[k];
+		const int reduction = static_cast<int>(std::lround(work.removable_count * reduce_ratio));
+		if (reduction <= 0) {
+			work.failed = true;
+			return;
+		}
+		std::vector<Isoline<K>> pieces;
+		std::unordered_set<Point<K>> frozen;
+		for (const Piece& piece : work.pieces) {
+			std::vector<Point<K>> points;
+			for (int j : piece.indices) {
+				const Point<K>& p = lines[piece.isoline][j];
+				points.push_back(p);
+				if (!removable[piece.isoline][j] || tiling.tile(p) != work.tile) {
+					frozen.insert(p);
+				}
+			}
+			pieces.emplace_back(std::move(points), piece.closed);
+		}
+
+		IsolineSimplifier simplifier(std::move(pieces));
+		if (simplifier.m_simplified_isolines.size() != work.pieces.size()) {
+			// the simplifier joined pieces that share an endpoint, so we cannot map them back
+			work.failed = true;
+			return;
+		}
+		simplifier.m_frozen = [&frozen](const Point<K>& p) { return frozen.contains(p); };
+		simplifier.simplify(simplifier.m_current_complexity - reduction);
+
+		for (int p = 0; p < work.pieces.size(); p++) {
+			const Piece& piece = work.pieces[p];
+			const auto& line = lines[piece.isoline];
+			const auto& points = simplifier.m_simplified_isolines[p].m_points;
+			std::vector<Point<K>> simplified(points.begin(), points.end());
+			const int before = replacements[k].size();
+			if (!collect_replacements(piece, line, std::move(simplified), frozen, replacements[k])) {
+				// keep this piece as is
+				replacements[k].resize(before);
+				std::vector<Point<K>> original;
+				for (int j : piece.indices) {
+					original.push_back(line[j]);
+				}
+				collect_replacements(piece, line, original, frozen, replacements[k]);
+			}
+		}
+	};
+
+	parallel_for(static_cast<int>(tiles.size()), thread_count, simplify_tile);
+
+	// vertices of tiles that were not simplified are kept
+	for (const TileWork& work : tiles) {
+		if (!work.failed) continue;
+		for (const Piece& piece : work.pieces) {
+			for (int j : piece.indices) {
+				if (tiling.tile(lines[piece.isoline][j]) == work.tile) {
+					removable[piece.isoline][j] = false;
+				}
+			}
+		}
+	}
+
+	std::vector<std::unordered_map<int, std::vector<Point<K>>>> anchored(lines.size());
+	for (auto& tile_replacements : replacements) {
+		for (auto& replacement : tile_replacements) {
+			anchored[replacement.isoline][replacement.anchor] = std::move(replacement.points);
+		}
+	}
+	for (int i = 0; i < lines.size(); i++) {
+		if (anchored[i].empty()) continue;
+		if (auto whole = anchored[i].find(WHOLE); whole != anchored[i].end()) {
+			result.lines[i] = std::move(whole->second);
+			continue;
+		}
+		std::vector<Point<K>> line;
+		if (auto head = anchored[i].find(HEAD); head != anchored[i].end()) {
+			line = std::move(head->second);
+		}
+		for (int j = 0; j < lines[i].size(); j++) {
+			if (!removable[i][j]) {
+				line.push_back(lines[i][j]);
+			}
+			if (auto it = anchored[i].find(j); it != anchored[i].end()) {
+				line.insert(line.end(), it->second.begin(), it->second.end());
+			}
+		}
+		result.lines[i] = std::move(line);
+	}
+	return result;
+}
+}
+
+std::vector<Isoline<K>> tiled_simplify(const std::vector<Isoline<K>>& isolines, int target, double tile_size,
+                                       double margin, int thread_count) {
+	if (tile_size <= 0 || margin < 0 || 4 * margin >= tile_size) {
+		throw std::runtime_error("The tile margin should be non-negative and less than a quarter of the tile size");
+	}
+
+	std::vector<std::vector<Point<K>>> lines;
+	std::vector<bool> closed;
+	double min_x = std::numeric_limits<double>::infinity();
+	double min_y = std::numeric_limits<double>::infinity();
+	for (const auto& isoline : isolines) {
+		std::vector<Point<K>> line(isoline.m_points.begin(), isoline.m_points.end());
+		line.erase(std::unique(line.begin(), line.end()), line.end());
+		bool is_closed = isoline.m_closed;
+		if (line.size() > 1 && line.front() == line.back()) {
+			line.pop_back();
+			is_closed = true;
+		}
+		for (const Point<K>& p : line) {
+			min_x = std::min(min_x, p.x());
+			min_y = std::min(min_y, p.y());
+		}
+		lines.push_back(std::move(line));
+		closed.push_back(is_closed);
+	}
+
+	// The topology guarantee needs every edge that crosses a tile boundary (in either pass) to be shorter than the
+	// margin; see simplify_pass.
+	Tiling tiling{min_x, min_y, tile_size, margin};
+	Tiling shifted{min_x - tile_size / 2, min_y - tile_size / 2, tile_size, margin};
+	double longest = 0;
+	for (int i = 0; i < lines.size(); i++) {
+		const int n = lines[i].size();
+		const int edge_count = n < 2 ? 0 : closed[i] ? n : n - 1;
+		for (int j = 0; j < edge_count; j++) {
+			const Point<K>& a = lines[i][j];
+			const Point<K>& b = lines[i][(j + 1) % n];
+			if (tiling.tile(a) != tiling.tile(b) || shifted.tile(a) != shifted.tile(b)) {
+				longest = std::max(longest, std::sqrt(CGAL::squared_distance(a, b)));
+			}
+		}
+	}
+	if (longest >= margin) {
+		// with a little slack, so that the comparison in simplify_pass is not affected by rounding
+		margin = longest * (1 + 1E-6);
+		if (4 * margin >= tile_size) {
+			throw std::runtime_error("The isolines have an edge of length " + std::to_string(longest) +
+			                         " crossing a tile boundary; the tile size should be more than four times that");
+		}
+		tiling.margin = margin;
+		shifted.margin = margin;
+	}
+
+	PassResult first = simplify_pass(lines, closed, target, tiling, [](const Point<K>&) { return true; },
+	                                 thread_count);
+
+	// the seam pass may only remove vertices that the first pass had to keep
+	std::unordered_set<Point<K>> seams;
+	for (int i = 0; i < lines.size(); i++) {
+		for (int j = 0; j < lines[i].size(); j++) {
+			if (!first.removable[i][j]) {
+				seams.insert(lines[i][j]);
+			}
+		}
+	}
+	PassResult second = simplify_pass(first.lines, closed, target, shifted,
+	                                  [&seams](const Point<K>& p) { return seams.contains(p); }, thread_count);
+
+	std::vector<Isoline<K>> result;
+	for (int i = 0; i < second.lines.size(); i++) {
+		result.emplace_back(std::move(second.lines[i]), closed[i]);
+	}
+	return result;
+}
+}
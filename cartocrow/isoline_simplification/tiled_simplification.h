@@ -0,0 +1,49 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_TILED_SIMPLIFICATION_H
+#define CARTOCROW_TILED_SIMPLIFICATION_H
+
+#include "isoline.h"
+#include "types.h"
+
+namespace cartocrow::isoline_simplification {
+/// Simplifies isolines to (approximately) \p target vertices by partitioning the plane into square tiles of width
+/// \p tile_size that are simplified independently, and in parallel, by an \ref IsolineSimplifier.
+///
+/// Each tile simplifier receives only the parts of the isolines within the tile expanded by \p margin, so memory use
+/// is bounded by the complexity of a single tile rather than by that of the whole input. Vertices within distance
+/// \p margin of the tile boundary, or with a neighbour outside the expanded tile, are frozen: they serve as context
+/// for the topology checks but are never removed. The required reduction is distributed over the tiles in
+/// proportion to the number of vertices they may remove.
+///
+/// Afterwards a seam pass is run on a grid shifted by half a tile, in which only the vertices frozen in the first
+/// pass may be removed. This simplifies across the original tile boundaries; only small regions around the points
+/// where an original and a shifted tile boundary cross remain unsimplified.
+///
+/// The tile simplifiers cannot see isolines that pass through their margin without a vertex in it. To preserve
+/// topology, the margin is therefore enlarged to exceed the longest input edge that crosses a tile boundary, and
+/// tiles near longer edges created by the first pass are left alone in the seam pass. The (enlarged) margin must be
+/// less than a quarter of the tile size; otherwise this throws \c std::runtime_error. A \p thread_count of 0 uses
+/// one thread per hardware core.
+std::vector<Isoline<K>> tiled_simplify(const std::vector<Isoline<K>>& isolines, int target, double tile_size,
+                                       double margin, int thread_count = 0);
+}
+
+#endif //CARTOCROW_TILED_SIMPLIFICATION_H
@@ -35,11 +35,5 @@ typedef CGAL::Segment_Delaunay_graph_2<Gt> SDG2;
 
 typedef std::unordered_map<CGAL::Orientation, std::unordered_map<Isoline<K>*, std::vector<Point<K>>>> MatchedTo;
 typedef std::unordered_map<Point<K>, MatchedTo> Matching;
-
-typedef std::unordered_map<Point<K>, Point<K>> PointToPoint;
-typedef std::unordered_map<Point<K>, Isoline<K>*> PointToIsoline;
-typedef std::unordered_map<Point<K>, std::list<Point<K>>::iterator> PointToIterator;
-typedef std::unordered_map<Point<K>, SDG2::Vertex_handle> PointToVertex;
-typedef std::unordered_map<Segment<K>, SDG2::Vertex_handle> EdgeToVertex;
 }
 #endif //CARTOCROW_ISOLINE_SIMPLIFICATION_TYPES_H
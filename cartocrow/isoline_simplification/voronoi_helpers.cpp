@@ -19,6 +19,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "types.h"
 #include "voronoi_helpers.h"
+#include "../core/parallel.h"
 #include <CGAL/Segment_Delaunay_graph_adaptation_traits_2.h>
 #include <CGAL/Voronoi_diagram_2.h>
 #include <unordered_set>
@@ -189,12 +190,31 @@ Segment<K> snap_endpoints(Segment<K> proj, Segment<K> original) {
 
 Matching matching(const SDG2& delaunay, const Separator& separator, const PointToPoint& p_prev,
                   const PointToPoint& p_next, const PointToIsoline& p_isoline, const PointToVertex& p_vertex,
-                  const double angle_filter, const double alignment_filter) {
-	std::unordered_map<Point<K>, MatchedTo> matching;
+                  const double angle_filter, const double alignment_filter, int thread_count) {
+	// Chunks are ordered by isoline, which are stored contiguously, and merged in that order, so that the insertion
+	// order into the matching is the same for every thread count.
+	std::vector<std::pair<Isoline<K>*, const std::vector<SDG2::Edge>*>> chunks;
+	for (auto& [isoline, edges] : separator) {
+		chunks.emplace_back(isoline, &edges);
+	}
+	std::sort(chunks.begin(), chunks.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	std::vector<Matching> partial(chunks.size());
+	parallel_for(static_cast<int>(chunks.size()), thread_count, [&](int i) {
+		for (auto edge : *chunks[i].second) {
+			create_matching(delaunay, edge, partial[i], p_prev, p_next, p_isoline, p_vertex, angle_filter,
+			                alignment_filter);
+		}
+	});
 
-	for (auto& [_, edges]: separator)
-	for (auto edge : edges) {
-		create_matching(delaunay, edge, matching, p_prev, p_next, p_isoline, p_vertex, angle_filter, alignment_filter);
+	std::unordered_map<Point<K>, MatchedTo> matching;
+	for (auto& part : partial) {
+		for (auto& [p, ms] : part)
+		for (auto& [sign, mi] : ms)
+		for (auto& [isoline, pts] : mi) {
+			auto& merged = matching[p][sign][isoline];
+			merged.insert(merged.end(), pts.begin(), pts.end());
+		}
 	}
 
 	auto comparison_f = compare_along_isoline(p_prev, p_next);
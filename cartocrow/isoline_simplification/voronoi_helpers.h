@@ -18,7 +18,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "isoline.h"
+#include "isoline_topology.h"
 #include "types.h"
+#include <functional>
 #include <vector>
 #include "voronoi_helpers_cgal.h"
 
@@ -43,9 +45,11 @@ SDG2::Point_2 point_of_site(const SDG2::Site_2& site);
 Separator medial_axis_separator(const SDG2& delaunay, const PointToIsoline& isoline, const PointToPoint& prev, const PointToPoint& next);
 std::variant<Point<K>, Segment<K>> site_projection(const SDG2& delaunay, const SDG2::Edge& edge, const SDG2::Site_2& site);
 Segment<K> snap_endpoints(Segment<K> proj, Segment<K> original);
+/// Computes the matching along the edges of the separator. The edges of each isoline are processed as one chunk,
+/// on \p thread_count threads (0 uses one per hardware core); the result does not depend on the number of threads.
 Matching matching(const SDG2& delaunay, const Separator& separator, const PointToPoint& p_prev,
                   const PointToPoint& p_next, const PointToIsoline& p_isoline, const PointToVertex& p_vertex,
-                  const double angle_filter, const double alignment_filter);
+                  const double angle_filter, const double alignment_filter, int thread_count = 1);
 CGAL::Orientation side(const SDG2::Point_2& p, const SDG2::Point_2& point, const PointToPoint& p_prev, const PointToPoint& p_next);
 CGAL::Orientation side(const SDG2::Site_2& site, const SDG2::Point_2& point, const PointToPoint& p_prev, const PointToPoint& p_next);
 std::vector<Point<K>> project_snap(const SDG2& delaunay, const SDG2::Site_2& site, const SDG2::Edge& edge);
@@ -23,7 +23,9 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 25-02-2020
 #include "bezier_necklace.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <limits>
 
 namespace cartocrow {
 namespace necklace_map {
@@ -63,14 +65,26 @@ class CompareBezierCurves {
  * @brief The maximum ratio within distances from the kernel to classify as a circle necklace.
  */
 
+/**@fn const int BezierNecklace::kDefaultSamplesPerCurve
+ * @brief The default number of samples per curve in the covering radius lookup table.
+ */
+
+/**@fn const int BezierNecklace::kDefaultRadiusLevels
+ * @brief The default number of bead radii for which the covering radius lookup table is filled.
+ */
+
 /**@brief Construct a new Bezier spline necklace.
  *
  * The necklace must be a star-shaped curve with its kernel as star point.
  * @param spline the Bezier spline shape.
  * @param kernel the kernel (and star-point) of the necklace.
+ * @param samples_per_curve the number of samples per curve in the covering radius lookup table.
+ * @param radius_levels the number of bead radii for which the covering radius lookup table is filled.
  */
-BezierNecklace::BezierNecklace(const BezierSpline spline, const Point<Inexact>& kernel)
-    : spline_(spline), kernel_(kernel) {
+BezierNecklace::BezierNecklace(const BezierSpline spline, const Point<Inexact>& kernel,
+                               const int samples_per_curve, const int radius_levels)
+    : spline_(spline), kernel_(kernel), samples_per_curve_(samples_per_curve),
+      radius_levels_(radius_levels) {
 	// Clockwise curves are reversed.
 	if (CGAL::orientation(spline_.curves().begin()->source(),
 	                      spline_.curves().begin()->sourceControl(), kernel_) == CGAL::CLOCKWISE) {
@@ -80,6 +94,8 @@ BezierNecklace::BezierNecklace(const BezierSpline spline, const Point<Inexact>&
 	// Reorder the curves to start with the curve directly to the right of the kernel.
 	std::sort(spline_.curves().begin(), spline_.curves().end(), CompareBezierCurves(*this));
 	assert(spline_.isClosed());
+
+	buildCoveringRadiusTable();
 }
 
 const Point<Inexact>& BezierNecklace::kernel() const {
@@ -93,6 +109,21 @@ const BezierSpline& BezierNecklace::spline() const {
 	return spline_;
 }
 
+/**@brief Set the precision of the covering radius lookup table.
+ *
+ * The covering radius of a bead is looked up by interpolating between samples on the spline and between tabulated bead radii. More samples per curve bound the error caused by spline curvature between samples; more radius levels bound the error caused by interpolating between bead radii. The table takes O(s log s) space per radius level, where s is the total number of samples.
+ *
+ * Setting either value to 0 disables the lookup table: all covering radii are then computed by searching the spline directly.
+ * @param samples_per_curve the number of samples per curve.
+ * @param radius_levels the number of bead radii for which the table is filled.
+ */
+void BezierNecklace::setCoveringRadiusPrecision(const int samples_per_curve,
+                                                const int radius_levels) {
+	samples_per_curve_ = samples_per_curve;
+	radius_levels_ = radius_levels;
+	buildCoveringRadiusTable();
+}
+
 bool BezierNecklace::isValid() const {
 	// Check whether the curve is valid in relation to the necklace.
 	// For the curve to be valid it must not be degenerate, i.e. its points must not all be the same.
@@ -131,6 +162,29 @@ Number<Inexact> BezierNecklace::computeCoveringRadiusRad(const Range& range,
 		return 0;
 	}
 
+	// Beads larger than the largest tabulated radius are rare (they would nearly contain the kernel), so these are computed directly.
+	if (level_radii_.empty() || level_radii_.back() < radius) {
+		return computeCoveringRadiusRadSampled(range, radius);
+	}
+
+	// Interpolate between the covering radii of the tabulated bead radii surrounding the requested radius.
+	// Because the covering radius is a convex function of the bead radius (cf. the arcsine for circle necklaces),
+	// linear interpolation overestimates the covering radius, i.e. it errs on the side of keeping the beads apart.
+	// Below the smallest tabulated radius, the covering radius is interpolated towards 0 at radius 0.
+	const size_t level =
+	    std::lower_bound(level_radii_.begin(), level_radii_.end(), radius) - level_radii_.begin();
+	if (level == 0) {
+		return lookupCoveringRadiusRad(range, 0) * radius / level_radii_[0];
+	}
+
+	const Number<Inexact> weight =
+	    (radius - level_radii_[level - 1]) / (level_radii_[level] - level_radii_[level - 1]);
+	return (1 - weight) * lookupCoveringRadiusRad(range, level - 1) +
+	       weight * lookupCoveringRadiusRad(range, level);
+}
+
+Number<Inexact> BezierNecklace::computeCoveringRadiusRadSampled(const Range& range,
+                                                                const Number<Inexact>& radius) const {
 	// Sample the range and determine the largest covering radius, i.e. the largest angle difference towards the point on the spline at a fixed distance.
 	// There are several viable sampling strategies (with evaluation):
 	// - fixed angle difference (sensitive to spline curvature, i.e. low curvature means oversampling)
@@ -149,8 +203,9 @@ Number<Inexact> BezierNecklace::computeCoveringRadiusRad(const Range& range,
 
 	Number<Inexact> t_from, t_to;
 	Point<Inexact> point;
-	assert(intersectRay(range.from(), curve_iter_from, point, t_from));
-	assert(intersectRay(range.to(), curve_iter_to, point, t_to));
+	[[maybe_unused]] const bool found_from = intersectRay(range.from(), curve_iter_from, point, t_from);
+	[[maybe_unused]] const bool found_to = intersectRay(range.to(), curve_iter_to, point, t_to);
+	assert(found_from && found_to);
 
 	const Number<Inexact> t_step = 0.25;
 	Number<Inexact> t = t_from;
@@ -160,9 +215,12 @@ Number<Inexact> BezierNecklace::computeCoveringRadiusRad(const Range& range,
 		point = curve_iter->evaluate(t);
 		const Number<Inexact> angle_rad = computeAngleRad(point);
 
-		Number<Inexact> angle_ccw, angle_cw;
-		assert(computeAngleAtDistanceRad(point, radius, curve_iter, t, angle_ccw));
-		assert(computeAngleAtDistanceRad(point, -radius, curve_iter, t, angle_cw));
+		Number<Inexact> angle_ccw = angle_rad, angle_cw = angle_rad;
+		[[maybe_unused]] const bool found_ccw =
+		    computeAngleAtDistanceRad(point, radius, curve_iter, t, angle_ccw);
+		[[maybe_unused]] const bool found_cw =
+		    computeAngleAtDistanceRad(point, -radius, curve_iter, t, angle_cw);
+		assert(found_ccw && found_cw);
 
 		const Number<Inexact> covering_radius_rad_ccw = CircularRange(angle_rad, angle_ccw).length();
 		const Number<Inexact> covering_radius_rad_cw = CircularRange(angle_cw, angle_rad).length();
@@ -356,5 +414,158 @@ Number<Inexact> BezierNecklace::searchCurveForAngleAtDistanceRad(
 	return computeAngleRad(point_upper);
 }
 
+void BezierNecklace::buildCoveringRadiusTable() {
+	sample_angles_rad_.clear();
+	level_radii_.clear();
+	covering_radii_rad_.clear();
+	if (samples_per_curve_ <= 0 || radius_levels_ <= 0 || spline_.curves().empty()) {
+		return;
+	}
+
+	// Sample each curve at regular t-steps and record the cumulative angle of each sample.
+	// Note that the spline is star-shaped with the kernel as star point, so these angles increase monotonically.
+	struct Sample {
+		BezierSpline::CurveSet::const_iterator curve_iter;
+		Number<Inexact> t;
+		Point<Inexact> point;
+	};
+	std::vector<Sample> samples;
+	samples.reserve(spline_.curves().size() * samples_per_curve_);
+	Number<Inexact> squared_distance_min = std::numeric_limits<Number<Inexact>>::max();
+	for (BezierSpline::CurveSet::const_iterator curve_iter = spline_.curves().begin();
+	     curve_iter != spline_.curves().end(); ++curve_iter) {
+		for (int step = 0; step < samples_per_curve_; ++step) {
+			const Number<Inexact> t = Number<Inexact>(step) / samples_per_curve_;
+			const Point<Inexact> point = curve_iter->evaluate(t);
+			squared_distance_min = std::min(squared_distance_min, CGAL::squared_distance(point, kernel()));
+
+			const Number<Inexact> angle_rad = computeAngleRad(point);
+			if (sample_angles_rad_.empty()) {
+				// The first curve contains the angle 0, so its source may lie just clockwise of it.
+				sample_angles_rad_.push_back(M_PI < angle_rad ? angle_rad - M_2xPI : angle_rad);
+			} else {
+				sample_angles_rad_.push_back(wrapAngle(angle_rad, sample_angles_rad_.back()));
+			}
+			samples.push_back({curve_iter, t, point});
+		}
+	}
+	sample_angles_rad_.push_back(sample_angles_rad_.front() + M_2xPI);
+	const size_t num_samples = samples.size();
+
+	// The bead radii are spaced geometrically (half an octave apart) up to the smallest distance between the spline and the kernel.
+	// Any bead of at most this radius reaches the spline at its covering radius in both directions.
+	const Number<Inexact> radius_max = CGAL::sqrt(squared_distance_min);
+	for (int level = 0; level < radius_levels_; ++level) {
+		const Number<Inexact> radius = radius_max * std::pow(M_SQRT1_2, radius_levels_ - 1 - level);
+
+		// Compute the covering radius of a bead centered on each sample.
+		std::vector<Number<Inexact>> covering_radii_rad(num_samples);
+		bool complete = true;
+		for (size_t index = 0; index < num_samples && complete; ++index) {
+			const Sample& sample = samples[index];
+			const Number<Inexact> angle_rad = computeAngleRad(sample.point);
+
+			Number<Inexact> angle_ccw, angle_cw;
+			complete = computeAngleAtDistanceRad(sample.point, radius, sample.curve_iter, sample.t,
+			                                     angle_ccw) &&
+			           computeAngleAtDistanceRad(sample.point, -radius, sample.curve_iter, sample.t,
+			                                     angle_cw);
+			if (complete) {
+				covering_radii_rad[index] = std::max(CircularRange(angle_rad, angle_ccw).length(),
+				                                     CircularRange(angle_cw, angle_rad).length());
+			}
+		}
+		if (!complete) {
+			// Larger radii are computed without the table.
+			break;
+		}
+
+		// Prepare range-maximum queries using a sparse table: entry [j][i] is the maximum over samples [i, i + 2^j).
+		std::vector<std::vector<Number<Inexact>>> table;
+		table.push_back(std::move(covering_radii_rad));
+		for (size_t width = 2; width <= num_samples; width *= 2) {
+			const std::vector<Number<Inexact>>& previous = table.back();
+			std::vector<Number<Inexact>> row(num_samples - width + 1);
+			for (size_t index = 0; index < row.size(); ++index) {
+				row[index] = std::max(previous[index], previous[index + width / 2]);
+			}
+			table.push_back(std::move(row));
+		}
+
+		level_radii_.push_back(radius);
+		covering_radii_rad_.push_back(std::move(table));
+	}
+}
+
+Number<Inexact> BezierNecklace::findSamplePosition(const Number<Inexact>& angle_rad) const {
+	// Find the sample interval containing the angle and interpolate linearly within this interval.
+	const size_t num_samples = sample_angles_rad_.size() - 1;
+	const Number<Inexact> angle_wrapped_rad = wrapAngle(angle_rad, sample_angles_rad_.front());
+	const size_t index = std::min<size_t>(
+	    std::upper_bound(sample_angles_rad_.begin(), sample_angles_rad_.end(), angle_wrapped_rad) -
+	        sample_angles_rad_.begin() - 1,
+	    num_samples - 1);
+	const Number<Inexact> span_rad = sample_angles_rad_[index + 1] - sample_angles_rad_[index];
+	const Number<Inexact> fraction =
+	    span_rad <= 0 ? 0 : (angle_wrapped_rad - sample_angles_rad_[index]) / span_rad;
+	return index + std::clamp(fraction, Number<Inexact>(0), Number<Inexact>(1));
+}
+
+Number<Inexact> BezierNecklace::lookupCoveringRadiusRad(const Range& range,
+                                                        const size_t level) const {
+	const size_t num_samples = sample_angles_rad_.size() - 1;
+	if (M_2xPI <= range.length()) {
+		return queryCoveringRadiusRad(level, 0, num_samples - 1);
+	}
+
+	// Note that the range may wrap around the first sample.
+	const Number<Inexact> position_from = findSamplePosition(range.from());
+	Number<Inexact> position_to = findSamplePosition(range.to());
+	if (position_to < position_from) {
+		position_to += num_samples;
+	}
+
+	// The covering radius at the range endpoints is interpolated between the neighboring samples.
+	const std::vector<Number<Inexact>>& covering_radii_rad = covering_radii_rad_[level][0];
+	const auto interpolate = [&covering_radii_rad, num_samples](const Number<Inexact>& position) {
+		const size_t index = static_cast<size_t>(position);
+		const Number<Inexact> fraction = position - index;
+		return (1 - fraction) * covering_radii_rad[index % num_samples] +
+		       fraction * covering_radii_rad[(index + 1) % num_samples];
+	};
+	Number<Inexact> covering_radius_rad =
+	    std::max(interpolate(position_from), interpolate(position_to));
+
+	// The samples strictly inside the range are handled by a range-maximum query.
+	const size_t first = static_cast<size_t>(position_from) + 1;
+	const size_t last = static_cast<size_t>(position_to);
+	if (first <= last) {
+		if (num_samples <= last - first + 1) {
+			return queryCoveringRadiusRad(level, 0, num_samples - 1);
+		}
+		if (last < num_samples) {
+			covering_radius_rad =
+			    std::max(covering_radius_rad, queryCoveringRadiusRad(level, first, last));
+		} else if (num_samples <= first) {
+			covering_radius_rad = std::max(
+			    covering_radius_rad,
+			    queryCoveringRadiusRad(level, first - num_samples, last - num_samples));
+		} else {
+			covering_radius_rad = std::max(
+			    {covering_radius_rad, queryCoveringRadiusRad(level, first, num_samples - 1),
+			     queryCoveringRadiusRad(level, 0, last - num_samples)});
+		}
+	}
+	return covering_radius_rad;
+}
+
+Number<Inexact> BezierNecklace::queryCoveringRadiusRad(const size_t level, const size_t first,
+                                                       const size_t last) const {
+	assert(first <= last);
+	const size_t log_width = std::bit_width(last - first + 1) - 1;
+	const std::vector<Number<Inexact>>& row = covering_radii_rad_[level][log_width];
+	return std::max(row[first], row[last + 1 - (size_t(1) << log_width)]);
+}
+
 } // namespace necklace_map
 } // namespace cartocrow
@@ -23,6 +23,8 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 25-02-2020
 #ifndef CARTOCROW_NECKLACE_MAP_BEZIER_NECKLACE_H
 #define CARTOCROW_NECKLACE_MAP_BEZIER_NECKLACE_H
 
+#include <vector>
+
 #include "../core/core.h"
 #include "../core/bezier.h"
 #include "necklace_shape.h"
@@ -35,12 +37,20 @@ class BezierNecklace : public NecklaceShape {
 
 	static constexpr const Number<Inexact> kDistanceRatioEpsilon = 1.001;
 
-	BezierNecklace(const BezierSpline spline, const Point<Inexact>& kernel);
+	static constexpr const int kDefaultSamplesPerCurve = 16;
+
+	static constexpr const int kDefaultRadiusLevels = 16;
+
+	BezierNecklace(const BezierSpline spline, const Point<Inexact>& kernel,
+	               const int samples_per_curve = kDefaultSamplesPerCurve,
+	               const int radius_levels = kDefaultRadiusLevels);
 
 	const Point<Inexact>& kernel() const override;
 
 	const BezierSpline& spline() const;
 
+	void setCoveringRadiusPrecision(const int samples_per_curve, const int radius_levels);
+
 	bool isValid() const override;
 
 	bool intersectRay(const Number<Inexact>& angle_rad, Point<Inexact>& intersection) const override;
@@ -75,9 +85,34 @@ class BezierNecklace : public NecklaceShape {
 	                                                 const CGAL::Orientation& orientation,
 	                                                 const Number<Inexact>& t_start) const;
 
+	Number<Inexact> computeCoveringRadiusRadSampled(const Range& range,
+	                                                const Number<Inexact>& radius) const;
+
+	void buildCoveringRadiusTable();
+
+	Number<Inexact> findSamplePosition(const Number<Inexact>& angle_rad) const;
+
+	Number<Inexact> lookupCoveringRadiusRad(const Range& range, const size_t level) const;
+
+	Number<Inexact> queryCoveringRadiusRad(const size_t level, const size_t first,
+	                                       const size_t last) const;
+
 	BezierSpline spline_;
 
 	Point<Inexact> kernel_;
+
+	int samples_per_curve_;
+	int radius_levels_;
+
+	// The cumulative angle of each sample on the spline, increasing from the first sample.
+	// The final entry closes the spline and lies 2*pi beyond the first.
+	std::vector<Number<Inexact>> sample_angles_rad_;
+
+	// The bead radii for which the covering radii are tabulated, in increasing order.
+	std::vector<Number<Inexact>> level_radii_;
+
+	// Sparse table of covering radii, indexed by [level][log2(length)][sample].
+	std::vector<std::vector<std::vector<Number<Inexact>>>> covering_radii_rad_;
 };
 
 } // namespace cartocrow::necklace_map
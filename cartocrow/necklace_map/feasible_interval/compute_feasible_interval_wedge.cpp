@@ -22,6 +22,13 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 03-03-2020
 
 #include "compute_feasible_interval_wedge.h"
 
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include <CGAL/Polygon_2_algorithms.h>
+#include <CGAL/convex_hull_2.h>
+
 #include "../necklace_interval.h"
 #include "cartocrow/core/core.h"
 
@@ -29,50 +36,66 @@ namespace cartocrow::necklace_map {
 
 CircularRange ComputeFeasibleWedgeInterval::operator()(const PolygonSet<Inexact>& shape,
                                                        const Necklace& necklace) const {
-	// TODO code commented out for the sake of getting this to work
-	/*assert(extent.size() > 0);
-	if (extent.size() == 1) {
-		return (*fallback_point_regions_)(extent, necklace);
+	// The smallest wedge containing the region is also the smallest wedge containing its convex hull.
+	// Note that holes never contribute to the hull.
+	std::vector<PolygonWithHoles<Inexact>> polygons;
+	shape.polygons_with_holes(std::back_inserter(polygons));
+	std::vector<Point<Inexact>> points;
+	for (const PolygonWithHoles<Inexact>& polygon : polygons) {
+		points.insert(points.end(), polygon.outer_boundary().vertices_begin(),
+		              polygon.outer_boundary().vertices_end());
 	}
 
-	const Number angle = necklace->shape->ComputeAngleRad(*extent.vertices_begin());
-	CircularRange obscured(angle, angle);
-
-	const Point& kernel = necklace->shape->kernel();
-	for (Polygon::Edge_const_iterator edge_iter = extent.edges_begin();
-	     edge_iter != extent.edges_end(); ++edge_iter) {
-		const Segment& segment = *edge_iter;
-		const Number angle_target = necklace->shape->ComputeAngleRad(segment[1]);
-
-		if (CGAL::left_turn(segment[0], segment[1], kernel)) {
-			// Counterclockwise segment.
-			obscured.to_rad() =
-			    std::max(obscured.to_rad(), ModuloNonZero(angle_target, obscured.from_rad()));
-		} else {
-			// Clockwise segment.
-			Number angle_target_adj = angle_target;
-			while (obscured.to_rad() < angle_target_adj) {
-				angle_target_adj -= M_2xPI;
+	std::vector<Point<Inexact>> hull;
+	CGAL::convex_hull_2(points.begin(), points.end(), std::back_inserter(hull));
+	if (hull.size() <= 1) {
+		return (*fallback_point_regions_)(shape, necklace);
+	}
+
+	const Point<Inexact>& kernel = necklace.shape->kernel();
+	if (hull.size() == 2) {
+		if (CGAL::collinear(hull[0], hull[1], kernel)) {
+			if (CGAL::collinear_are_ordered_along_line(hull[0], kernel, hull[1])) {
+				return (*fallback_kernel_region_)(shape, necklace);
 			}
-			obscured.from_rad() = std::min(obscured.from_rad(), angle_target_adj);
+			return (*fallback_point_regions_)(shape, necklace);
+		}
+	} else if (CGAL::bounded_side_2(hull.begin(), hull.end(), kernel) != CGAL::ON_UNBOUNDED_SIDE) {
+		return (*fallback_kernel_region_)(shape, necklace);
+	}
+
+	// The kernel lies outside the hull, so the hull edges visible from the kernel form a single chain.
+	// Walking the hull counterclockwise, this chain starts at the counterclockwise tangent point and ends at the clockwise tangent point.
+	const size_t num_vertices = hull.size();
+	const auto visible = [&hull, &kernel, num_vertices](const size_t index) {
+		return CGAL::right_turn(hull[index], hull[(index + 1) % num_vertices], kernel);
+	};
+	std::optional<size_t> tangent_cw, tangent_ccw;
+	for (size_t index = 0; index < num_vertices; ++index) {
+		const bool visible_before = visible((index + num_vertices - 1) % num_vertices);
+		const bool visible_after = visible(index);
+		if (visible_before && !visible_after) {
+			tangent_cw = index;
+		} else if (!visible_before && visible_after) {
+			tangent_ccw = index;
 		}
 	}
+	if (!tangent_cw || !tangent_ccw) {
+		return (*fallback_point_regions_)(shape, necklace);
+	}
 
-	const Number interval_length = obscured.ComputeLength();
+	const Number<Inexact> angle_cw_rad = necklace.shape->computeAngleRad(hull[*tangent_cw]);
+	const Number<Inexact> angle_ccw_rad =
+	    wrapAngle(necklace.shape->computeAngleRad(hull[*tangent_ccw]), angle_cw_rad);
+
+	const Number<Inexact> interval_length = angle_ccw_rad - angle_cw_rad;
 	if (interval_length == 0) {
-		return (*fallback_point_regions_)(extent, necklace);
-	} else if (M_2xPI <= interval_length) {
-		return (*fallback_kernel_region_)(extent, necklace);
+		return (*fallback_point_regions_)(shape, necklace);
 	} else if (interval_length < interval_length_min_rad_) {
-		return (*fallback_small_regions_)(extent, necklace);
+		return (*fallback_small_regions_)(shape, necklace);
 	}
 
-	// Force the angles into the correct interval.
-	return std::make_shared<IntervalWedge>(Modulo(obscured.from_rad()),
-	                                       ModuloNonZero(obscured.to_rad(), obscured.from_rad()));*/
-
-	// TODO debug
-	return CircularRange(0, M_2xPI);
+	return IntervalWedge(angle_cw_rad, angle_ccw_rad);
 }
 
 ComputeFeasibleWedgeInterval::ComputeFeasibleWedgeInterval(const Parameters& parameters)
@@ -37,11 +37,19 @@ namespace cartocrow::necklace_map {
 /// \f$W\f$, such that the apex of \f$W\f$ is the necklace kernel, \f$W\f$
 /// contains a map region, and the inner angle of \f$W\f$ is minimal.
 ///
-/// If the region contains the necklace kernel, the wedge interval would cover
-/// the complete plane. In this case, a centroid interval in generated instead.
+/// The wedge is determined by the two tangents from the necklace kernel to the
+/// convex hull of the region, which takes \f$O(n \log n)\f$ time for a region
+/// with \f$n\f$ vertices.
+///
+/// If the convex hull of the region contains the necklace kernel, the wedge
+/// interval would cover the complete plane. In this case, a centroid interval
+/// is generated instead. Centroid intervals are also generated for point
+/// regions and for regions whose wedge is shorter than \ref
+/// Parameters::wedge_interval_length_min_rad.
 class ComputeFeasibleWedgeInterval : public ComputeFeasibleInterval {
   public:
-	CircularRange operator()(const PolygonSet<Inexact>& shape, const Necklace& necklace) const;
+	CircularRange operator()(const PolygonSet<Inexact>& shape,
+	                         const Necklace& necklace) const override;
 	ComputeFeasibleWedgeInterval(const Parameters& parameters);
 
   private:
@@ -22,16 +22,63 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 10-09-2019
 
 #include "necklace_map.h"
 
+#include <algorithm>
+#include <cmath>
+#include <set>
 #include <stdexcept>
+#include <unordered_map>
+
+#include "detail/validate_scale_factor.h"
 
 namespace cartocrow::necklace_map {
 
+namespace {
+
+/// Moves the beads of a necklace back to the given angles, if the beads can
+/// still be placed validly from there at the given scale factor. Otherwise the
+/// beads are left at their current angles and in their current order.
+/// \return Whether the beads were moved back.
+bool restorePlacement(Necklace& necklace,
+                      const std::unordered_map<const Bead*, Number<Inexact>>& angles,
+                      const Number<Inexact>& scale_factor, const Number<Inexact>& buffer_rad) {
+	// look up all angles before changing anything
+	std::vector<Number<Inexact>> restored_angles;
+	restored_angles.reserve(necklace.beads.size());
+	for (const std::shared_ptr<Bead>& bead : necklace.beads) {
+		restored_angles.push_back(wrapAngle(angles.at(bead.get())));
+	}
+
+	const std::vector<std::shared_ptr<Bead>> current_beads = necklace.beads;
+	std::vector<Number<Inexact>> current_angles;
+	current_angles.reserve(necklace.beads.size());
+	for (size_t i = 0; i < necklace.beads.size(); ++i) {
+		current_angles.push_back(necklace.beads[i]->angle_rad);
+		necklace.beads[i]->angle_rad = restored_angles[i];
+	}
+	std::sort(necklace.beads.begin(), necklace.beads.end(),
+	          [](const std::shared_ptr<Bead>& a, const std::shared_ptr<Bead>& b) {
+		          return a->angle_rad < b->angle_rad;
+	          });
+
+	if (detail::ValidateScaleFactor(scale_factor, buffer_rad, false)(necklace)) {
+		return true;
+	}
+	necklace.beads = current_beads;
+	for (size_t i = 0; i < necklace.beads.size(); ++i) {
+		necklace.beads[i]->angle_rad = current_angles[i];
+	}
+	return false;
+}
+
+} // namespace
+
 NecklaceMap::NecklaceHandle::NecklaceHandle(size_t index) : m_index(index) {}
 
 NecklaceMap::NecklaceMap(const std::shared_ptr<RegionMap> map) : m_map(map) {}
 
 NecklaceMap::NecklaceHandle NecklaceMap::addNecklace(std::unique_ptr<NecklaceShape> shape) {
 	m_necklaces.emplace_back(std::move(shape));
+	m_computeScaleFactor = nullptr;
 	return NecklaceHandle{m_necklaces.size() - 1};
 }
 
@@ -41,6 +88,7 @@ void NecklaceMap::addBead(std::string regionName, Number<Inexact> value, Necklac
 	}
 	Necklace& necklace = m_necklaces[handle.m_index];
 	necklace.beads.push_back(std::make_shared<Bead>(&(m_map->at(regionName)), value, handle.m_index));
+	m_computeScaleFactor = nullptr;
 }
 
 Parameters& NecklaceMap::parameters() {
@@ -56,14 +104,73 @@ void NecklaceMap::compute() {
 	}
 
 	// compute the scaling factor
-	m_scaleFactor = (*ComputeScaleFactor::construct(m_parameters))(m_necklaces);
+	m_computeScaleFactor = ComputeScaleFactor::construct(m_parameters);
+	m_scaleFactor = (*m_computeScaleFactor)(m_necklaces);
 
 	// compute valid placement
-	(*ComputeValidPlacement::construct(m_parameters))(m_scaleFactor, m_necklaces);
+	m_placementCycles =
+	    (*ComputeValidPlacement::construct(m_parameters))(m_scaleFactor, m_necklaces);
+}
+
+void NecklaceMap::updateValues(const std::map<std::string, Number<Inexact>>& values) {
+	// check that all values belong to a bead before changing anything
+	std::set<std::string> updatedRegions;
+	for (const Necklace& necklace : m_necklaces) {
+		for (const std::shared_ptr<Bead>& bead : necklace.beads) {
+			if (values.contains(bead->region->name)) {
+				updatedRegions.insert(bead->region->name);
+			}
+		}
+	}
+	for (const auto& [regionName, value] : values) {
+		if (!updatedRegions.contains(regionName)) {
+			throw std::runtime_error("Tried to update value for region \"" + regionName +
+			                         "\" without bead");
+		}
+	}
+
+	// the beads keep their feasible intervals, only their size changes
+	std::unordered_map<const Bead*, Number<Inexact>> previousAngles;
+	for (Necklace& necklace : m_necklaces) {
+		for (std::shared_ptr<Bead>& bead : necklace.beads) {
+			auto value = values.find(bead->region->name);
+			if (value != values.end()) {
+				bead->radius_base = std::sqrt(value->second);
+			}
+			previousAngles[bead.get()] = bead->angle_rad;
+		}
+	}
+
+	if (!m_computeScaleFactor) {
+		compute();
+		return;
+	}
+
+	// warm-start the scaling factor from the previous optimum
+	m_scaleFactor = m_computeScaleFactor->recompute(m_necklaces);
+
+	// warm-start the placement from the previous bead angles
+	ComputeValidPlacement::Ptr computePlacement = ComputeValidPlacement::construct(m_parameters);
+	m_placementCycles = 0;
+	for (Necklace& necklace : m_necklaces) {
+		const bool restored =
+		    0 < m_scaleFactor &&
+		    restorePlacement(necklace, previousAngles, m_scaleFactor, m_parameters.buffer_rad);
+		m_placementCycles =
+		    std::max(m_placementCycles, (*computePlacement)(m_scaleFactor, necklace, restored));
+	}
 }
 
 Number<Inexact> NecklaceMap::scaleFactor() {
 	return m_scaleFactor;
 }
 
+int NecklaceMap::placementCycles() const {
+	return m_placementCycles;
+}
+
+const std::vector<Necklace>& NecklaceMap::necklaces() const {
+	return m_necklaces;
+}
+
 } // namespace cartocrow::necklace_map
@@ -23,6 +23,8 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 10-09-2019
 #ifndef CARTOCROW_NECKLACE_MAP_NECKLACE_MAP_H
 #define CARTOCROW_NECKLACE_MAP_NECKLACE_MAP_H
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include "../core/core.h"
@@ -145,10 +147,39 @@ class NecklaceMap {
 	/// after changing the parameters) to recompute the map.
 	void compute();
 
+	/// Changes the data values of some beads and updates the necklace map
+	/// accordingly.
+	///
+	/// This is intended for animating a necklace map over a series of data
+	/// values. Instead of recomputing the map from scratch, the feasible
+	/// intervals and layer assignments of the previous computation are kept,
+	/// the scale factor search starts from the previous optimum, and the
+	/// placement starts from the previous bead angles (if these still form a
+	/// valid placement). If the map has not been computed yet, or if necklaces
+	/// or beads were added since, this falls back to \ref compute().
+	///
+	/// Changing the \ref parameters() requires a call to \ref compute() to
+	/// take effect.
+	/// \param values The new data values, keyed by the \ref Region::name
+	/// "name" of the region of each bead. Throws if a name does not belong to
+	/// any bead; in that case the map is left unchanged.
+	void updateValues(const std::map<std::string, Number<Inexact>>& values);
+
 	/// Returns the scale factor of this necklace map, or `0` if the map has
 	/// not yet been computed.
 	Number<Inexact> scaleFactor();
 
+	/// Returns the number of cycles of the placement heuristic performed by
+	/// the last call to \ref compute() or \ref updateValues(), maximized
+	/// over the necklaces. This is less than \ref
+	/// Parameters::placement_cycles if the placement converged earlier (see
+	/// \ref Parameters::placement_tolerance_rad).
+	int placementCycles() const;
+
+	/// Returns the necklaces of this map, with their beads at the angles
+	/// computed by the last call to \ref compute() or \ref updateValues().
+	const std::vector<Necklace>& necklaces() const;
+
   private:
 	/// The list of regions that this necklace map is computed for.
 	const std::shared_ptr<RegionMap> m_map;
@@ -157,8 +188,14 @@ class NecklaceMap {
 	/// The computed scale factor (or 0 if the necklace map has not been
 	/// computed yet).
 	Number<Inexact> m_scaleFactor;
+	/// The number of placement cycles performed by the last computation.
+	int m_placementCycles = 0;
 	/// The computation parameters.
 	Parameters m_parameters;
+	/// The scale factor functor of the most recent computation, kept to
+	/// warm-start \ref updateValues() (or `nullptr` if the map has to be
+	/// computed from scratch).
+	std::shared_ptr<ComputeScaleFactor> m_computeScaleFactor;
 
 	friend class Painting;
 };
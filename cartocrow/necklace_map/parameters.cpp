@@ -26,7 +26,10 @@ namespace cartocrow::necklace_map {
 
 Parameters::Parameters()
     : interval_type(IntervalType::kCentroid), centroid_interval_length_rad(1),
-      ignore_point_regions(false), order_type(OrderType::kFixed), buffer_rad(0),
-      binary_search_depth(10), heuristic_cycles(5), placement_cycles(30), aversion_ratio(0) {}
+      wedge_interval_length_min_rad(0), ignore_point_regions(false),
+      order_type(OrderType::kFixed), buffer_rad(0),
+      binary_search_depth(10), heuristic_cycles(5), placement_cycles(30),
+      placement_order(PlacementOrder::kSequential), placement_tolerance_rad(1e-7),
+      aversion_ratio(0) {}
 
 } // namespace cartocrow::necklace_map
@@ -50,6 +50,18 @@ enum class OrderType {
 	kAny
 };
 
+/// The order in which the placement heuristic updates the bead positions.
+enum class PlacementOrder {
+	/// The beads are updated one after another in counterclockwise order,
+	/// each taking into account the updated position of its clockwise
+	/// neighbor (Gauss-Seidel iteration).
+	kSequential,
+	/// The beads are updated in alternating halves: first every other bead,
+	/// then the beads in between (red-black iteration). The updates within one
+	/// half do not depend on each other.
+	kRedBlack
+};
+
 /// A struct to collect the parameters used for computing the necklace map.
 ///
 /// These parameters include those needed for computing the feasible intervals,
@@ -96,6 +108,12 @@ struct Parameters {
 	/// Must be non-negative. If the number of cycles is 0, all beads are placed
 	/// in the most clockwise valid position.
 	int placement_cycles;
+	/// The order in which the placement heuristic updates the beads.
+	PlacementOrder placement_order;
+	/// The placement heuristic stops before \ref placement_cycles is reached
+	/// if in some cycle no bead moved by more than this angle in radians.
+	/// If this is 0, all cycles are performed.
+	Number<Inexact> placement_tolerance_rad;
 	/// The ratio between attraction to the interval center (0) and repulsion
 	/// from the neighboring beads (1).
 	/// This ratio must be in the range (0, 1].
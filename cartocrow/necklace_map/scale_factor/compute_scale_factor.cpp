@@ -45,11 +45,27 @@ ComputeScaleFactor::ComputeScaleFactor(const Parameters& parameters)
 }
 
 Number<Inexact> ComputeScaleFactor::operator()(std::vector<Necklace>& necklaces) {
+	return compute(necklaces, false);
+}
+
+Number<Inexact> ComputeScaleFactor::recompute(std::vector<Necklace>& necklaces) {
+	return compute(necklaces, necklace_scale_factors_.size() == necklaces.size());
+}
+
+Number<Inexact> ComputeScaleFactor::optimizeFrom(Necklace& necklace,
+                                                 const Number<Inexact>& previous_scale_factor) {
+	return (*this)(necklace);
+}
+
+Number<Inexact> ComputeScaleFactor::compute(std::vector<Necklace>& necklaces, const bool warm_start) {
 	// determine the optimal scale factor per necklace;
 	// the global optimum is the smallest of these
 	Number<Inexact> scale_factor = -1;
-	for (Necklace& necklace : necklaces) {
+	necklace_scale_factors_.resize(necklaces.size(), -1);
+	for (size_t i = 0; i < necklaces.size(); ++i) {
+		Necklace& necklace = necklaces[i];
 		if (necklace.beads.empty()) {
+			necklace_scale_factors_[i] = -1;
 			continue;
 		}
 
@@ -65,7 +81,13 @@ Number<Inexact> ComputeScaleFactor::operator()(std::vector<Necklace>& necklaces)
 			bead->radius_base /= rescale;
 		}
 
-		const Number<Inexact> necklace_scale_factor = (*this)(necklace) / rescale;
+		// Note that the previous optimum is expressed in terms of the original bead radii.
+		const Number<Inexact> necklace_scale_factor =
+		    (warm_start && 0 < necklace_scale_factors_[i]
+		         ? optimizeFrom(necklace, necklace_scale_factors_[i] * rescale)
+		         : (*this)(necklace)) /
+		    rescale;
+		necklace_scale_factors_[i] = necklace_scale_factor;
 
 		for (const std::shared_ptr<Bead>& bead : necklace.beads) {
 			bead->radius_base *= rescale;
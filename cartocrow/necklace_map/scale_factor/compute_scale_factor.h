@@ -55,12 +55,36 @@ class ComputeScaleFactor {
 	/// \return The optimal scale factor computed.
 	Number<Inexact> operator()(std::vector<Necklace>& necklaces);
 
+	/// Applies the scaler again to the same list of necklaces after the bead
+	/// values have changed. The feasible intervals of the beads must not have
+	/// changed since the previous application.
+	///
+	/// The search for each necklace is warm-started from the optimal scale
+	/// factor of that necklace in the previous application. If the scaler was
+	/// not yet applied to this list of necklaces, this is equivalent to
+	/// \ref operator()().
+	/// \return The optimal scale factor computed.
+	Number<Inexact> recompute(std::vector<Necklace>& necklaces);
+
   protected:
 	/// Constructs a new scale factor computation functor.
 	explicit ComputeScaleFactor(const Parameters& parameters);
 
+	/// Applies the scaler to the given necklace, given its optimal scale
+	/// factor before the bead values changed. By default the previous optimum
+	/// is ignored.
+	virtual Number<Inexact> optimizeFrom(Necklace& necklace,
+	                                     const Number<Inexact>& previous_scale_factor);
+
 	Number<Inexact> buffer_rad_;
 	Number<Inexact> max_buffer_rad_;
+
+  private:
+	Number<Inexact> compute(std::vector<Necklace>& necklaces, const bool warm_start);
+
+	/// The optimal scale factor per necklace in the previous application, or
+	/// -1 for necklaces without beads.
+	std::vector<Number<Inexact>> necklace_scale_factors_;
 };
 
 } // namespace cartocrow::necklace_map
@@ -49,11 +49,21 @@ ComputeScaleFactorAnyOrder::ComputeScaleFactorAnyOrder(const Parameters& paramet
       heuristic_cycles_(parameters.heuristic_cycles) {}
 
 Number<Inexact> ComputeScaleFactorAnyOrder::operator()(Necklace& necklace) {
-	detail::ComputeScaleFactorAnyOrder opt(necklace, buffer_rad_, binary_search_depth_,
-	                                       heuristic_cycles_);
-	const Number<Inexact> scale_factor = opt.Optimize();
+	auto opt = std::make_shared<detail::ComputeScaleFactorAnyOrder>(
+	    necklace, buffer_rad_, binary_search_depth_, heuristic_cycles_);
+	optimizers_[&necklace] = opt;
+	const Number<Inexact> scale_factor = opt->Optimize();
 
 	return scale_factor;
 }
 
+Number<Inexact> ComputeScaleFactorAnyOrder::optimizeFrom(Necklace& necklace,
+                                                         const Number<Inexact>& previous_scale_factor) {
+	auto opt_iter = optimizers_.find(&necklace);
+	if (opt_iter == optimizers_.end()) {
+		return (*this)(necklace);
+	}
+	return opt_iter->second->Optimize(previous_scale_factor);
+}
+
 } // namespace cartocrow::necklace_map
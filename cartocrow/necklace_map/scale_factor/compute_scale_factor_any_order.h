@@ -23,21 +23,36 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 03-03-2020
 #ifndef CARTOCROW_NECKLACE_MAP_COMPUTE_SCALE_FACTOR_ANY_ORDER_H
 #define CARTOCROW_NECKLACE_MAP_COMPUTE_SCALE_FACTOR_ANY_ORDER_H
 
+#include <memory>
+#include <unordered_map>
+
 #include "../../core/core.h"
 #include "../necklace.h"
 #include "compute_scale_factor.h"
 
 namespace cartocrow::necklace_map {
 
+namespace detail {
+class ComputeScaleFactorAnyOrder;
+} // namespace detail
+
 class ComputeScaleFactorAnyOrder : public ComputeScaleFactor {
   public:
 	explicit ComputeScaleFactorAnyOrder(const Parameters& parameters);
 
 	Number<Inexact> operator()(Necklace& necklace) override;
 
+  protected:
+	Number<Inexact> optimizeFrom(Necklace& necklace,
+	                             const Number<Inexact>& previous_scale_factor) override;
+
   private:
 	int binary_search_depth_;
 	int heuristic_cycles_;
+
+	// The optimizer of each necklace, kept to reuse its layers and task slices when the bead values change.
+	std::unordered_map<const Necklace*, std::shared_ptr<detail::ComputeScaleFactorAnyOrder>>
+	    optimizers_;
 }; // class ComputeScaleFactorAnyOrder
 
 } // namespace cartocrow::necklace_map
@@ -23,6 +23,7 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 02-04-2020
 #include "compute_scale_factor_any_order.h"
 
 #include <algorithm>
+#include <cmath>
 #include <list>
 #include <memory>
 
@@ -37,7 +38,7 @@ ComputeScaleFactorAnyOrder::ComputeScaleFactorAnyOrder(const Necklace& necklace,
                                                        const int heuristic_cycles /*= 5*/
                                                        )
     : necklace_shape_(necklace.shape), half_buffer_rad_(0.5 * buffer_rad), max_buffer_rad_(0),
-      binary_search_depth_(binary_search_depth) {
+      binary_search_depth_(binary_search_depth), num_layers_(-1) {
 	// Collect and order the beads based on the start of their valid interval (initialized as their feasible interval).
 	for (const std::shared_ptr<Bead>& bead : necklace.beads) {
 		nodes_.push_back(std::make_shared<CycleNodeLayered>(bead));
@@ -50,17 +51,10 @@ ComputeScaleFactorAnyOrder::ComputeScaleFactorAnyOrder(const Necklace& necklace,
 }
 
 Number<Inexact> ComputeScaleFactorAnyOrder::Optimize() {
-	// Assign a layer to each node such that the nodes in a layer do not overlap in their feasibile intervals.
-	const int num_layers = AssignLayers();
-
-	// The algorithm is exponential in the number of layers, so we limit this number.
-	if (kMaxLayers < num_layers) {
+	if (!Initialize()) {
 		return 0;
 	}
 
-	// Initialize the collection of task slices: collections of fixed tasks that are relevant within some angle range.
-	check_->Initialize();
-
 	// Perform a binary search on the scale factor, determining which are feasible.
 	// This binary search requires a decent initial upper bound on the scale factor.
 	Number<Inexact> lower_bound = 0;
@@ -68,9 +62,7 @@ Number<Inexact> ComputeScaleFactorAnyOrder::Optimize() {
 
 	for (int step = 0; step < binary_search_depth_; ++step) {
 		const Number<Inexact> scale_factor = 0.5 * (lower_bound + upper_bound);
-		ComputeCoveringRadii(scale_factor);
-
-		if ((*check_)()) {
+		if (IsFeasible(scale_factor)) {
 			lower_bound = scale_factor;
 		} else {
 			upper_bound = scale_factor;
@@ -83,6 +75,81 @@ Number<Inexact> ComputeScaleFactorAnyOrder::Optimize() {
 	return lower_bound;
 }
 
+Number<Inexact> ComputeScaleFactorAnyOrder::Optimize(const Number<Inexact>& warm_start) {
+	if (!Initialize()) {
+		return 0;
+	}
+
+	// The search stops at the same precision as the cold binary search.
+	Number<Inexact> lower_bound = 0;
+	Number<Inexact> upper_bound = ComputeScaleUpperBound();
+	const Number<Inexact> precision = std::ldexp(upper_bound, -binary_search_depth_);
+
+	// When the bead sizes change only slightly, the optimum stays close to the previous optimum.
+	// Bracket the optimum by a window around the previous optimum that doubles in size until it contains the optimum.
+	const Number<Inexact> start = std::min(warm_start, upper_bound);
+	if (precision < start) {
+		Number<Inexact> window = kWarmStartWindow * start;
+		if (IsFeasible(start)) {
+			lower_bound = start;
+			for (Number<Inexact> probe = start + window; probe < upper_bound;
+			     probe = lower_bound + window) {
+				if (!IsFeasible(probe)) {
+					upper_bound = probe;
+					break;
+				}
+				lower_bound = probe;
+				window *= 2;
+			}
+		} else {
+			upper_bound = start;
+			for (Number<Inexact> probe = start - window; lower_bound < probe;
+			     probe = upper_bound - window) {
+				if (IsFeasible(probe)) {
+					lower_bound = probe;
+					break;
+				}
+				upper_bound = probe;
+				window *= 2;
+			}
+		}
+	}
+
+	while (precision < upper_bound - lower_bound) {
+		const Number<Inexact> scale_factor = 0.5 * (lower_bound + upper_bound);
+		if (IsFeasible(scale_factor)) {
+			lower_bound = scale_factor;
+		} else {
+			upper_bound = scale_factor;
+		}
+	}
+
+	ComputeBufferUpperBound(lower_bound);
+	return lower_bound;
+}
+
+bool ComputeScaleFactorAnyOrder::Initialize() {
+	// The layers and task slices depend only on the valid intervals, so they are computed once and reused when the bead sizes change.
+	if (num_layers_ < 0) {
+		// Assign a layer to each node such that the nodes in a layer do not overlap in their feasibile intervals.
+		num_layers_ = AssignLayers();
+
+		// The algorithm is exponential in the number of layers, so we limit this number.
+		if (kMaxLayers < num_layers_) {
+			return false;
+		}
+
+		// Initialize the collection of task slices: collections of fixed tasks that are relevant within some angle range.
+		check_->Initialize();
+	}
+	return num_layers_ <= kMaxLayers;
+}
+
+bool ComputeScaleFactorAnyOrder::IsFeasible(const Number<Inexact>& scale_factor) {
+	ComputeCoveringRadii(scale_factor);
+	return (*check_)();
+}
+
 Number<Inexact> ComputeScaleFactorAnyOrder::ComputeScaleUpperBound() {
 	// The initial upper bound makes sure none of the beads would become too large (i.e. contain the kernel).
 	Number<Inexact> upper_bound = 0;
@@ -42,17 +42,26 @@ class ComputeScaleFactorAnyOrder {
   public:
 	constexpr static const int kMaxLayers = 15;
 
+	// The initial size of the search window around a previous optimum, relative to that optimum.
+	constexpr static const Number<Inexact> kWarmStartWindow = 0.125;
+
 	ComputeScaleFactorAnyOrder(const Necklace& necklace, Number<Inexact> buffer_rad = 0,
 	                           const int binary_search_depth = 10, const int heuristic_cycles = 5);
 
 	Number<Inexact> Optimize();
 
+	Number<Inexact> Optimize(const Number<Inexact>& warm_start);
+
   protected:
 	virtual Number<Inexact> ComputeScaleUpperBound();
 
 	virtual void ComputeCoveringRadii(const Number<Inexact>& scale_factor);
 
   private:
+	bool Initialize();
+
+	bool IsFeasible(const Number<Inexact>& scale_factor);
+
 	int AssignLayers();
 
 	void ComputeBufferUpperBound(const Number<Inexact>& scale_factor);
@@ -66,6 +75,7 @@ class ComputeScaleFactorAnyOrder {
 	Number<Inexact> max_buffer_rad_;
 
 	int binary_search_depth_;
+	int num_layers_;
 	CheckFeasible::Ptr check_;
 }; // class ComputeScaleFactorAnyOrder
 
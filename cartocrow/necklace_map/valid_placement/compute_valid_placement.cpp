@@ -22,6 +22,10 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 07-01-2020
 
 #include "compute_valid_placement.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "../circle_necklace.h"
 #include "../detail/cycle_node.h"
 #include "../necklace_interval.h"
 
@@ -34,6 +38,198 @@ inline Number<Inexact> DistanceOnCircle(const Number<Inexact>& from_rad,
 	return std::min(dist, M_2xPI - dist);
 }
 
+// The counterclockwise angle from one angle to another, in [0, 2pi).
+// Unlike wrapAngle(), this does not loop, so that it can be used in vectorized code.
+inline Number<Inexact> CounterclockwiseDistance(const Number<Inexact>& from_rad,
+                                                const Number<Inexact>& to_rad) {
+	const Number<Inexact> dist = to_rad - from_rad;
+	return dist - M_2xPI * std::floor(dist / M_2xPI);
+}
+
+// The beads of a necklace, stored as parallel arrays.
+// The beads are stored in counterclockwise order, i.e. bead i - 1 is the clockwise neighbor of bead i.
+struct PlacementState {
+	explicit PlacementState(const Necklace& necklace, const Number<Inexact>& scale_factor);
+
+	void Load(const Necklace& necklace);
+
+	void Store(Necklace& necklace) const;
+
+	size_t size() const {
+		return angle_rad.size();
+	}
+
+	std::vector<Number<Inexact>> angle_rad;
+	std::vector<Number<Inexact>> radius;
+	std::vector<Number<Inexact>> feasible_from_rad;
+	std::vector<Number<Inexact>> feasible_length_rad;
+	std::vector<Number<Inexact>> midpoint_rad;
+
+	// On circle necklaces, the angle between neighboring touching beads does not depend on where they are placed.
+	// For these necklaces, this stores the angle between the centers of beads i - 1 and i when they touch.
+	std::vector<Number<Inexact>> separation_rad;
+
+	const NecklaceShape::Ptr& shape;
+	const Number<Inexact> scale_factor;
+	const bool is_circle;
+};
+
+PlacementState::PlacementState(const Necklace& necklace, const Number<Inexact>& scale_factor)
+    : shape(necklace.shape), scale_factor(scale_factor),
+      is_circle(std::dynamic_pointer_cast<CircleNecklace>(necklace.shape) != nullptr) {
+	Load(necklace);
+}
+
+void PlacementState::Load(const Necklace& necklace) {
+	const size_t num_beads = necklace.beads.size();
+	angle_rad.resize(num_beads);
+	radius.resize(num_beads);
+	feasible_from_rad.resize(num_beads);
+	feasible_length_rad.resize(num_beads);
+	midpoint_rad.resize(num_beads);
+	for (size_t i = 0; i < num_beads; ++i) {
+		const Bead& bead = *necklace.beads[i];
+		angle_rad[i] = bead.angle_rad;
+		radius[i] = scale_factor * bead.radius_base;
+		feasible_from_rad[i] = bead.feasible.from();
+		feasible_length_rad[i] = bead.feasible.length();
+		midpoint_rad[i] = bead.feasible.midpoint();
+	}
+
+	if (is_circle) {
+		// Circle necklaces are rotationally symmetric, so the separation can be measured from any angle.
+		separation_rad.resize(num_beads);
+		for (size_t i = 0; i < num_beads; ++i) {
+			const size_t prev = (i + num_beads - 1) % num_beads;
+			separation_rad[i] = CounterclockwiseDistance(
+			    0, shape->computeAngleAtDistanceRad(0, radius[prev] + radius[i]));
+		}
+	}
+}
+
+void PlacementState::Store(Necklace& necklace) const {
+	for (size_t i = 0; i < size(); ++i) {
+		necklace.beads[i]->angle_rad = angle_rad[i];
+	}
+}
+
+// Compute the new angle of a bead, balancing the attraction to the midpoint of its feasible interval and the repulsion by its neighbors.
+// The minimum and maximum distance are the distances from the previous bead at which the bead would touch the previous and next bead, respectively.
+inline Number<Inexact> BalanceBead(const Number<Inexact>& angle_rad,
+                                   const Number<Inexact>& prev_angle_rad,
+                                   const Number<Inexact>& midpoint_rad,
+                                   const Number<Inexact>& feasible_from_rad,
+                                   const Number<Inexact>& feasible_length_rad,
+                                   const Number<Inexact>& distance_from_prev_min,
+                                   const Number<Inexact>& distance_from_prev_max,
+                                   const Number<Inexact>& aversion_ratio) {
+	const double precision = 1e-7;
+	const Number<Inexact> centroid_ratio = 1;
+
+	const Number<Inexact> offset_from_prev_rad = CounterclockwiseDistance(prev_angle_rad, angle_rad);
+	const Number<Inexact> offset_from_centroid_rad = CounterclockwiseDistance(midpoint_rad, angle_rad);
+	const auto feasible_contains = [&](const Number<Inexact>& x) {
+		return CounterclockwiseDistance(feasible_from_rad, x) <= feasible_length_rad;
+	};
+	const Number<Inexact> feasible_to_rad = feasible_from_rad + feasible_length_rad;
+
+	// The 'bubble' is the largest range centered on the bead that does not contain the centroid.
+	const Number<Inexact> offset_prev_to_bubble =
+	    offset_from_centroid_rad < M_PI ? (offset_from_prev_rad - offset_from_centroid_rad)
+	                                    : (offset_from_prev_rad + (M_2xPI - offset_from_centroid_rad));
+
+	const double w_0 =
+	    centroid_ratio * offset_prev_to_bubble * distance_from_prev_min * distance_from_prev_max -
+	    aversion_ratio * (distance_from_prev_min + distance_from_prev_max);
+	const double w_1 = aversion_ratio * 2 -
+	                   centroid_ratio * ((distance_from_prev_min + offset_prev_to_bubble) *
+	                                         (distance_from_prev_max + offset_prev_to_bubble) -
+	                                     offset_prev_to_bubble * offset_prev_to_bubble);
+	const double w_2 =
+	    centroid_ratio * (distance_from_prev_min + distance_from_prev_max + offset_prev_to_bubble);
+	const double w_3 = -centroid_ratio;
+
+	// Solve w_3 * x^3 + w_2 * x^2 + w_1 * x + w_0 = 0 up to the specified precision.
+	Number<Inexact> result_rad;
+	if (std::abs(w_3) < precision && std::abs(w_2) < precision) {
+		const Number<Inexact> x = CounterclockwiseDistance(0, -w_0 / w_1 + prev_angle_rad);
+
+		if (!feasible_contains(x)) {
+			if (0 < 2 * offset_from_prev_rad - distance_from_prev_min + distance_from_prev_max) {
+				result_rad = feasible_from_rad;
+			} else {
+				result_rad = feasible_to_rad;
+			}
+		} else {
+			result_rad = x;
+		}
+	} else {
+		const double q = (3 * w_3 * w_1 - w_2 * w_2) / (9 * w_3 * w_3);
+		const double r = (9 * w_3 * w_2 * w_1 - 27 * w_3 * w_3 * w_0 - 2 * w_2 * w_2 * w_2) /
+		                 (54 * w_3 * w_3 * w_3);
+
+		const double rho = std::max(std::sqrt(-q * q * q), std::abs(r));
+
+		const double theta_3 = std::acos(r / rho) / 3;
+		const double rho_3 = std::pow(rho, 1 / 3.0);
+
+		const Number<Inexact> x = CounterclockwiseDistance(
+		    0, prev_angle_rad - rho_3 * std::cos(theta_3) - w_2 / (3 * w_3) +
+		           rho_3 * std::sqrt(3.0) * std::sin(theta_3));
+
+		if (feasible_contains(x)) {
+			result_rad = x;
+		} else if (0 < aversion_ratio * (2 * offset_from_prev_rad -
+		                                 (distance_from_prev_min + distance_from_prev_max)) +
+		                   centroid_ratio * (offset_prev_to_bubble - offset_from_prev_rad) *
+		                       (offset_from_prev_rad - distance_from_prev_min) *
+		                       (offset_from_prev_rad - distance_from_prev_max)) {
+			result_rad = feasible_from_rad;
+		} else {
+			result_rad = feasible_to_rad;
+		}
+	}
+	return CounterclockwiseDistance(0, result_rad);
+}
+
+// Update the angle of a bead and return how far it moved.
+inline Number<Inexact> UpdateBead(PlacementState& state, const size_t i,
+                                  const Number<Inexact>& aversion_ratio,
+                                  const Number<Inexact>& buffer_rad) {
+	const size_t num_beads = state.size();
+	const size_t prev = (i + num_beads - 1) % num_beads;
+	const size_t next = (i + 1) % num_beads;
+
+	Number<Inexact> distance_from_prev_min, distance_from_prev_max;
+	if (state.is_circle) {
+		distance_from_prev_min = state.separation_rad[i] + buffer_rad;
+		distance_from_prev_max = CounterclockwiseDistance(state.angle_rad[prev],
+		                                                  state.angle_rad[next] - state.separation_rad[next]) -
+		                         buffer_rad;
+	} else {
+		distance_from_prev_min =
+		    CircularRange(state.angle_rad[prev],
+		                  state.shape->computeAngleAtDistanceRad(
+		                      state.angle_rad[prev], state.radius[prev] + state.radius[i]))
+		        .length() +
+		    buffer_rad;
+		distance_from_prev_max =
+		    CircularRange(state.angle_rad[prev],
+		                  state.shape->computeAngleAtDistanceRad(
+		                      state.angle_rad[next], -(state.radius[i] + state.radius[next])))
+		        .length() -
+		    buffer_rad;
+	}
+
+	const Number<Inexact> angle_rad =
+	    BalanceBead(state.angle_rad[i], state.angle_rad[prev], state.midpoint_rad[i],
+	                state.feasible_from_rad[i], state.feasible_length_rad[i], distance_from_prev_min,
+	                distance_from_prev_max, aversion_ratio);
+	const Number<Inexact> displacement = DistanceOnCircle(state.angle_rad[i], angle_rad);
+	state.angle_rad[i] = angle_rad;
+	return displacement;
+}
+
 } // namespace detail
 
 /**@class ComputeValidPlacement
@@ -55,16 +251,22 @@ inline Number<Inexact> DistanceOnCircle(const Number<Inexact>& from_rad,
  * @return a unique pointer containing a new functor or a nullptr if the functor could not be constructed.
  */
 ComputeValidPlacement::Ptr ComputeValidPlacement::construct(const Parameters& parameters) {
+	Ptr functor;
 	switch (parameters.order_type) {
 	case OrderType::kFixed:
-		return Ptr(new ComputeValidPlacementFixedOrder(
+		functor = Ptr(new ComputeValidPlacementFixedOrder(
 		    parameters.placement_cycles, parameters.aversion_ratio, parameters.buffer_rad));
+		break;
 	case OrderType::kAny:
-		return Ptr(new ComputeValidPlacementAnyOrder(
+		functor = Ptr(new ComputeValidPlacementAnyOrder(
 		    parameters.placement_cycles, parameters.aversion_ratio, parameters.buffer_rad));
+		break;
 	default:
 		return nullptr;
 	}
+	functor->order = parameters.placement_order;
+	functor->tolerance_rad = parameters.placement_tolerance_rad;
+	return functor;
 }
 
 /**@brief Construct a valid placement computation functor.
@@ -78,18 +280,21 @@ ComputeValidPlacement::Ptr ComputeValidPlacement::construct(const Parameters& pa
 ComputeValidPlacement::ComputeValidPlacement(const int cycles, const Number<Inexact>& aversion_ratio,
                                              const Number<Inexact>& buffer_rad /*= 0*/
                                              )
-    : cycles(cycles), aversion_ratio(aversion_ratio), buffer_rad(buffer_rad) {}
+    : cycles(cycles), aversion_ratio(aversion_ratio), buffer_rad(buffer_rad),
+      order(PlacementOrder::kSequential), tolerance_rad(0) {}
 
 /**@brief Apply the functor place the beads on a necklace.
  *
  * The beads must start in a valid placement. This valid placement is guaranteed immediately after computing the optimal scale factor of the necklace.
+ *
+ * The positioning forces are applied until either the number of cycles is reached, or no bead moved by more than the tolerance in the last cycle.
  * @param scale_factor the factor by which to multiply the radius of the beads.
  * @param necklace the necklace to which to apply the functor.
+ * @param warm_start whether to start from the current bead angles. Otherwise each bead first moves to the clockwise extreme of its valid interval. The current bead angles must form a valid placement.
+ * @return the number of cycles performed.
  */
-void ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor,
-                                       Necklace& necklace) const // TODO(tvl) factorize.
-{
-	const NecklaceShape::Ptr& necklace_shape = necklace.shape;
+int ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor, Necklace& necklace,
+                                      const bool warm_start /*= false*/) const {
 	for (const std::shared_ptr<Bead>& bead : necklace.beads) {
 		// Compute the scaled covering radius.
 		assert(bead != nullptr);
@@ -104,111 +309,51 @@ void ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor,
 
 	// Compute the valid intervals.
 	const bool adjust_angle = 0 < aversion_ratio;
-	detail::ValidateScaleFactor validate(scale_factor, buffer_rad, adjust_angle);
+	detail::ValidateScaleFactor validate(scale_factor, buffer_rad, adjust_angle && !warm_start);
 	const bool valid = validate(necklace);
 
 	if (!valid || !adjust_angle) {
-		return;
+		return 0;
 	}
 
-	const double precision = 1e-7;
-	const Number<Inexact> centroid_ratio = 1;
-
-	const size_t num_beads = necklace.beads.size();
-	for (int cycle = 0; cycle < cycles; ++cycle) {
-		for (size_t index_bead = 0; index_bead < num_beads; ++index_bead) {
-			std::shared_ptr<Bead>& bead = necklace.beads[index_bead];
-			assert(bead != nullptr);
-
-			const size_t index_prev = (index_bead + num_beads - 1) % num_beads;
-			const size_t index_next = (index_bead + 1) % num_beads;
-
-			const std::shared_ptr<Bead>& prev = necklace.beads[index_prev];
-			const std::shared_ptr<Bead>& next = necklace.beads[index_next];
-
-			const Number<Inexact> offset_from_prev_rad =
-			    CircularRange(prev->angle_rad, bead->angle_rad).length();
-			const Number<Inexact> offset_from_centroid_rad =
-			    CircularRange(bead->feasible.midpoint(), bead->angle_rad).length();
-
-			const Number<Inexact>& radius_bead = scale_factor * bead->radius_base;
-			const Number<Inexact>& radius_prev = scale_factor * prev->radius_base;
-			const Number<Inexact>& radius_next = scale_factor * next->radius_base;
-
-			const Number<Inexact> distance_from_prev_min =
-			    CircularRange(prev->angle_rad, necklace_shape->computeAngleAtDistanceRad(
-			                                       prev->angle_rad, radius_prev + radius_bead))
-			        .length() +
-			    buffer_rad;
-			const Number<Inexact> distance_from_prev_max =
-			    CircularRange(prev->angle_rad, necklace_shape->computeAngleAtDistanceRad(
-			                                       next->angle_rad, -(radius_bead + radius_next)))
-			        .length() -
-			    buffer_rad;
-
-			// The 'bubble' is the largest range centered on the bead that does not contain the centroid.
-			const Number<Inexact> offset_prev_to_bubble =
-			    offset_from_centroid_rad < M_PI
-			        ? (offset_from_prev_rad - offset_from_centroid_rad)
-			        : (offset_from_prev_rad + (M_2xPI - offset_from_centroid_rad));
-
-			const double w_0 = centroid_ratio * offset_prev_to_bubble * distance_from_prev_min *
-			                       distance_from_prev_max -
-			                   aversion_ratio * (distance_from_prev_min + distance_from_prev_max);
-			const double w_1 =
-			    aversion_ratio * 2 -
-			    centroid_ratio * ((distance_from_prev_min + offset_prev_to_bubble) *
-			                          (distance_from_prev_max + offset_prev_to_bubble) -
-			                      offset_prev_to_bubble * offset_prev_to_bubble);
-			const double w_2 = centroid_ratio * (distance_from_prev_min + distance_from_prev_max +
-			                                     offset_prev_to_bubble);
-			const double w_3 = -centroid_ratio;
-
-			// Solve w_3 * x^3 + w_2 * x^2 + w_1 * x + w_0 = 0 up to the specified precision.
-			if (std::abs(w_3) < precision && std::abs(w_2) < precision) {
-				const Number<Inexact> x = wrapAngle(-w_0 / w_1 + prev->angle_rad);
-
-				if (!bead->feasible.contains(x)) {
-					if (0 < 2 * offset_from_prev_rad - distance_from_prev_min +
-					            distance_from_prev_max) {
-						bead->angle_rad = bead->feasible.from();
-					} else {
-						bead->angle_rad = bead->feasible.to();
-					}
-				} else {
-					bead->angle_rad = x;
-				}
-			} else {
-				const double q = (3 * w_3 * w_1 - w_2 * w_2) / (9 * w_3 * w_3);
-				const double r = (9 * w_3 * w_2 * w_1 - 27 * w_3 * w_3 * w_0 - 2 * w_2 * w_2 * w_2) /
-				                 (54 * w_3 * w_3 * w_3);
-
-				const double rho = std::max(std::sqrt(-q * q * q), std::abs(r));
-
-				const double theta_3 = std::acos(r / rho) / 3;
-				const double rho_3 = std::pow(rho, 1 / 3.0);
-
-				const Number<Inexact> x =
-				    wrapAngle(prev->angle_rad - rho_3 * std::cos(theta_3) - w_2 / (3 * w_3) +
-				              rho_3 * std::sqrt(3.0) * std::sin(theta_3));
-
-				if (bead->feasible.contains(x)) {
-					bead->angle_rad = x;
-				} else if (0 < aversion_ratio * (2 * offset_from_prev_rad -
-				                                 (distance_from_prev_min + distance_from_prev_max)) +
-				                   centroid_ratio * (offset_prev_to_bubble - offset_from_prev_rad) *
-				                       (offset_from_prev_rad - distance_from_prev_min) *
-				                       (offset_from_prev_rad - distance_from_prev_max)) {
-					bead->angle_rad = bead->feasible.from();
-				} else {
-					bead->angle_rad = bead->feasible.to();
+	// Each bead is moved to the balance point of the forces of its neighbors and its feasible interval.
+	// Sequential updates use the new position of the clockwise neighbor immediately.
+	// For red-black updates, the beads are split into beads with even and odd index, so that within each group no bead is a neighbor of another.
+	// Note that for an odd number of beads, the last bead neighbors the first one, so it is updated separately.
+	detail::PlacementState state(necklace, scale_factor);
+	const size_t num_beads = state.size();
+	int cycle = 0;
+	while (cycle < cycles) {
+		++cycle;
+
+		Number<Inexact> residual_rad = 0;
+		if (order == PlacementOrder::kRedBlack) {
+			const size_t num_paired = num_beads - num_beads % 2;
+			for (size_t first : {0, 1}) {
+				for (size_t i = first; i < num_paired; i += 2) {
+					residual_rad = std::max(residual_rad,
+					                        detail::UpdateBead(state, i, aversion_ratio, buffer_rad));
 				}
 			}
-			bead->angle_rad = wrapAngle(bead->angle_rad);
+			if (num_paired < num_beads) {
+				residual_rad = std::max(
+				    residual_rad, detail::UpdateBead(state, num_beads - 1, aversion_ratio, buffer_rad));
+			}
+		} else {
+			for (size_t i = 0; i < num_beads; ++i) {
+				residual_rad =
+				    std::max(residual_rad, detail::UpdateBead(state, i, aversion_ratio, buffer_rad));
+			}
 		}
+		state.Store(necklace);
 
-		SwapBeads(necklace);
+		if (SwapBeads(necklace)) {
+			state.Load(necklace);
+		} else if (0 < tolerance_rad && residual_rad <= tolerance_rad) {
+			break;
+		}
 	}
+	return cycle;
 }
 
 /**@fn Number ComputeValidPlacement::cycles;
@@ -223,15 +368,26 @@ void ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor,
  * @brief The minimum distance (in radians on the necklace) between the beads.
  */
 
+/**@fn PlacementOrder ComputeValidPlacement::order;
+ * @brief The order in which the beads are updated.
+ */
+
+/**@fn Number ComputeValidPlacement::tolerance_rad;
+ * @brief The largest bead movement (in radians) in a cycle for which the placement is considered to have converged.
+ */
+
 /**@brief Apply the functor place the beads on a collection of necklaces.
  * @param scale_factor the factor by which to multiply the radius of the beads.
  * @param necklaces the necklaces to which to apply the functor.
+ * @return the largest number of cycles performed on any necklace.
  */
-void ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor,
-                                       std::vector<Necklace>& necklaces) const {
+int ComputeValidPlacement::operator()(const Number<Inexact>& scale_factor,
+                                      std::vector<Necklace>& necklaces) const {
+	int max_cycles = 0;
 	for (Necklace& necklace : necklaces) {
-		(*this)(scale_factor, necklace);
+		max_cycles = std::max(max_cycles, (*this)(scale_factor, necklace));
 	}
+	return max_cycles;
 }
 
 /**@class ComputeValidPlacementFixedOrder
@@ -285,7 +441,8 @@ ComputeValidPlacementAnyOrder::ComputeValidPlacementAnyOrder(const int cycles,
                                                              )
     : ComputeValidPlacement(cycles, aversion_ratio, min_separation) {}
 
-void ComputeValidPlacementAnyOrder::SwapBeads(Necklace& necklace) const {
+bool ComputeValidPlacementAnyOrder::SwapBeads(Necklace& necklace) const {
+	bool swapped = false;
 	const size_t num_beads = necklace.beads.size();
 	for (size_t index_bead = 0; index_bead < num_beads; index_bead++) {
 		const size_t index_next = (index_bead + 1) % num_beads;
@@ -327,9 +484,11 @@ void ComputeValidPlacementAnyOrder::SwapBeads(Necklace& necklace) const {
 				next->angle_rad = swapped_angle_next_rad;
 
 				std::swap(necklace.beads[index_bead], necklace.beads[index_next]);
+				swapped = true;
 			}
 		}
 	}
+	return swapped;
 }
 
 } // namespace cartocrow::necklace_map
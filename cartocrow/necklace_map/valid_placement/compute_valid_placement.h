@@ -43,9 +43,10 @@ class ComputeValidPlacement {
 	ComputeValidPlacement(const int cycles, const Number<Inexact>& aversion_ratio,
 	                      const Number<Inexact>& buffer_rad = 0);
 
-	void operator()(const Number<Inexact>& scale_factor, Necklace& necklace) const;
+	int operator()(const Number<Inexact>& scale_factor, Necklace& necklace,
+	               const bool warm_start = false) const;
 
-	void operator()(const Number<Inexact>& scale_factor, std::vector<Necklace>& necklaces) const;
+	int operator()(const Number<Inexact>& scale_factor, std::vector<Necklace>& necklaces) const;
 
 	int cycles;
 
@@ -53,8 +54,12 @@ class ComputeValidPlacement {
 
 	Number<Inexact> buffer_rad;
 
+	PlacementOrder order;
+
+	Number<Inexact> tolerance_rad;
+
   protected:
-	virtual void SwapBeads(Necklace& necklace) const = 0;
+	virtual bool SwapBeads(Necklace& necklace) const = 0;
 };
 
 class ComputeValidPlacementFixedOrder : public ComputeValidPlacement {
@@ -63,7 +68,9 @@ class ComputeValidPlacementFixedOrder : public ComputeValidPlacement {
 	                                const Number<Inexact>& min_separation = 0);
 
   protected:
-	void SwapBeads(Necklace& necklace) const override {}
+	bool SwapBeads(Necklace& necklace) const override {
+		return false;
+	}
 };
 
 class ComputeValidPlacementAnyOrder : public ComputeValidPlacement {
@@ -72,7 +79,7 @@ class ComputeValidPlacementAnyOrder : public ComputeValidPlacement {
 	                              const Number<Inexact>& min_separation = 0);
 
   protected:
-	void SwapBeads(Necklace& necklace) const override;
+	bool SwapBeads(Necklace& necklace) const override;
 };
 
 } // namespace cartocrow::necklace_map
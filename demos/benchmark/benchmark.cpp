@@ -0,0 +1,90 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<std::size_t> allocationCount = 0;
+std::atomic<std::size_t> allocatedBytes = 0;
+
+} // namespace
+
+// count all heap allocations done by the program
+void* operator new(std::size_t size) {
+	allocationCount++;
+	allocatedBytes += size;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace cartocrow::benchmark {
+
+Stopwatch::Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+double Stopwatch::lap() {
+	const auto now = std::chrono::steady_clock::now();
+	const double seconds = std::chrono::duration<double>(now - m_start).count();
+	m_start = now;
+	return seconds;
+}
+
+double Stopwatch::elapsed() const {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+Allocations allocations() {
+	return {allocationCount, allocatedBytes};
+}
+
+long peakMemoryKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+#if defined(__APPLE__)
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#else
+	return -1;
+#endif
+}
+
+} // namespace cartocrow::benchmark
@@ -0,0 +1,91 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CARTOCROW_DEMOS_BENCHMARK_H
+#define CARTOCROW_DEMOS_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+
+/// Helpers for measuring the benchmark programs.
+///
+/// Linking this replaces the global `operator new` and `operator delete` by
+/// versions that count the heap allocations of the whole program.
+namespace cartocrow::benchmark {
+
+/// Measures wall-clock time.
+///
+/// Unlike \ref cartocrow::Timer, which measures the processor time of the
+/// process, this measures elapsed real time, so that it is not inflated by
+/// work on other threads.
+class Stopwatch {
+  public:
+	/// Constructs a stopwatch and starts it.
+	Stopwatch();
+
+	/// Returns the time in seconds since the stopwatch started or the last
+	/// call to \ref lap(), and restarts it.
+	double lap();
+
+	/// Returns the time in seconds since the stopwatch started or the last
+	/// call to \ref lap().
+	double elapsed() const;
+
+  private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+/// The heap allocations done by the program.
+struct Allocations {
+	/// The number of allocations.
+	std::size_t count = 0;
+	/// The total size of the allocations, in bytes.
+	std::size_t bytes = 0;
+};
+
+/// Returns the heap allocations done by the program so far.
+Allocations allocations();
+
+/// The wall-clock time and heap allocations of a piece of code.
+struct Measurement {
+	double seconds = 0;
+	Allocations allocations;
+};
+
+/// Runs \c f and measures its wall-clock time and the heap allocations it
+/// does, including those on other threads.
+template <typename F> Measurement measure(F f) {
+	const Allocations before = allocations();
+	Stopwatch stopwatch;
+	f();
+	Measurement measurement;
+	measurement.seconds = stopwatch.elapsed();
+	const Allocations after = allocations();
+	measurement.allocations.count = after.count - before.count;
+	measurement.allocations.bytes = after.bytes - before.bytes;
+	return measurement;
+}
+
+/// Returns the peak resident set size of this process so far in KiB, or -1
+/// if this is not supported on this platform.
+long peakMemoryKiB();
+
+} // namespace cartocrow::benchmark
+
+#endif //CARTOCROW_DEMOS_BENCHMARK_H
@@ -0,0 +1,228 @@
+/*
+The Necklace Map console application implements the algorithmic
+geo-visualization method by the same name, developed by
+Bettina Speckmann and Kevin Verbeek at TU Eindhoven
+(DOI: 10.1109/TVCG.2010.180 & 10.1142/S021819591550003X).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmark for the flow map algorithms.
+//
+// Generates random inputs at several scales: places spread uniformly over a
+// square around the root, with flows drawn from a power-law (Pareto)
+// distribution, and random star-shaped polygonal obstacles that avoid the
+// places and each other. On each input, this separately times
+// SpiralTreeUnobstructedAlgorithm, ReachableRegionAlgorithm,
+// SpiralTreeObstructedAlgorithm, and the SmoothTree optimization. For each
+// step it reports the wall-clock running time, the number of handled and
+// skipped events, the peak event queue size, and the number and total size of
+// the heap allocations.
+//
+// Usage: flow_map_benchmark [repetitions] [seed] [smoothing iterations]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cartocrow/core/core.h"
+#include "cartocrow/flow_map/reachable_region_algorithm.h"
+#include "cartocrow/flow_map/smooth_tree.h"
+#include "cartocrow/flow_map/spiral_tree.h"
+#include "cartocrow/flow_map/spiral_tree_obstructed_algorithm.h"
+#include "cartocrow/flow_map/spiral_tree_unobstructed_algorithm.h"
+#include "demos/benchmark/benchmark.h"
+
+using namespace cartocrow;
+using namespace cartocrow::flow_map;
+
+namespace {
+
+/// Half of the width of the square in which the places are generated.
+constexpr Number<Inexact> kExtent = 1000;
+/// The restricting angle used for all spiral trees.
+constexpr Number<Inexact> kRestrictingAngle = 0.5061454830783556;
+
+struct Place {
+	Point<Inexact> position;
+	Number<Inexact> flow;
+};
+
+/// Generates places uniformly in the square around the root, with flows
+/// following a Pareto distribution with shape 1.5 (so a few places get most
+/// of the flow).
+std::vector<Place> generatePlaces(int count, std::mt19937& generator) {
+	std::uniform_real_distribution<Number<Inexact>> coordinate(-kExtent, kExtent);
+	std::uniform_real_distribution<Number<Inexact>> uniform(0, 1);
+	const Number<Inexact> shape = 1.5;
+	std::vector<Place> places;
+	while (places.size() < static_cast<std::size_t>(count)) {
+		Point<Inexact> position(coordinate(generator), coordinate(generator));
+		if (CGAL::squared_distance(position, Point<Inexact>(0, 0)) < 10 * 10) {
+			continue;
+		}
+		places.push_back({position, std::pow(1 - uniform(generator), -1 / shape)});
+	}
+	return places;
+}
+
+/// Generates star-shaped obstacles with 3 to 8 vertices. The obstacles keep
+/// some distance from the root, the places, and each other. Gives up early if
+/// there is no room left, so this may return fewer obstacles than requested.
+std::vector<Polygon<Inexact>> generateObstacles(int count, const std::vector<Place>& places,
+                                                std::mt19937& generator) {
+	std::uniform_real_distribution<Number<Inexact>> coordinate(-kExtent, kExtent);
+	std::uniform_real_distribution<Number<Inexact>> size(10, 60);
+	std::uniform_real_distribution<Number<Inexact>> uniform(0, 1);
+	std::uniform_int_distribution<int> vertexCount(3, 8);
+	const Number<Inexact> margin = 5;
+
+	std::vector<Polygon<Inexact>> obstacles;
+	std::vector<std::pair<Point<Inexact>, Number<Inexact>>> disks;
+	for (int attempt = 0; obstacles.size() < static_cast<std::size_t>(count) && attempt < 100 * count;
+	     attempt++) {
+		const Point<Inexact> center(coordinate(generator), coordinate(generator));
+		const Number<Inexact> radius = size(generator);
+		auto tooClose = [&](const Point<Inexact>& p, Number<Inexact> distance) {
+			return CGAL::squared_distance(center, p) < std::pow(radius + distance + margin, 2);
+		};
+		if (tooClose(Point<Inexact>(0, 0), 0) ||
+		    std::any_of(places.begin(), places.end(),
+		                [&](const Place& place) { return tooClose(place.position, 0); }) ||
+		    std::any_of(disks.begin(), disks.end(), [&](const auto& disk) {
+			    return tooClose(disk.first, disk.second);
+		    })) {
+			continue;
+		}
+
+		const int n = vertexCount(generator);
+		std::vector<Number<Inexact>> angles;
+		for (int i = 0; i < n; i++) {
+			angles.push_back(uniform(generator) * M_2xPI);
+		}
+		std::sort(angles.begin(), angles.end());
+		Polygon<Inexact> obstacle;
+		for (const Number<Inexact> angle : angles) {
+			const Number<Inexact> r = radius * (0.4 + 0.6 * uniform(generator));
+			obstacle.push_back(center + r * Vector<Inexact>(std::cos(angle), std::sin(angle)));
+		}
+		if (!obstacle.is_simple()) {
+			continue;
+		}
+		obstacles.push_back(obstacle);
+		disks.emplace_back(center, radius);
+	}
+	return obstacles;
+}
+
+std::shared_ptr<SpiralTree> makeTree(const std::vector<Place>& places,
+                                     const std::vector<Polygon<Inexact>>& obstacles) {
+	auto tree = std::make_shared<SpiralTree>(Point<Inexact>(0, 0), kRestrictingAngle);
+	for (const Place& place : places) {
+		tree->addPlace("", place.position, place.flow);
+	}
+	for (const Polygon<Inexact>& obstacle : obstacles) {
+		tree->addObstacle(obstacle);
+	}
+	tree->addShields();
+	return tree;
+}
+
+/// Measurements for one step of the computation.
+struct Measurement {
+	benchmark::Measurement resources;
+	SweepStatistics statistics;
+	/// A step-specific number: the number of tree nodes for the sweeps, and
+	/// the number of iterations for the smoothing.
+	std::size_t size = 0;
+};
+
+/// Runs `step` and measures its wall-clock running time and allocations.
+template <typename F> Measurement measure(F step) {
+	Measurement measurement;
+	measurement.resources = benchmark::measure([&] { step(measurement); });
+	return measurement;
+}
+
+void print(const std::string& step, int placeCount, int obstacleCount,
+           const Measurement& measurement) {
+	std::cout << step << "," << placeCount << "," << obstacleCount << "," << std::setprecision(6)
+	          << measurement.resources.seconds << "," << measurement.statistics.handledEvents << ","
+	          << measurement.statistics.skippedEvents << ","
+	          << measurement.statistics.peakQueueSize << ","
+	          << measurement.resources.allocations.count << ","
+	          << measurement.resources.allocations.bytes << "," << measurement.size << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	const int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+	const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+	const int smoothingIterations = argc > 3 ? std::max(0, std::atoi(argv[3])) : 100;
+
+	const std::vector<int> placeCounts = {10, 50, 200, 1000};
+	const std::vector<int> obstacleCounts = {0, 10, 50};
+
+	std::cout << "step,places,obstacles,seconds,handled_events,skipped_events,peak_queue,"
+	             "allocations,allocated_bytes,size\n";
+	for (const int placeCount : placeCounts) {
+		for (const int requestedObstacleCount : obstacleCounts) {
+			std::mt19937 generator(seed);
+			for (int repetition = 0; repetition < repetitions; repetition++) {
+				const std::vector<Place> places = generatePlaces(placeCount, generator);
+				const std::vector<Polygon<Inexact>> obstacles =
+				    generateObstacles(requestedObstacleCount, places, generator);
+				const int obstacleCount = obstacles.size();
+
+				auto unobstructedTree = makeTree(places, {});
+				print("unobstructed", placeCount, obstacleCount, measure([&](Measurement& m) {
+					      SpiralTreeUnobstructedAlgorithm algorithm(*unobstructedTree);
+					      algorithm.run();
+					      m.statistics = algorithm.statistics();
+					      m.size = unobstructedTree->nodes().size();
+				      }));
+
+				auto tree = makeTree(places, obstacles);
+				ReachableRegionAlgorithm::ReachableRegion reachableRegion;
+				print("reachable_region", placeCount, obstacleCount, measure([&](Measurement& m) {
+					      ReachableRegionAlgorithm algorithm(tree);
+					      reachableRegion = algorithm.run();
+					      m.statistics = algorithm.statistics();
+					      m.size = reachableRegion.boundary.size();
+				      }));
+				print("obstructed", placeCount, obstacleCount, measure([&](Measurement& m) {
+					      SpiralTreeObstructedAlgorithm algorithm(tree, reachableRegion);
+					      algorithm.run();
+					      m.statistics = algorithm.statistics();
+					      m.size = tree->nodes().size();
+				      }));
+
+				print("smooth_tree", placeCount, obstacleCount, measure([&](Measurement& m) {
+					      SmoothTree smoothTree(tree);
+					      SmoothTree::OptimizationOptions options;
+					      options.maxIterations = smoothingIterations;
+					      m.size = smoothTree.optimize(options).iterations;
+				      }));
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+The Necklace Map console application implements the algorithmic
+geo-visualization method by the same name, developed by
+Bettina Speckmann and Kevin Verbeek at TU Eindhoven
+(DOI: 10.1109/TVCG.2010.180 & 10.1142/S021819591550003X).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Micro-benchmark for the sweep edge intersection computations, which the
+// sweep algorithms use to compute the vanishing points of sweep intervals.
+//
+// Generates random pairs of sweep edge shapes and times
+// SweepEdgeShape::intersectOutwardsWith() and intersectInwardsWith() on them.
+// Spiral/spiral pairs are intersected in closed form; segment/spiral pairs use
+// the numerical search, and serve as a baseline. For the spiral/spiral pairs,
+// this also reports the largest angular error of the computed intersections.
+//
+// Usage: intersection_benchmark [pairs] [seed]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cartocrow/core/core.h"
+#include "cartocrow/flow_map/polar_point.h"
+#include "cartocrow/flow_map/sweep_edge.h"
+#include "demos/benchmark/benchmark.h"
+
+using namespace cartocrow;
+using namespace cartocrow::flow_map;
+
+namespace {
+
+constexpr Number<Inexact> kAlpha = 0.5061454830783556;
+
+struct Pair {
+	SweepEdgeShape first;
+	SweepEdgeShape second;
+	Number<Inexact> r;
+};
+
+/// Generates pairs of spirals of opposite types, both starting at the same
+/// radius (which is also the radius the search starts from).
+std::vector<Pair> generateSpiralPairs(int count, std::mt19937& generator) {
+	std::uniform_real_distribution<Number<Inexact>> r(1, 100);
+	std::uniform_real_distribution<Number<Inexact>> phi(-M_PI, M_PI);
+	std::vector<Pair> pairs;
+	for (int i = 0; i < count; i++) {
+		const Number<Inexact> r0 = r(generator);
+		pairs.push_back({SweepEdgeShape(SweepEdgeShape::Type::RIGHT_SPIRAL,
+		                                PolarPoint(r0, phi(generator)), kAlpha),
+		                 SweepEdgeShape(SweepEdgeShape::Type::LEFT_SPIRAL,
+		                                PolarPoint(r0, phi(generator)), kAlpha),
+		                 r0});
+	}
+	return pairs;
+}
+
+/// Generates pairs of a long segment and a spiral, both crossing the circle
+/// of the radius the search starts from.
+std::vector<Pair> generateSegmentSpiralPairs(int count, std::mt19937& generator) {
+	std::uniform_real_distribution<Number<Inexact>> r(1, 100);
+	std::uniform_real_distribution<Number<Inexact>> phi(-M_PI, M_PI);
+	std::vector<Pair> pairs;
+	for (int i = 0; i < count; i++) {
+		const Number<Inexact> r0 = r(generator);
+		const Number<Inexact> phi0 = phi(generator);
+		pairs.push_back({SweepEdgeShape(PolarPoint(r0 / 10, phi0 - 1),
+		                                PolarPoint(r0 * 10, phi0 + 1)),
+		                 SweepEdgeShape(SweepEdgeShape::Type::LEFT_SPIRAL,
+		                                PolarPoint(r0, phi(generator)), kAlpha),
+		                 r0});
+	}
+	return pairs;
+}
+
+/// Times intersecting all pairs and prints the results.
+void run(const std::string& name, const std::vector<Pair>& pairs, bool outwards) {
+	int found = 0;
+	Number<Inexact> maxError = 0;
+	benchmark::Stopwatch stopwatch;
+	for (const Pair& pair : pairs) {
+		const std::optional<Number<Inexact>> r =
+		    outwards ? pair.first.intersectOutwardsWith(pair.second, pair.r)
+		             : pair.first.intersectInwardsWith(pair.second, pair.r);
+		if (r) {
+			found++;
+		}
+	}
+	const double seconds = stopwatch.elapsed();
+
+	// the error check is not part of the timing
+	for (const Pair& pair : pairs) {
+		const std::optional<Number<Inexact>> r =
+		    outwards ? pair.first.intersectOutwardsWith(pair.second, pair.r)
+		             : pair.first.intersectInwardsWith(pair.second, pair.r);
+		if (r) {
+			const Number<Inexact> error =
+			    wrapAngle(pair.first.phiForR(*r) - pair.second.phiForR(*r), -M_PI);
+			maxError = std::max(maxError, std::abs(error));
+		}
+	}
+
+	std::cout << name << "," << (outwards ? "outwards" : "inwards") << "," << pairs.size() << ","
+	          << found << "," << std::setprecision(6) << seconds << ","
+	          << seconds * 1e9 / pairs.size() << "," << maxError << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+	const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+
+	std::mt19937 generator(seed);
+	const std::vector<Pair> spiralPairs = generateSpiralPairs(count, generator);
+	const std::vector<Pair> segmentSpiralPairs = generateSegmentSpiralPairs(count, generator);
+
+	std::cout << "pair,direction,pairs,intersections,seconds,ns_per_pair,max_phi_error\n";
+	for (const bool outwards : {true, false}) {
+		run("spiral_spiral", spiralPairs, outwards);
+		run("segment_spiral", segmentSpiralPairs, outwards);
+	}
+	return 0;
+}
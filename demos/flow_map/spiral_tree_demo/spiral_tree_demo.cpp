@@ -175,10 +175,12 @@ void SpiralTreeDemo::recalculate() {
 	m_renderer->clear();
 	if (m_obstacleBox->isChecked()) {
 		ReachableRegionAlgorithm reachableRegionAlg(tree);
+		reachableRegionAlg.setDebugOutput(true);
 		ReachableRegionAlgorithm::ReachableRegion reachableRegion = reachableRegionAlg.run();
 		t.stamp("Computing reachable region");
 
 		SpiralTreeObstructedAlgorithm spiralTreeAlg(tree, reachableRegion);
+		spiralTreeAlg.setDebugOutput(true);
 		spiralTreeAlg.run();
 		t.stamp("Computing spiral tree");
 
@@ -186,6 +188,7 @@ void SpiralTreeDemo::recalculate() {
 		m_renderer->addPainting(spiralTreeAlg.debugPainting(), "Spiral tree sweep");
 	} else {
 		SpiralTreeUnobstructedAlgorithm spiralTreeAlg(*tree);
+		spiralTreeAlg.setDebugOutput(true);
 		spiralTreeAlg.run();
 		t.stamp("Computing spiral tree");
 
@@ -0,0 +1,347 @@
+/*
+The CartoCrow library implements algorithmic geo-visualization methods,
+developed at TU Eindhoven.
+Copyright (C) 2024 TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmark for the isoline simplification algorithm.
+//
+// Generates synthetic contour sets of roughly 10k, 100k and 1M vertices by
+// running marching squares over a fractal value noise field, at several
+// levels. On each contour set, this runs IsolineSimplifier with each ladder
+// collapse strategy, simplifying to a tenth of the input vertices. For each
+// run it reports the wall-clock time of constructing the simplifier, which
+// does the preprocessing (segment Delaunay graph, separator, matching, slope
+// ladders), and of the simplification, the symmetric difference with the
+// input, and the peak memory usage of the process so far.
+//
+// The symmetric difference is reported twice: the upper bound maintained
+// during simplification, and the exact value computed afterwards. The latter
+// uses exact polygon operations, so it is skipped (-1) for inputs above
+// 100k vertices.
+//
+// Usage: isoline_simplification_benchmark [repetitions] [seed] [max vertices] [threads]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cartocrow/core/core.h"
+#include "cartocrow/isoline_simplification/collapse.h"
+#include "cartocrow/isoline_simplification/isoline.h"
+#include "cartocrow/isoline_simplification/isoline_simplifier.h"
+#include "demos/benchmark/benchmark.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+
+/// The number of octaves of noise; each has twice the frequency and half the
+/// amplitude of the previous one.
+constexpr int kOctaves = 5;
+/// The number of grid cells per unit of the coarsest noise lattice, such
+/// that the finest octave spans four grid cells.
+constexpr int kResolution = 64;
+/// The number of contour levels.
+constexpr int kLevels = 10;
+/// Contours with fewer vertices than this are dropped.
+constexpr int kMinimumVertices = 8;
+/// The fraction of the input vertices that is kept by the simplification.
+constexpr double kTargetFraction = 0.1;
+/// The largest input for which the exact symmetric difference is computed.
+constexpr int kExactErrorLimit = 100000;
+
+/// Returns a pseudo-random value in [0, 1) for lattice point (i, j).
+double latticeValue(std::int64_t i, std::int64_t j, std::uint64_t seed) {
+	std::uint64_t h = seed ^ (static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ULL) ^
+	                  (static_cast<std::uint64_t>(j) * 0xC2B2AE3D27D4EB4FULL);
+	// finaliser of SplitMix64
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBULL;
+	h ^= h >> 31;
+	return static_cast<double>(h >> 11) / static_cast<double>(1ULL << 53);
+}
+
+/// Interpolates the lattice values smoothly.
+double valueNoise(double x, double y, std::uint64_t seed) {
+	const double x0 = std::floor(x);
+	const double y0 = std::floor(y);
+	const auto i = static_cast<std::int64_t>(x0);
+	const auto j = static_cast<std::int64_t>(y0);
+	auto smooth = [](double t) {
+		return t * t * (3 - 2 * t);
+	};
+	const double sx = smooth(x - x0);
+	const double sy = smooth(y - y0);
+	const double bottom = latticeValue(i, j, seed) * (1 - sx) + latticeValue(i + 1, j, seed) * sx;
+	const double top = latticeValue(i, j + 1, seed) * (1 - sx) + latticeValue(i + 1, j + 1, seed) * sx;
+	return bottom * (1 - sy) + top * sy;
+}
+
+double fractalNoise(double x, double y, std::uint64_t seed) {
+	double value = 0;
+	double amplitude = 1;
+	double frequency = 1;
+	for (int octave = 0; octave < kOctaves; octave++) {
+		value += amplitude * valueNoise(x * frequency, y * frequency, seed + octave);
+		amplitude /= 2;
+		frequency *= 2;
+	}
+	return value;
+}
+
+/// A noise field sampled on a square grid of \c kResolution cells per
+/// lattice unit.
+struct Field {
+	int size;
+	std::vector<double> values;
+
+	Field(int size, std::uint64_t seed) : size(size), values(static_cast<std::size_t>(size) * size) {
+		for (int j = 0; j < size; j++) {
+			for (int i = 0; i < size; i++) {
+				values[index(i, j)] = fractalNoise(static_cast<double>(i) / kResolution,
+				                                   static_cast<double>(j) / kResolution, seed);
+			}
+		}
+	}
+
+	std::size_t index(int i, int j) const {
+		return static_cast<std::size_t>(j) * size + i;
+	}
+
+	double at(int i, int j) const {
+		return values[index(i, j)];
+	}
+};
+
+/// Traces the contours of the field at the given level with marching
+/// squares, and appends those with at least \c kMinimumVertices vertices.
+///
+/// Grid cells are unit squares. Contour vertices lie on the grid edges and
+/// are shared by the two cells next to the edge, which is how the pieces are
+/// stitched together. Saddle cells are resolved by the value at the cell
+/// center, which keeps the contours of one level disjoint; contours of
+/// different levels are disjoint anyway.
+void traceContours(const Field& field, double level, std::vector<Isoline<K>>& isolines) {
+	struct Crossing {
+		Point<K> point;
+		std::int64_t neighbors[2] = {-1, -1};
+		bool visited = false;
+	};
+	std::unordered_map<std::int64_t, Crossing> crossings;
+	// the crossings in order of creation, so the result does not depend on the hash map
+	std::vector<std::int64_t> order;
+
+	auto horizontal = [&](int i, int j) {
+		return 2 * static_cast<std::int64_t>(field.index(i, j));
+	};
+	auto vertical = [&](int i, int j) {
+		return 2 * static_cast<std::int64_t>(field.index(i, j)) + 1;
+	};
+	auto crossing = [&](std::int64_t id) -> Crossing& {
+		auto [it, inserted] = crossings.try_emplace(id);
+		if (inserted) {
+			const int i = static_cast<int>((id / 2) % field.size);
+			const int j = static_cast<int>((id / 2) / field.size);
+			const int di = id % 2 == 0 ? 1 : 0;
+			const double a = field.at(i, j);
+			const double b = field.at(i + di, j + 1 - di);
+			// keeps crossings on different edges of a grid vertex apart
+			const double t = std::clamp((level - a) / (b - a), 1E-3, 1 - 1E-3);
+			it->second.point = Point<K>(i + di * t, j + (1 - di) * t);
+			order.push_back(id);
+		}
+		return it->second;
+	};
+	auto link = [&](std::int64_t id1, std::int64_t id2) {
+		Crossing& c1 = crossing(id1);
+		c1.neighbors[c1.neighbors[0] == -1 ? 0 : 1] = id2;
+		Crossing& c2 = crossing(id2);
+		c2.neighbors[c2.neighbors[0] == -1 ? 0 : 1] = id1;
+	};
+
+	for (int j = 0; j + 1 < field.size; j++) {
+		for (int i = 0; i + 1 < field.size; i++) {
+			// corners and edges in counter-clockwise order, starting at the bottom left and the bottom
+			const bool above[4] = {field.at(i, j) > level, field.at(i + 1, j) > level,
+			                       field.at(i + 1, j + 1) > level, field.at(i, j + 1) > level};
+			const std::int64_t edges[4] = {horizontal(i, j), vertical(i + 1, j), horizontal(i, j + 1),
+			                               vertical(i, j)};
+			const int count = above[0] + above[1] + above[2] + above[3];
+			if (count == 0 || count == 4) {
+				continue;
+			}
+			if (count == 2 && above[0] == above[2]) {
+				// saddle: cut off the two corners on the other side of the level than the center
+				const double center =
+				    (field.at(i, j) + field.at(i + 1, j) + field.at(i + 1, j + 1) + field.at(i, j + 1)) / 4;
+				const int corner = above[0] != (center > level) ? 0 : 1;
+				link(edges[(corner + 3) % 4], edges[corner]);
+				link(edges[(corner + 1) % 4], edges[(corner + 2) % 4]);
+				continue;
+			}
+			// the level crosses exactly two edges
+			std::int64_t ends[2];
+			int found = 0;
+			for (int e = 0; e < 4; e++) {
+				if (above[e] != above[(e + 1) % 4]) {
+					ends[found++] = edges[e];
+				}
+			}
+			link(ends[0], ends[1]);
+		}
+	}
+
+	auto trace = [&](std::int64_t start) {
+		std::vector<Point<K>> points;
+		std::int64_t previous = -1;
+		std::int64_t current = start;
+		bool closed = false;
+		while (true) {
+			Crossing& c = crossings.at(current);
+			c.visited = true;
+			points.push_back(c.point);
+			const std::int64_t next = c.neighbors[0] != previous ? c.neighbors[0] : c.neighbors[1];
+			if (next == start) {
+				closed = true;
+				break;
+			}
+			if (next == -1 || crossings.at(next).visited) {
+				break;
+			}
+			previous = current;
+			current = next;
+		}
+		if (points.size() >= kMinimumVertices) {
+			isolines.emplace_back(points, closed);
+		}
+	};
+	// contours that end at the boundary of the grid, and then the closed ones
+	for (const std::int64_t id : order) {
+		const Crossing& c = crossings.at(id);
+		if (!c.visited && c.neighbors[1] == -1) {
+			trace(id);
+		}
+	}
+	for (const std::int64_t id : order) {
+		if (!crossings.at(id).visited) {
+			trace(id);
+		}
+	}
+}
+
+std::vector<Isoline<K>> contours(int size, std::uint64_t seed) {
+	const Field field(size, seed);
+	const auto [lowest, highest] = std::minmax_element(field.values.begin(), field.values.end());
+	std::vector<Isoline<K>> isolines;
+	for (int l = 0; l < kLevels; l++) {
+		traceContours(field, *lowest + (*highest - *lowest) * (l + 1) / (kLevels + 1), isolines);
+	}
+	return isolines;
+}
+
+int vertexCount(const std::vector<Isoline<K>>& isolines) {
+	int count = 0;
+	for (const Isoline<K>& isoline : isolines) {
+		count += isoline.m_points.size();
+	}
+	return count;
+}
+
+/// Generates contours with approximately the given number of vertices. At a
+/// fixed resolution, the number of vertices grows with the area of the field,
+/// so the grid size is adjusted by the square root of the ratio.
+std::vector<Isoline<K>> generateContours(int targetVertices, std::uint64_t seed) {
+	int size = 4 * kResolution;
+	std::vector<Isoline<K>> isolines = contours(size, seed);
+	for (int attempt = 0; attempt < 3; attempt++) {
+		const int count = vertexCount(isolines);
+		if (count > 0 && std::abs(count - targetVertices) < 0.05 * targetVertices) {
+			break;
+		}
+		size = std::max(16, static_cast<int>(std::lround(
+		                        size * std::sqrt(static_cast<double>(targetVertices) / std::max(count, 1)))));
+		isolines = contours(size, seed);
+	}
+	return isolines;
+}
+
+struct Strategy {
+	std::string name;
+	std::function<std::shared_ptr<LadderCollapse>()> make;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	const int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1;
+	const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+	const int maxVertices = argc > 3 ? std::atoi(argv[3]) : 1000000;
+	const int threads = argc > 4 ? std::max(0, std::atoi(argv[4])) : 1;
+
+	const std::vector<int> vertexCounts = {10000, 100000, 1000000};
+	const std::vector<Strategy> strategies = {
+	    {"midpoint", [] { return std::make_shared<MidpointCollapse>(); }},
+	    {"min_sym_diff", [] { return std::make_shared<MinSymDiffCollapse>(); }},
+	    {"harmony_line", [] { return std::make_shared<HarmonyLineCollapse>(15); }},
+	    {"spline", [] { return std::make_shared<SplineCollapse>(3, 15); }},
+	    {"line_spline_hybrid",
+	     [] {
+		     return std::make_shared<LineSplineHybridCollapse>(SplineCollapse(3, 15),
+		                                                       HarmonyLineCollapse(15));
+	     }},
+	};
+
+	std::cout << "collapse,vertices,isolines,threads,construction_s,simplify_s,simplified_vertices,"
+	             "area_error,symmetric_difference,peak_kib\n";
+	for (const int requestedVertices : vertexCounts) {
+		if (requestedVertices > maxVertices) {
+			continue;
+		}
+		for (int repetition = 0; repetition < repetitions; repetition++) {
+			// every strategy sees the same contours for a given seed and repetition
+			const std::vector<Isoline<K>> isolines = generateContours(requestedVertices, seed + repetition);
+			const int vertices = vertexCount(isolines);
+			for (const Strategy& strategy : strategies) {
+				benchmark::Stopwatch stopwatch;
+				IsolineSimplifier simplifier(isolines, threads, strategy.make());
+				const double constructionSeconds = stopwatch.lap();
+				simplifier.simplify(static_cast<int>(kTargetFraction * vertices));
+				const double simplifySeconds = stopwatch.lap();
+
+				const double symmetricDifference =
+				    vertices <= kExactErrorLimit ? simplifier.total_symmetric_difference() : -1;
+				std::cout << strategy.name << "," << vertices << "," << isolines.size() << "," << threads
+				          << "," << std::setprecision(6) << constructionSeconds << "," << simplifySeconds << ","
+				          << simplifier.m_current_complexity << ","
+				          << std::setprecision(9) << simplifier.m_area_error << "," << symmetricDifference
+				          << "," << benchmark::peakMemoryKiB() << std::endl;
+			}
+		}
+	}
+	return 0;
+}
@@ -184,7 +184,7 @@ IsolineSimplificationDemo::IsolineSimplificationDemo() {
 			auto separator_p = std::make_shared<MedialAxisSeparatorPainting>(
 			    m_isoline_simplifier->m_separator, m_isoline_simplifier->m_delaunay);
 			auto slope_ladder_p =
-			    std::make_shared<SlopeLadderPainting>(m_isoline_simplifier->m_slope_ladders);
+			    std::make_shared<SlopeLadderPainting>(*m_isoline_simplifier);
 			auto matching_p =
 			    std::make_shared<CompleteMatchingPainting>(m_isoline_simplifier->m_matching);
 
@@ -351,12 +351,12 @@ IsolineSimplificationDemo::IsolineSimplificationDemo() {
 	connect(save_button, &QPushButton::clicked, m_save);
 	connect(m_renderer, &GeometryWidget::clicked, [this, debug_text, debugInfo](auto pt) {
 		if (!debugInfo->isChecked()) return;
-		auto it = std::find_if(m_isoline_simplifier->m_slope_ladders.begin(), m_isoline_simplifier->m_slope_ladders.end(), [&pt](const std::shared_ptr<SlopeLadder>& ladder) {
-			if (ladder->m_old) return false;
+		const auto ladders = m_isoline_simplifier->pending_ladders();
+		auto it = std::find_if(ladders.begin(), ladders.end(), [&pt](const std::shared_ptr<SlopeLadder>& ladder) {
 			auto poly = slope_ladder_polygon(*ladder);
 			return poly.has_on_bounded_side(pt);
 		});
-		if (it == m_isoline_simplifier->m_slope_ladders.end() || *it == m_debug_ladder) {
+		if (it == ladders.end() || *it == m_debug_ladder) {
 			m_debug_ladder = std::nullopt;
 			debug_text->setText("");
 		} else {
@@ -392,7 +392,7 @@ void IsolineSimplificationDemo::recalculate(bool debugInfo, bool show_vertices,
 
 	auto separator_p = std::make_shared<MedialAxisSeparatorPainting>(separator, m_isoline_simplifier->m_delaunay);
 	auto matching_p = std::make_shared<CompleteMatchingPainting>(m_isoline_simplifier->m_matching);
-	auto slope_ladder_p = std::make_shared<SlopeLadderPainting>(m_isoline_simplifier->m_slope_ladders);
+	auto slope_ladder_p = std::make_shared<SlopeLadderPainting>(*m_isoline_simplifier);
 	auto collapse_p = std::make_shared<CollapsePainting>(*m_isoline_simplifier);
 
 	if (debugInfo) {
@@ -505,8 +505,8 @@ void MatchingPainting::paint(GeometryRenderer& renderer) const {
 	}
 }
 
-SlopeLadderPainting::SlopeLadderPainting(const Heap& slope_ladders):
-      m_slope_ladders(slope_ladders) {}
+SlopeLadderPainting::SlopeLadderPainting(const IsolineSimplifier& simplifier):
+      m_simplifier(simplifier) {}
 
 Polygon<K> slope_ladder_polygon(const SlopeLadder& slope_ladder) {
 	std::vector<Point<K>> pts;
@@ -560,8 +560,7 @@ void draw_ladder_collapse(GeometryRenderer& renderer, IsolineSimplifier& simplif
 
 void SlopeLadderPainting::paint(GeometryRenderer& renderer) const {
 	std::unordered_set<Segment<K>> edges;
-	for (const auto& slope_ladder : m_slope_ladders) {
-		if (slope_ladder->m_old) continue;
+	for (const auto& slope_ladder : m_simplifier.pending_ladders()) {
 		auto poly = slope_ladder_polygon(*slope_ladder);
 		for (auto eit = poly.edges_begin(); eit != poly.edges_end(); eit++) {
 			Segment<K> e = *eit;
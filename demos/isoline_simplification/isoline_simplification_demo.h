@@ -120,13 +120,13 @@ class CompleteMatchingPainting : public GeometryPainting {
 
 class SlopeLadderPainting : public GeometryPainting {
   public:
-	SlopeLadderPainting(const Heap& slope_ladders);
+	SlopeLadderPainting(const IsolineSimplifier& simplifier);
 
   protected:
 	void paint(GeometryRenderer& renderer) const override;
 
   private:
-	const Heap& m_slope_ladders;
+	const IsolineSimplifier& m_simplifier;
 };
 
 class CollapsePainting : public GeometryPainting {
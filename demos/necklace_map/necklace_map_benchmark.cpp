@@ -0,0 +1,179 @@
+/*
+The Necklace Map console application implements the algorithmic
+geo-visualization method by the same name, developed by
+Bettina Speckmann and Kevin Verbeek at TU Eindhoven
+(DOI: 10.1109/TVCG.2010.180 & 10.1142/S021819591550003X).
+Copyright (C) 2021  Netherlands eScience Center and TU Eindhoven
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmark for the necklace map scale factor solvers.
+//
+// Generates synthetic circular necklaces where each point of the necklace is
+// covered by a controlled number of feasible intervals (the overlap depth),
+// and runs the fixed-order solver, the exact any-order solver and the
+// heuristic any-order solver on them. For each run, this reports the
+// wall-clock running time, the number of feasibility checks (dynamic program
+// invocations), the number of layers, and the number and total size of the
+// heap allocations done by the solver. The last column is the peak resident
+// set size of the process so far; it never decreases, so it only says
+// something about the largest input run up to that point.
+//
+// Usage: necklace_map_benchmark [repetitions] [seed]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cartocrow/core/core.h"
+#include "cartocrow/necklace_map/bead.h"
+#include "cartocrow/necklace_map/circle_necklace.h"
+#include "cartocrow/necklace_map/necklace.h"
+#include "cartocrow/necklace_map/parameters.h"
+#include "cartocrow/necklace_map/scale_factor/detail/compute_scale_factor_any_order.h"
+#include "cartocrow/necklace_map/scale_factor/detail/compute_scale_factor_fixed_order.h"
+#include "demos/benchmark/benchmark.h"
+
+using namespace cartocrow;
+using namespace cartocrow::necklace_map;
+
+namespace {
+
+/// An any-order solver that counts how often the feasibility check runs.
+///
+/// Each feasibility check recomputes the covering radii before running the
+/// dynamic program, so counting the former counts the latter.
+class CountingAnyOrderSolver : public detail::ComputeScaleFactorAnyOrder {
+  public:
+	CountingAnyOrderSolver(const Necklace& necklace, const int heuristic_cycles)
+	    : detail::ComputeScaleFactorAnyOrder(necklace, 0, 10, heuristic_cycles) {}
+
+	int invocations() const {
+		return m_invocations;
+	}
+
+	int layers() const {
+		return num_layers_;
+	}
+
+  protected:
+	void ComputeCoveringRadii(const Number<Inexact>& scale_factor) override {
+		++m_invocations;
+		detail::ComputeScaleFactorAnyOrder::ComputeCoveringRadii(scale_factor);
+	}
+
+  private:
+	int m_invocations = 0;
+};
+
+/// Generates a circular necklace with \c num_beads beads.
+///
+/// The feasible intervals are spread evenly over the necklace (with some
+/// jitter) and have a length such that every angle is covered by roughly
+/// \c overlap_depth intervals.
+Necklace generateNecklace(const int num_beads, const int overlap_depth, std::mt19937& generator) {
+	Necklace necklace(
+	    std::make_shared<CircleNecklace>(Circle<Inexact>(Point<Inexact>(0, 0), 100 * 100)));
+
+	const Number<Inexact> spacing_rad = M_2xPI / num_beads;
+	const Number<Inexact> length_rad = std::min(overlap_depth * spacing_rad, M_2xPI);
+	std::uniform_real_distribution<Number<Inexact>> jitter(-0.25 * spacing_rad, 0.25 * spacing_rad);
+	std::uniform_real_distribution<Number<Inexact>> value(1, 10);
+
+	for (int i = 0; i < num_beads; ++i) {
+		auto bead = std::make_shared<Bead>(nullptr, value(generator), 0);
+		const Number<Inexact> from_rad = i * spacing_rad + jitter(generator);
+		bead->feasible = CircularRange(from_rad, from_rad + length_rad);
+		necklace.beads.push_back(bead);
+	}
+	necklace.sortBeads();
+	return necklace;
+}
+
+struct Result {
+	benchmark::Measurement measurement;
+	Number<Inexact> scale_factor = 0;
+	int invocations = 0;
+	int layers = 0;
+};
+
+Result runFixedOrder(Necklace& necklace) {
+	Result result;
+	result.measurement = benchmark::measure([&] {
+		detail::ComputeScaleFactorFixedOrder solver(necklace);
+		result.scale_factor = solver.Optimize();
+	});
+	return result;
+}
+
+Result runAnyOrder(Necklace& necklace, const int heuristic_cycles) {
+	Result result;
+	result.measurement = benchmark::measure([&] {
+		CountingAnyOrderSolver solver(necklace, heuristic_cycles);
+		result.scale_factor = solver.Optimize();
+		result.invocations = solver.invocations();
+		result.layers = solver.layers();
+	});
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	const int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+	const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42;
+
+	const std::vector<int> bead_counts = {16, 64, 256, 1024};
+	const std::vector<int> overlap_depths = {1, 2, 3, 4, 6};
+
+	struct Configuration {
+		std::string name;
+		OrderType order_type;
+		int heuristic_cycles;
+	};
+	const std::vector<Configuration> configurations = {
+	    {"fixed", OrderType::kFixed, 0},
+	    {"any-exact", OrderType::kAny, 0},
+	    {"any-heuristic", OrderType::kAny, 5},
+	};
+
+	std::cout << "solver,beads,overlap,layers,scale_factor,seconds,dp_invocations,allocations,"
+	             "allocated_bytes,process_peak_kib\n";
+	for (const Configuration& configuration : configurations) {
+		for (const int num_beads : bead_counts) {
+			for (const int overlap_depth : overlap_depths) {
+				// Every configuration sees the same necklaces for a given seed.
+				std::mt19937 generator(seed);
+				for (int repetition = 0; repetition < repetitions; ++repetition) {
+					Necklace necklace = generateNecklace(num_beads, overlap_depth, generator);
+					const Result result = configuration.order_type == OrderType::kFixed
+					                          ? runFixedOrder(necklace)
+					                          : runAnyOrder(necklace, configuration.heuristic_cycles);
+					std::cout << configuration.name << "," << num_beads << "," << overlap_depth << ","
+					          << result.layers << "," << std::setprecision(9) << result.scale_factor
+					          << "," << std::setprecision(6) << result.measurement.seconds << ","
+					          << result.invocations << "," << result.measurement.allocations.count
+					          << "," << result.measurement.allocations.bytes << ","
+					          << benchmark::peakMemoryKiB() << std::endl;
+				}
+			}
+		}
+	}
+	return 0;
+}
@@ -36,8 +36,10 @@ Created by tvl (t.vanlankveld@esciencecenter.nl) on 10-09-2019
 #include "cartocrow/flow_map/spiral_tree.h"
 #include "cartocrow/flow_map/spiral_tree_unobstructed_algorithm.h"
 #include "cartocrow/isoline_simplification/ipe_isolines.h"
+#include "cartocrow/isoline_simplification/isoline_io.h"
 #include "cartocrow/isoline_simplification/isoline_simplifier.h"
 #include "cartocrow/isoline_simplification/simple_isoline_painting.h"
+#include "cartocrow/isoline_simplification/tiled_simplification.h"
 #include "cartocrow/simplesets/parse_input.h"
 #include "cartocrow/simplesets/settings.h"
 #include "cartocrow/simplesets/partition_algorithm.h"
@@ -121,6 +123,7 @@ int main(int argc, char* argv[]) {
 		tree->addShields();
 
 		flow_map::SpiralTreeUnobstructedAlgorithm algorithm(*tree);
+		algorithm.setDebugOutput(true);
 		algorithm.run();
 		debugPainting = algorithm.debugPainting();
 
@@ -128,11 +131,23 @@ int main(int argc, char* argv[]) {
 		painting = std::make_shared<flow_map::Painting>(map_ptr, tree, options);
 
 	} else if (projectData["type"] == "isoline_simplification") {
-		auto isolines = isoline_simplification::ipeToIsolines(projectFilename.parent_path() / projectData["isolines"]);
-		isoline_simplification::IsolineSimplifier simplifier(isolines);
+		auto isolines = isoline_simplification::readIsolines(projectFilename.parent_path() / projectData["isolines"]);
 		int target = projectData["target"];
-		simplifier.simplify(target);
-		painting = std::make_shared<isoline_simplification::SimpleIsolinePainting>(simplifier.m_simplified_isolines);
+		if (projectData.contains("tile_size")) {
+			double tileSize = projectData["tile_size"];
+			// tiled_simplify enlarges this if the isolines have longer edges crossing tile boundaries
+			double tileMargin = projectData.value("tile_margin", tileSize / 10);
+			auto simplified = isoline_simplification::tiled_simplify(isolines, target, tileSize, tileMargin);
+			painting = std::make_shared<isoline_simplification::SimpleIsolinePainting>(simplified);
+		} else {
+			isoline_simplification::IsolineSimplifier simplifier(isolines);
+			if (projectData.contains("batch_size")) {
+				simplifier.simplify_batched(target, projectData["batch_size"]);
+			} else {
+				simplifier.simplify(target);
+			}
+			painting = std::make_shared<isoline_simplification::SimpleIsolinePainting>(simplifier.m_simplified_isolines);
+		}
 	} else if (projectData["type"] == "simplesets") {
 		// Parse points
 		auto filePath = projectFilename.parent_path() / projectData["points"];
@@ -0,0 +1,49 @@
+#include "../catch.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include "cartocrow/core/parallel.h"
+
+using namespace cartocrow;
+
+TEST_CASE("Running a loop in parallel") {
+	const int count = 1000;
+	std::vector<int> expected(count);
+	for (int i = 0; i < count; i++) {
+		expected[i] = i * i;
+	}
+
+	for (int threadCount : {1, 2, 7, 0}) {
+		std::vector<int> result(count, -1);
+		std::vector<int> calls(count, 0);
+		parallel_for(count, threadCount, [&](int i) {
+			result[i] = i * i;
+			calls[i]++;
+		});
+		CHECK(result == expected);
+		CHECK(calls == std::vector<int>(count, 1));
+	}
+
+	SECTION("without indices") {
+		bool called = false;
+		parallel_for(0, 4, [&](int) { called = true; });
+		CHECK_FALSE(called);
+	}
+
+	SECTION("with an exception") {
+		CHECK_THROWS_AS(parallel_for(count, 4,
+		                             [](int i) {
+			                             if (i == 500) {
+				                             throw std::runtime_error("failed");
+			                             }
+		                             }),
+		                std::runtime_error);
+	}
+}
+
+TEST_CASE("Determining the number of threads") {
+	CHECK(effectiveThreadCount(3) == 3);
+	CHECK(effectiveThreadCount(0) >= 1);
+	CHECK(effectiveThreadCount(-1) == effectiveThreadCount(0));
+}
@@ -0,0 +1,78 @@
+#include "../catch.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "cartocrow/flow_map/painting.h"
+#include "cartocrow/flow_map/spiral.h"
+#include "cartocrow/flow_map/spiral_tree.h"
+
+using namespace cartocrow;
+using namespace cartocrow::flow_map;
+
+namespace {
+
+/// Checks that the polyline with the given vertices stays within the given
+/// distance of the spiral, and that its vertices lie on the spiral.
+void checkFlattening(const Spiral& spiral, const std::vector<PolarPoint>& vertices,
+                     Number<Inexact> tolerance) {
+	REQUIRE(vertices.size() >= 2);
+	for (const PolarPoint& vertex : vertices) {
+		const Number<Inexact> error = wrapAngle(vertex.phi() - spiral.phiForR(vertex.r()), -M_PI);
+		CHECK(std::abs(error) == Approx(0).margin(1e-9));
+	}
+	for (size_t i = 0; i + 1 < vertices.size(); i++) {
+		const Segment<Inexact> chord(vertices[i].toCartesian(), vertices[i + 1].toCartesian());
+		const Number<Inexact> from = spiral.parameterForR(vertices[i].r());
+		const Number<Inexact> to = spiral.parameterForR(vertices[i + 1].r());
+		REQUIRE(from < to);
+		for (int j = 1; j < 50; j++) {
+			const Point<Inexact> p = spiral.evaluate(from + (to - from) * j / 50).toCartesian();
+			CHECK(std::sqrt(CGAL::squared_distance(p, chord)) <= tolerance * (1 + 1e-6));
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("Flattening a spiral for painting") {
+	const Number<Inexact> tMax = std::numeric_limits<Number<Inexact>>::infinity();
+
+	SECTION("counterclockwise spiral") {
+		const PolarPoint parent(5, 1.5);
+		const Spiral spiral(PolarPoint(100, 0), parent);
+		REQUIRE(spiral.angle() != 0);
+		const auto coarse = Painting::flattenSpiral(spiral, parent, 0.2, tMax);
+		checkFlattening(spiral, coarse, 0.2);
+		const auto fine = Painting::flattenSpiral(spiral, parent, 0.01, tMax);
+		checkFlattening(spiral, fine, 0.01);
+		CHECK(fine.size() > coarse.size());
+		CHECK(fine.back().r() == Approx(parent.r()));
+	}
+
+	SECTION("clockwise spiral") {
+		const PolarPoint parent(1, -1);
+		const Spiral spiral(PolarPoint(50, 2), parent);
+		REQUIRE(spiral.angle() != 0);
+		checkFlattening(spiral, Painting::flattenSpiral(spiral, parent, 0.05, tMax), 0.05);
+	}
+
+	SECTION("straight line") {
+		const PolarPoint parent(10, 0.5);
+		const Spiral spiral(PolarPoint(80, 0.5), parent);
+		const auto vertices = Painting::flattenSpiral(spiral, parent, 0.05, tMax);
+		CHECK(vertices.size() == 2);
+	}
+}
+
+TEST_CASE("Painting a spiral tree with an invalid spiral tolerance") {
+	auto tree = std::make_shared<SpiralTree>(Point<Inexact>(0, 0), 0.5061454830783556);
+	tree->addPlace("p", Point<Inexact>(100, 20), 1);
+	Painting::Options options;
+	CHECK_NOTHROW(Painting(nullptr, tree, options));
+	for (const double tolerance : {0.0, -0.05, std::numeric_limits<double>::quiet_NaN()}) {
+		options.spiralTolerance = tolerance;
+		CHECK_THROWS_AS(Painting(nullptr, tree, options), std::runtime_error);
+	}
+}
@@ -1,7 +1,10 @@
 #include "../catch.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <ctime>
+#include <string>
+#include <vector>
 
 #include "cartocrow/flow_map/reachable_region_algorithm.h"
 #include "cartocrow/flow_map/spiral_tree.h"
@@ -24,3 +27,61 @@ TEST_CASE("Computing the reachable region with one obstacle") {
 
 	// TODO add assertions
 }
+
+TEST_CASE("Computing the reachable region in separate sectors") {
+	auto makeTree = []() {
+		auto tree = std::make_shared<SpiralTree>(Point<Inexact>(0, 0), 0.5061454830783556);
+		// six small obstacles spread around the root in angularly disjoint
+		// directions, with a place behind each obstacle and one between each
+		// pair of obstacles
+		for (int i = 0; i < 6; i++) {
+			const double angle = 0.2 + i * M_PI / 3;
+			const Vector<Inexact> d(std::cos(angle), std::sin(angle));
+			const Vector<Inexact> n(-d.y(), d.x());
+			Polygon<Inexact> obstacle;
+			obstacle.push_back(CGAL::ORIGIN + 100 * d - 20 * n);
+			obstacle.push_back(CGAL::ORIGIN + 150 * d);
+			obstacle.push_back(CGAL::ORIGIN + 100 * d + 20 * n);
+			obstacle.push_back(CGAL::ORIGIN + 120 * d);
+			tree->addObstacle(obstacle);
+			tree->addPlace("behind" + std::to_string(i), CGAL::ORIGIN + 400 * d, 1);
+			const Vector<Inexact> between(std::cos(angle + M_PI / 6), std::sin(angle + M_PI / 6));
+			tree->addPlace("between" + std::to_string(i), CGAL::ORIGIN + 300 * between, 1);
+		}
+		return tree;
+	};
+	auto sortedVertices = [](const ReachableRegionAlgorithm::ReachableRegion& region) {
+		std::vector<PolarPoint> vertices;
+		for (const auto& vertex : region.boundary) {
+			vertices.push_back(vertex.m_location);
+		}
+		std::sort(vertices.begin(), vertices.end(), [](const PolarPoint& a, const PolarPoint& b) {
+			return a.r() < b.r() || (a.r() == b.r() && a.phi() < b.phi());
+		});
+		return vertices;
+	};
+
+	auto sequentialTree = makeTree();
+	ReachableRegionAlgorithm sequentialAlgorithm(sequentialTree);
+	auto sequential = sequentialAlgorithm.run();
+	CHECK(sequentialAlgorithm.statistics().sweeps == 1);
+	auto parallelTree = makeTree();
+	ReachableRegionAlgorithm algorithm(parallelTree);
+	algorithm.setThreadCount(3);
+	auto parallel = algorithm.run();
+	// each obstacle forms its own sector
+	CHECK(algorithm.statistics().sweeps == 6);
+
+	REQUIRE(parallel.reachableNodes.size() == sequential.reachableNodes.size());
+	for (int i = 0; i < sequential.reachableNodes.size(); i++) {
+		CHECK(parallel.reachableNodes[i]->m_position.r() ==
+		      Approx(sequential.reachableNodes[i]->m_position.r()));
+	}
+	auto sequentialVertices = sortedVertices(sequential);
+	auto parallelVertices = sortedVertices(parallel);
+	REQUIRE(parallelVertices.size() == sequentialVertices.size());
+	for (int i = 0; i < sequentialVertices.size(); i++) {
+		CHECK(parallelVertices[i].r() == Approx(sequentialVertices[i].r()));
+		CHECK(parallelVertices[i].phi() == Approx(sequentialVertices[i].phi()));
+	}
+}
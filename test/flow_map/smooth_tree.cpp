@@ -0,0 +1,98 @@
+#include "../catch.hpp"
+
+#include "cartocrow/flow_map/smooth_tree.h"
+#include "cartocrow/flow_map/spiral_tree.h"
+#include "cartocrow/flow_map/spiral_tree_unobstructed_algorithm.h"
+
+using namespace cartocrow;
+using namespace cartocrow::flow_map;
+
+namespace {
+
+std::shared_ptr<SpiralTree> makeTree() {
+	auto tree = std::make_shared<SpiralTree>(Point<Inexact>(0, 0), 0.5061454830783556);
+	tree->addPlace("a", Point<Inexact>(0, 100), 1);
+	tree->addPlace("b", Point<Inexact>(3, 98), 1);
+	tree->addPlace("c", Point<Inexact>(-3, 97), 2);
+	tree->addPlace("d", Point<Inexact>(1, 93), 1);
+	tree->addPlace("e", Point<Inexact>(40, 60), 3);
+	SpiralTreeUnobstructedAlgorithm(*tree).run();
+	return tree;
+}
+
+std::vector<PolarPoint> positions(const SmoothTree& smoothTree) {
+	std::vector<PolarPoint> result;
+	for (const auto& node : smoothTree.nodes()) {
+		result.push_back(node->m_position);
+	}
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("Optimizing a smooth tree") {
+	SmoothTree smoothTree(makeTree());
+	SmoothTree::OptimizationOptions options;
+	options.threadCount = 1;
+
+	SECTION("lowers the cost") {
+		options.maxIterations = 20;
+		options.tolerance = 0;
+		const auto result = smoothTree.optimize(options);
+		REQUIRE(result.costs.size() >= 2);
+		for (int i = 1; i < result.costs.size(); i++) {
+			CHECK(result.costs[i] < result.costs[i - 1]);
+		}
+		CHECK(result.costs.back() == Approx(smoothTree.computeCost()));
+		// with zero tolerance every accepted iteration decreases the cost by
+		// more than the tolerance, so we must have run out of iterations
+		CHECK_FALSE(result.converged);
+		CHECK_FALSE(result.stalled);
+		CHECK(result.iterations == options.maxIterations);
+	}
+	SECTION("reports convergence") {
+		// any decrease is at most the cost itself
+		options.tolerance = 1;
+		const auto result = smoothTree.optimize(options);
+		CHECK(result.converged);
+		CHECK_FALSE(result.stalled);
+		CHECK(result.iterations == 1);
+		REQUIRE(result.costs.size() == 2);
+		CHECK(result.costs[1] < result.costs[0]);
+	}
+	SECTION("reports a failed line search as stalled, not converged") {
+		// the line search never gets to try a single step
+		options.initialStepSize = 1e-6;
+		options.minStepSize = 1e-3;
+		const std::vector<PolarPoint> before = positions(smoothTree);
+		const auto result = smoothTree.optimize(options);
+		CHECK(result.stalled);
+		CHECK_FALSE(result.converged);
+		CHECK(result.costs.size() == 1);
+		const std::vector<PolarPoint> after = positions(smoothTree);
+		for (int i = 0; i < before.size(); i++) {
+			CHECK(after[i] == before[i]);
+		}
+	}
+}
+
+TEST_CASE("Computing the obstacle cost of a smooth tree with a cutoff") {
+	SmoothTree smoothTree(makeTree());
+	const Number<Inexact> exact = smoothTree.computeObstacleCost();
+	CHECK(exact > 0);
+
+	smoothTree.setObstacleCutoff(1000);
+	CHECK(smoothTree.computeObstacleCost() == exact);
+
+	// a smaller cutoff can only drop (non-negative) terms from the sum
+	Number<Inexact> previous = exact;
+	for (const Number<Inexact> cutoff : {3.0, 2.0, 1.0, 0.5}) {
+		smoothTree.setObstacleCutoff(cutoff);
+		const Number<Inexact> cost = smoothTree.computeObstacleCost();
+		CHECK(cost <= previous);
+		previous = cost;
+	}
+
+	smoothTree.setObstacleCutoff(0);
+	CHECK(smoothTree.computeObstacleCost() == 0);
+}
@@ -30,4 +30,18 @@ TEST_CASE("Adding an obstacle to a spiral tree") {
 		REQUIRE(tree->obstacles().size() == 1);
 		CHECK(tree->obstacles()[0].size() == 9); // 2 * 3 vertices added
 	}
+	SECTION("that is already counter-clockwise") {
+		shape.push_back(Point<Inexact>(-2, 4));
+		shape.push_back(Point<Inexact>(2, 4));
+		shape.push_back(Point<Inexact>(-2, 5));
+		tree->addObstacle(shape);
+		tree->addCounterclockwiseObstacle(shape);
+		REQUIRE(tree->obstacles().size() == 2);
+		REQUIRE(tree->obstacles()[1].size() == tree->obstacles()[0].size());
+		auto edge = tree->obstacles()[0].begin();
+		for (const auto& otherEdge : tree->obstacles()[1]) {
+			CHECK(otherEdge->shape().start() == (*edge)->shape().start());
+			++edge;
+		}
+	}
 }
@@ -0,0 +1,87 @@
+#include "../catch.hpp"
+
+#include "cartocrow/flow_map/reachable_region_algorithm.h"
+#include "cartocrow/flow_map/spiral_tree.h"
+#include "cartocrow/flow_map/spiral_tree_batch.h"
+#include "cartocrow/flow_map/spiral_tree_obstructed_algorithm.h"
+
+using namespace cartocrow;
+using namespace cartocrow::flow_map;
+
+TEST_CASE("Computing a batch of spiral trees with shared obstacles") {
+	const Number<Inexact> alpha = 0.5061454830783556;
+	Polygon<Inexact> obstacle;
+	// clockwise, to check that the batch normalizes the orientation
+	obstacle.push_back(Point<Inexact>(10, 50));
+	obstacle.push_back(Point<Inexact>(0, 25));
+	obstacle.push_back(Point<Inexact>(-10, 50));
+	const std::vector<Point<Inexact>> roots = {Point<Inexact>(0, 0), Point<Inexact>(-50, 0),
+	                                           Point<Inexact>(50, 10)};
+	const std::vector<Point<Inexact>> places = {Point<Inexact>(0, 100), Point<Inexact>(40, 90),
+	                                            Point<Inexact>(-30, 80)};
+
+	SpiralTreeBatch batch(alpha);
+	batch.addObstacle(obstacle);
+	CHECK(batch.obstacles()[0].is_counterclockwise_oriented());
+	for (const Point<Inexact>& root : roots) {
+		auto tree = batch.addRoot(root);
+		for (const Point<Inexact>& place : places) {
+			tree->addPlace("", place, 1);
+		}
+	}
+	batch.run(2);
+	REQUIRE(batch.trees().size() == roots.size());
+	CHECK_THROWS(batch.run());
+
+	// every tree should be identical to one computed on its own
+	for (int i = 0; i < roots.size(); i++) {
+		auto tree = std::make_shared<SpiralTree>(roots[i], alpha);
+		for (const Point<Inexact>& place : places) {
+			tree->addPlace("", place, 1);
+		}
+		tree->addObstacle(obstacle);
+		tree->addShields();
+		auto reachableRegion = ReachableRegionAlgorithm(tree).run();
+		SpiralTreeObstructedAlgorithm(tree, reachableRegion).run();
+
+		const auto& batchTree = batch.trees()[i];
+		REQUIRE(batchTree->nodes().size() == tree->nodes().size());
+		for (int j = 0; j < tree->nodes().size(); j++) {
+			CHECK(batchTree->nodes()[j]->m_position == tree->nodes()[j]->m_position);
+		}
+	}
+}
+
+TEST_CASE("Computing a batch of spiral trees does not depend on the number of threads") {
+	const Number<Inexact> alpha = 0.5061454830783556;
+	Polygon<Inexact> obstacle;
+	obstacle.push_back(Point<Inexact>(-10, 50));
+	obstacle.push_back(Point<Inexact>(0, 25));
+	obstacle.push_back(Point<Inexact>(10, 50));
+	const std::vector<Point<Inexact>> places = {Point<Inexact>(0, 100), Point<Inexact>(40, 90),
+	                                            Point<Inexact>(-30, 80)};
+
+	const auto runBatch = [&](int threadCount) {
+		auto batch = std::make_unique<SpiralTreeBatch>(alpha);
+		batch->addObstacle(obstacle);
+		for (int i = 0; i < 6; i++) {
+			auto tree = batch->addRoot(Point<Inexact>(20 * i - 50, 5 * i));
+			for (const Point<Inexact>& place : places) {
+				tree->addPlace("", place, 1);
+			}
+		}
+		batch->run(threadCount);
+		return batch;
+	};
+	const auto sequential = runBatch(1);
+	const auto parallel = runBatch(4);
+	REQUIRE(sequential->trees().size() == parallel->trees().size());
+	for (int i = 0; i < sequential->trees().size(); i++) {
+		const auto& a = sequential->trees()[i]->nodes();
+		const auto& b = parallel->trees()[i]->nodes();
+		REQUIRE(a.size() == b.size());
+		for (int j = 0; j < a.size(); j++) {
+			CHECK(a[j]->m_position == b[j]->m_position);
+		}
+	}
+}
@@ -34,6 +34,7 @@ TEST_CASE("Computing a spiral tree with one node", "[!mayfail]") {
 	ReachableRegionAlgorithm algorithm(tree);
 	auto reachable = algorithm.run();
 	SpiralTreeObstructedAlgorithm algorithm2(tree, reachable);
+	algorithm2.setDebugOutput(true);
 	algorithm2.run();
 
 	cartocrow::renderer::IpeRenderer renderer(algorithm2.debugPainting());
@@ -134,6 +134,34 @@ TEST_CASE("Querying a sweep circle for intervals and edges") {
 	}
 }
 
+TEST_CASE("Replacing one of several sweep edges at the same angle") {
+	SweepCircle circle(SweepInterval::Type::REACHABLE);
+	circle.grow(1);
+
+	auto e1 =
+	    std::make_shared<SweepEdge>(SweepEdgeShape(PolarPoint(1, M_PI / 2), PolarPoint(2, M_PI / 4)));
+	auto e2 = std::make_shared<SweepEdge>(
+	    SweepEdgeShape(PolarPoint(1, M_PI / 2), PolarPoint(3, 3 * M_PI / 4)));
+	circle.splitFromInterval(e1, e2);
+	CHECK(circle.isValid());
+
+	auto [begin, end] = circle.edgesAt(M_PI / 2);
+	CHECK(std::distance(begin, end) == 2);
+
+	auto e3 = std::make_shared<SweepEdge>(
+	    SweepEdgeShape(PolarPoint(1, M_PI / 2), PolarPoint(2, 3 * M_PI / 4)));
+	circle.switchEdge(e2, e3);
+	CHECK(circle.isValid());
+	CHECK(circle.intervalCount() == 2);
+	CHECK(e1->isOnCircle());
+	CHECK(!e2->isOnCircle());
+	CHECK(e3->isOnCircle());
+
+	circle.grow(1.5);
+	CHECK(circle.isValid());
+	CHECK(circle.intervalAt(M_PI / 2) == e1->nextInterval());
+}
+
 TEST_CASE("Growing a sweep circle") {
 	SweepCircle circle(SweepInterval::Type::REACHABLE);
 	circle.grow(1);
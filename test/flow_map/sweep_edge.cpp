@@ -226,3 +226,30 @@ TEST_CASE("Intersecting outwards a left spiral and a right spiral straddling the
 	CHECK(*r > 2);
 	CHECK(spiral1.phiForR(*r) == Approx(spiral2.phiForR(*r)));
 }
+
+TEST_CASE("Intersecting inwards a left spiral and a right spiral starting at different points") {
+	const SweepEdgeShape spiral1(SweepEdgeShape::Type::RIGHT_SPIRAL, PolarPoint(2, 3 * M_PI / 4),
+	                             0.5);
+	const SweepEdgeShape spiral2(SweepEdgeShape::Type::LEFT_SPIRAL, PolarPoint(2, M_PI / 4), 0.5);
+	std::optional<Number<Inexact>> r;
+	SECTION("first to second") {
+		r = spiral1.intersectInwardsWith(spiral2, 2);
+	}
+	SECTION("second to first") {
+		r = spiral2.intersectInwardsWith(spiral1, 2);
+	}
+	REQUIRE(r.has_value());
+	CHECK(*r < 2);
+	CHECK(spiral1.phiForR(*r) == Approx(spiral2.phiForR(*r)));
+	// going inwards, the angle between the spirals opens up, so they only meet
+	// after almost a full turn relative to each other
+	CHECK(*r == Approx(2 * std::exp(-(2 * M_PI - M_PI / 2) / (2 * std::tan(0.5)))));
+}
+
+TEST_CASE("Intersecting two spirals of the same type") {
+	const SweepEdgeShape spiral1(SweepEdgeShape::Type::LEFT_SPIRAL, PolarPoint(2, 3 * M_PI / 4),
+	                             0.5);
+	const SweepEdgeShape spiral2(SweepEdgeShape::Type::LEFT_SPIRAL, PolarPoint(2, M_PI / 4), 0.5);
+	CHECK(!spiral1.intersectOutwardsWith(spiral2, 2).has_value());
+	CHECK(!spiral1.intersectInwardsWith(spiral2, 2).has_value());
+}
@@ -0,0 +1,200 @@
+#include "../catch.hpp"
+
+#include <vector>
+
+#include "cartocrow/isoline_simplification/bezier_chain.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+
+std::vector<double> roots(double c0, double c1, double c2, double c3) {
+	double result[3];
+	const int count = unit_cubic_roots(c0, c1, c2, c3, result);
+	return std::vector<double>(result, result + count);
+}
+
+void checkRoots(const std::vector<double>& actual, const std::vector<double>& expected) {
+	REQUIRE(actual.size() == expected.size());
+	for (int i = 0; i < expected.size(); i++) {
+		CHECK(actual[i] == Approx(expected[i]).margin(1E-12));
+	}
+}
+
+} // namespace
+
+TEST_CASE("Computing roots of cubic polynomials in the unit interval") {
+	SECTION("three real roots") {
+		// (t - 0.25)(t - 0.5)(t - 0.75)
+		checkRoots(roots(-0.09375, 0.6875, -1.5, 1), {0.25, 0.5, 0.75});
+		// the same polynomial, scaled
+		checkRoots(roots(0.09375E3, -0.6875E3, 1.5E3, -1E3), {0.25, 0.5, 0.75});
+	}
+	SECTION("roots outside the unit interval") {
+		// (t + 1)(t - 2)(t - 0.5)
+		checkRoots(roots(1, -1.5, -1.5, 1), {0.5});
+		// (t - 2)(t - 3)(t - 4)
+		checkRoots(roots(-24, 26, -9, 1), {});
+	}
+	SECTION("roots at the ends of the interval") {
+		// t (t - 1)(t - 2)
+		checkRoots(roots(0, 2, -3, 1), {0, 1});
+	}
+	SECTION("one real root") {
+		// (t - 0.2)(t^2 - 0.7t + 0.15)
+		checkRoots(roots(-0.03, 0.29, -0.9, 1), {0.2});
+	}
+	SECTION("double and triple roots") {
+		// (t - 0.5)^2 (t - 0.8)
+		checkRoots(roots(-0.2, 1.05, -1.8, 1), {0.5, 0.8});
+		// (t - 0.5)^3
+		checkRoots(roots(-0.125, 0.75, -1.5, 1), {0.5});
+	}
+	SECTION("quadratic polynomials") {
+		// (t - 0.2)(t - 0.6)
+		checkRoots(roots(0.12, -0.8, 1, 0), {0.2, 0.6});
+		// a cubic coefficient that is negligible compared to the others
+		checkRoots(roots(0.12, -0.8, 1, 1E-15), {0.2, 0.6});
+		// (t - 0.5)^2
+		checkRoots(roots(0.25, -1, 1, 0), {0.5});
+		// t^2 + 1
+		checkRoots(roots(1, 0, 1, 0), {});
+	}
+	SECTION("linear and constant polynomials") {
+		checkRoots(roots(-1, 2, 0, 0), {0.5});
+		checkRoots(roots(-3, 2, 0, 0), {});
+		checkRoots(roots(3, 0, 0, 0), {});
+		// the zero polynomial has no isolated roots
+		checkRoots(roots(0, 0, 0, 0), {});
+	}
+}
+
+TEST_CASE("Setting a Bézier chain to a spline") {
+	BezierChain chain;
+
+	SECTION("from too few control points") {
+		const double xs[] = {0};
+		const double ys[] = {0};
+		CHECK_THROWS_AS(chain.set_spline(xs, ys, 1), std::runtime_error);
+	}
+
+	SECTION("from two control points") {
+		const double xs[] = {1, 4};
+		const double ys[] = {2, -1};
+		chain.set_spline(xs, ys, 2);
+		REQUIRE(chain.curve_count() == 1);
+		const BezierCurve curve = chain.to_spline().curves()[0];
+		for (double t : {0.0, 0.3, 0.5, 1.0}) {
+			const Point<Inexact> p = curve.evaluate(t);
+			CHECK(p.x() == Approx(1 + 3 * t));
+			CHECK(p.y() == Approx(2 - 3 * t));
+		}
+	}
+
+	SECTION("from three control points") {
+		// the parabola y = x^2 for x in [-1, 1]
+		const double xs[] = {-1, 0, 1};
+		const double ys[] = {1, -1, 1};
+		chain.set_spline(xs, ys, 3);
+		REQUIRE(chain.curve_count() == 1);
+		const BezierCurve curve = chain.to_spline().curves()[0];
+		for (double t : {0.0, 0.25, 0.5, 0.9, 1.0}) {
+			const Point<Inexact> p = curve.evaluate(t);
+			CHECK(p.x() == Approx(-1 + 2 * t));
+			CHECK(p.y() == Approx(p.x() * p.x()).margin(1E-12));
+		}
+	}
+
+	SECTION("from four control points") {
+		// a clamped cubic B-spline with four control points is a single Bézier curve with the same control points
+		const double xs[] = {0, 1, 3, 4};
+		const double ys[] = {0, 2, 2, 0};
+		chain.set_spline(xs, ys, 4);
+		REQUIRE(chain.curve_count() == 1);
+		const BezierCurve curve = chain.to_spline().curves()[0];
+		CHECK(curve.source() == Point<Inexact>(0, 0));
+		CHECK(curve.sourceControl() == Point<Inexact>(1, 2));
+		CHECK(curve.targetControl() == Point<Inexact>(3, 2));
+		CHECK(curve.target() == Point<Inexact>(4, 0));
+	}
+
+	SECTION("from more control points") {
+		const double xs[] = {0, 1, 2, 3, 4, 5};
+		const double ys[] = {0, 1, -1, 1, -1, 0};
+		chain.set_spline(xs, ys, 6);
+		REQUIRE(chain.curve_count() == 3);
+		const BezierSpline spline = chain.to_spline();
+		CHECK(spline.isContinuous());
+		CHECK(spline.curves().front().source() == Point<Inexact>(0, 0));
+		CHECK(spline.curves().back().target() == Point<Inexact>(5, 0));
+		// the junctions are smooth: each lies halfway between the control points next to it
+		for (int j = 1; j < spline.curves().size(); j++) {
+			const BezierCurve& before = spline.curves()[j - 1];
+			const BezierCurve& after = spline.curves()[j];
+			CHECK(before.target() == after.source());
+			CHECK(before.target().x() ==
+			      Approx((before.targetControl().x() + after.sourceControl().x()) / 2));
+			CHECK(before.target().y() ==
+			      Approx((before.targetControl().y() + after.sourceControl().y()) / 2));
+		}
+
+		// setting the chain again reuses it
+		chain.set_spline(xs, ys, 4);
+		CHECK(chain.curve_count() == 1);
+	}
+}
+
+TEST_CASE("Intersecting a Bézier chain with a line") {
+	BezierChain chain;
+	double x = 0;
+	double y = 0;
+
+	SECTION("a single curve") {
+		// the parabola y = x^2 for x in [-1, 1]
+		const double xs[] = {-1, 0, 1};
+		const double ys[] = {1, -1, 1};
+		chain.set_spline(xs, ys, 3);
+
+		CHECK(chain.intersect_line(0, 1, -0.25, x, y) == 2);
+		CHECK(chain.intersect_line(0, 1, 0.1, x, y) == 0);
+		CHECK(chain.intersect_line(0, 1, -2, x, y) == 0);
+
+		REQUIRE(chain.intersect_line(1, 0, -0.5, x, y) == 1);
+		CHECK(x == Approx(0.5));
+		CHECK(y == Approx(0.25));
+
+		// a tangent line touches once
+		REQUIRE(chain.intersect_line(0, 1, 0, x, y) == 1);
+		CHECK(x == Approx(0).margin(1E-12));
+		CHECK(y == Approx(0).margin(1E-12));
+	}
+
+	SECTION("a chain of collinear curves") {
+		const double xs[] = {0, 1, 2, 3, 4};
+		const double ys[] = {0, 0, 0, 0, 0};
+		chain.set_spline(xs, ys, 5);
+		REQUIRE(chain.curve_count() == 2);
+
+		REQUIRE(chain.intersect_line(1, 0, -3.5, x, y) == 1);
+		CHECK(x == Approx(3.5));
+		CHECK(y == Approx(0).margin(1E-12));
+
+		// the junction between the curves lies at x = 2, and is reported once
+		REQUIRE(chain.intersect_line(1, 0, -2, x, y) == 1);
+		CHECK(x == Approx(2));
+
+		// a chain that overlaps the line has no isolated intersections
+		CHECK(chain.intersect_line(0, 1, 0, x, y) == 0);
+	}
+
+	SECTION("a chain with several crossings") {
+		const double xs[] = {0, 1, 2, 3, 4, 5};
+		const double ys[] = {0, 1, -1, 1, -1, 0};
+		chain.set_spline(xs, ys, 6);
+		CHECK(chain.intersect_line(0, 1, 0, x, y) == 2);
+		REQUIRE(chain.intersect_line(1, 0, -2.5, x, y) == 1);
+		CHECK(x == Approx(2.5));
+		CHECK(y == Approx(0).margin(1E-12));
+	}
+}
@@ -0,0 +1,89 @@
+#include "../catch.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "cartocrow/isoline_simplification/isoline_io.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+
+std::filesystem::path temporaryFile(const std::string& name) {
+	return std::filesystem::temp_directory_path() / ("cartocrow_test_" + name + ".bin");
+}
+
+std::vector<Isoline<K>> exampleIsolines() {
+	std::vector<Isoline<K>> isolines;
+	isolines.emplace_back(std::vector<Point<K>>{Point<K>(0, 0), Point<K>(1, 0), Point<K>(1, 1)}, true);
+	isolines.emplace_back(std::vector<Point<K>>{Point<K>(-2.5, 3), Point<K>(0.125, 1E-9)}, false);
+	isolines.emplace_back(std::vector<Point<K>>{}, false);
+	isolines.emplace_back(std::vector<Point<K>>{Point<K>(5, 5), Point<K>(6, 5), Point<K>(6, 6),
+	                                            Point<K>(5, 6)},
+	                      true);
+	return isolines;
+}
+
+/// Overwrites the 64-bit value at the given byte offset in the file.
+void patch(const std::filesystem::path& file, std::streamoff offset, std::uint64_t value) {
+	std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+	stream.seekp(offset);
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+TEST_CASE("Reading and writing isolines in the binary format") {
+	const auto isolines = exampleIsolines();
+	const auto file = temporaryFile("isoline_io");
+	isolinesToBinary(isolines, file);
+
+	SECTION("round trip") {
+		const auto read = binaryToIsolines(file);
+		REQUIRE(read.size() == isolines.size());
+		for (int i = 0; i < isolines.size(); i++) {
+			CHECK(read[i].m_closed == isolines[i].m_closed);
+			CHECK(read[i].m_points == isolines[i].m_points);
+		}
+	}
+
+	SECTION("truncated file") {
+		std::filesystem::resize_file(file, std::filesystem::file_size(file) - 8);
+		CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+		std::filesystem::resize_file(file, 40);
+		CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+		std::filesystem::resize_file(file, 4);
+		CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+	}
+
+	SECTION("trailing data") {
+		std::filesystem::resize_file(file, std::filesystem::file_size(file) + 16);
+		CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+	}
+
+	SECTION("bogus counts") {
+		// the header is magic (8), version (4), reserved (4), isoline count (8), point count (8); these
+		// counts must be rejected without trying to allocate memory for them
+		SECTION("isoline count") {
+			patch(file, 16, std::uint64_t(1) << 60);
+			CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+			patch(file, 16, ~std::uint64_t(0));
+			CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+		}
+		SECTION("point count") {
+			patch(file, 24, std::uint64_t(1) << 60);
+			CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+			patch(file, 24, ~std::uint64_t(0));
+			CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+		}
+		SECTION("offset") {
+			// the second offset points far beyond the coordinates, although the last one is consistent
+			patch(file, 32 + 8, std::uint64_t(1) << 60);
+			CHECK_THROWS_AS(binaryToIsolines(file), std::runtime_error);
+		}
+	}
+
+	std::filesystem::remove(file);
+}
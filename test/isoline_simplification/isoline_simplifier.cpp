@@ -0,0 +1,222 @@
+#include "../catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cartocrow/isoline_simplification/isoline_simplifier.h"
+#include "cartocrow/isoline_simplification/symmetric_difference.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+
+/// Concentric closed isolines, each a circle with a small zigzag, so that
+/// neighbouring isolines have matching slope ladders.
+std::vector<Isoline<K>> rings(int count, int vertices) {
+	std::vector<Isoline<K>> isolines;
+	for (int level = 1; level <= count; level++) {
+		std::vector<Point<K>> points;
+		for (int i = 0; i < vertices; i++) {
+			const double angle = 2 * M_PI * i / vertices;
+			const double radius = 10 * level + (i % 2 == 0 ? 0.3 : -0.3) + 0.1 * std::sin(3 * angle);
+			points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+		}
+		isolines.emplace_back(points, true);
+	}
+	return isolines;
+}
+
+void checkEqual(const std::vector<Isoline<K>>& a, const std::vector<Isoline<K>>& b) {
+	REQUIRE(a.size() == b.size());
+	for (int i = 0; i < a.size(); i++) {
+		CHECK(a[i].m_closed == b[i].m_closed);
+		CHECK(a[i].m_points == b[i].m_points);
+	}
+}
+
+/// Checks that the isolines are equal, up to the choice of the first vertex of
+/// closed isolines.
+void checkEqualUpToRotation(const std::vector<Isoline<K>>& a, const std::vector<Isoline<K>>& b) {
+	REQUIRE(a.size() == b.size());
+	for (int i = 0; i < a.size(); i++) {
+		REQUIRE(a[i].m_closed == b[i].m_closed);
+		std::vector<Point<K>> pointsA(a[i].m_points.begin(), a[i].m_points.end());
+		std::vector<Point<K>> pointsB(b[i].m_points.begin(), b[i].m_points.end());
+		REQUIRE(pointsA.size() == pointsB.size());
+		if (a[i].m_closed && !pointsA.empty()) {
+			auto start = std::find(pointsB.begin(), pointsB.end(), pointsA.front());
+			REQUIRE(start != pointsB.end());
+			std::rotate(pointsB.begin(), start, pointsB.end());
+		}
+		CHECK(pointsA == pointsB);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Simplifying isolines in batches") {
+	const auto isolines = rings(4, 40);
+	const int target = 80;
+
+	SECTION("with a batch size of 1 behaves like simplify()") {
+		IsolineSimplifier sequential(isolines);
+		const bool sequentialDone = sequential.simplify(target);
+		IsolineSimplifier batched(isolines);
+		const bool batchedDone = batched.simplify_batched(target, 1);
+		CHECK(sequentialDone == batchedDone);
+		CHECK(sequential.m_current_complexity == batched.m_current_complexity);
+		checkEqual(sequential.m_simplified_isolines, batched.m_simplified_isolines);
+	}
+
+	SECTION("does not depend on the number of threads") {
+		IsolineSimplifier oneThread(isolines, 1, std::make_shared<MidpointCollapse>());
+		oneThread.simplify_batched(target, 8);
+		IsolineSimplifier fourThreads(isolines, 4, std::make_shared<MidpointCollapse>());
+		fourThreads.simplify_batched(target, 8);
+		CHECK(oneThread.m_current_complexity <= 160 - 8);
+		CHECK(oneThread.m_current_complexity == fourThreads.m_current_complexity);
+		checkEqual(oneThread.m_simplified_isolines, fourThreads.m_simplified_isolines);
+	}
+
+	SECTION("rejects non-positive batch sizes") {
+		IsolineSimplifier simplifier(isolines);
+		CHECK_THROWS_AS(simplifier.simplify_batched(target, 0), std::invalid_argument);
+		CHECK_THROWS_AS(simplifier.simplify_batched(target, -1), std::invalid_argument);
+		CHECK(simplifier.m_current_complexity == 160);
+	}
+}
+
+TEST_CASE("Reconstructing simplifications from the collapse history") {
+	const auto isolines = rings(3, 30);
+	IsolineSimplifier simplifier(isolines, std::make_shared<MidpointCollapse>());
+	const int initial = simplifier.m_current_complexity;
+
+	std::vector<std::pair<int, std::vector<Isoline<K>>>> snapshots;
+	for (int i = 0; i < 20 && simplifier.step(); i++) {
+		simplifier.update_matching();
+		simplifier.update_ladders();
+		snapshots.emplace_back(simplifier.m_current_complexity, simplifier.m_simplified_isolines);
+	}
+	REQUIRE(!snapshots.empty());
+	CHECK(simplifier.m_history.step_count() == snapshots.size());
+
+	checkEqualUpToRotation(simplifier.simplification_at(initial), simplifier.m_isolines);
+	checkEqualUpToRotation(simplifier.simplification_at(simplifier.m_current_complexity),
+	                       simplifier.m_simplified_isolines);
+	for (const auto& [complexity, snapshot] : snapshots) {
+		checkEqualUpToRotation(simplifier.simplification_at(complexity), snapshot);
+	}
+
+	// the vertices collapsed in the first step do not exist after it
+	const CollapseHistory& history = simplifier.m_history;
+	const auto [begin, end] = history.created_in(1);
+	REQUIRE(begin < end);
+	const HistoryNode& created = history.nodes()[begin];
+	CHECK(history.exists_after(created.first, 0));
+	CHECK_FALSE(history.exists_after(created.first, 1));
+	CHECK_FALSE(history.exists_after(begin, 0));
+	CHECK(history.exists_after(begin, 1));
+	std::vector<Point<K>> points;
+	CHECK_THROWS_AS(history.expand(created.first, 1, points), std::invalid_argument);
+}
+
+TEST_CASE("Tracking the symmetric difference incrementally") {
+	const auto isolines = rings(4, 40);
+
+	SECTION("matches a recomputation") {
+		IsolineSimplifier simplifier(isolines, std::make_shared<MidpointCollapse>());
+		CHECK(simplifier.m_area_error == 0);
+		CHECK(simplifier.total_symmetric_difference() == Approx(0).margin(1E-9));
+
+		// a single collapse has no other collapses to interact with, so its area is exact
+		REQUIRE(simplifier.step());
+		CHECK(simplifier.m_area_error > 0);
+		CHECK(simplifier.m_area_error == Approx(simplifier.total_symmetric_difference()));
+		simplifier.update_matching();
+		simplifier.update_ladders();
+
+		// later collapses may partly undo earlier ones, so then the running total is an upper bound
+		for (int i = 0; i < 30; i++) {
+			if (!simplifier.step()) {
+				break;
+			}
+			simplifier.update_matching();
+			simplifier.update_ladders();
+			CHECK(simplifier.m_area_error >= simplifier.total_symmetric_difference() - 1E-9);
+		}
+		double sum = 0;
+		for (int i = 0; i < isolines.size(); i++) {
+			const double exact = symmetric_difference(isolines[i], simplifier.m_simplified_isolines[i]);
+			CHECK(simplifier.m_isoline_area_error[i] >= exact - 1E-9);
+			sum += simplifier.m_isoline_area_error[i];
+		}
+		CHECK(sum == Approx(simplifier.m_area_error));
+	}
+
+	SECTION("respects an error budget") {
+		IsolineSimplifier reference(isolines, std::make_shared<MidpointCollapse>());
+		reference.simplify(80);
+		const double budget = reference.m_area_error / 2;
+		REQUIRE(budget > 0);
+
+		IsolineSimplifier simplifier(isolines, std::make_shared<MidpointCollapse>());
+		CHECK(simplifier.simplify_to_error(budget));
+		CHECK(simplifier.m_area_error <= budget);
+		CHECK(simplifier.m_current_complexity < 160);
+		CHECK(simplifier.m_current_complexity > reference.m_current_complexity);
+
+		// the ladder that did not fit in the budget is the next one to be collapsed
+		REQUIRE(simplifier.step());
+		CHECK(simplifier.m_area_error > budget);
+
+		// a budget of zero allows no collapses at all
+		IsolineSimplifier unchanged(isolines, std::make_shared<MidpointCollapse>());
+		CHECK(unchanged.simplify_to_error(0));
+		CHECK(unchanged.m_current_complexity == 160);
+	}
+}
+
+TEST_CASE("Revalidating blocked slope ladders lazily") {
+	// irregular rings, so that no two ladders have the same cost
+	std::vector<Isoline<K>> isolines;
+	for (int level = 1; level <= 4; level++) {
+		std::vector<Point<K>> points;
+		for (int i = 0; i < 40; i++) {
+			const double angle = 2 * M_PI * i / 40;
+			const double radius = 4 * level + (i % 2 == 0 ? 0.8 : -0.8) + 0.3 * std::sin(1.7 * i * i + level);
+			points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+		}
+		isolines.emplace_back(points, true);
+	}
+	const int target = 60;
+
+	IsolineSimplifier lazy(isolines);
+	lazy.simplify(target);
+
+	// check every blocked ladder again before each collapse
+	IsolineSimplifier eager(isolines);
+	while (eager.m_current_complexity > target) {
+		eager.revalidate_blocked_ladders();
+		if (!eager.step()) break;
+		eager.update_matching();
+		eager.update_ladders();
+	}
+
+	CHECK(lazy.m_current_complexity < 160);
+	CHECK(lazy.m_current_complexity == eager.m_current_complexity);
+	checkEqual(lazy.m_simplified_isolines, eager.m_simplified_isolines);
+
+	// no ladder is reported twice, and none that cannot be collapsed anymore
+	const auto pending = lazy.pending_ladders();
+	for (int i = 0; i < pending.size(); i++) {
+		CHECK_FALSE(pending[i]->m_old);
+		CHECK_FALSE(pending[i]->m_intersects);
+		for (int j = i + 1; j < pending.size(); j++) {
+			CHECK(pending[i] != pending[j]);
+		}
+	}
+	if (auto next = lazy.get_next_ladder()) {
+		CHECK(std::find(pending.begin(), pending.end(), *next) != pending.end());
+	}
+}
@@ -0,0 +1,151 @@
+#include "../catch.hpp"
+
+#include <cmath>
+
+#include "cartocrow/isoline_simplification/isoline_simplifier.h"
+#include "cartocrow/isoline_simplification/isoline_topology.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+TEST_CASE("Adding, linking and removing isoline topology vertices") {
+	Isoline<K> isoline({Point<K>(0, 0), Point<K>(1, 0), Point<K>(2, 1)}, false);
+	IsolineTopology topology;
+	std::vector<VertexId> vertices;
+	for (auto it = isoline.m_points.begin(); it != isoline.m_points.end(); ++it) {
+		vertices.push_back(topology.add(*it, &isoline, it));
+	}
+	topology.link(vertices[0], vertices[1]);
+	topology.link(vertices[1], vertices[2]);
+	CHECK(topology.vertex_count() == 3);
+
+	SECTION("looking up vertices") {
+		for (int i = 0; i < vertices.size(); i++) {
+			const Point<K>& point = topology[vertices[i]].point;
+			REQUIRE(topology.contains(point));
+			CHECK(topology.id(point) == vertices[i]);
+			CHECK(*topology.find(point) == vertices[i]);
+			CHECK(topology[vertices[i]].isoline == &isoline);
+			CHECK(*topology[vertices[i]].iterator == point);
+		}
+		CHECK_FALSE(topology.contains(Point<K>(5, 5)));
+		CHECK_FALSE(topology.find(Point<K>(5, 5)).has_value());
+		CHECK_THROWS_AS(topology.id(Point<K>(5, 5)), std::out_of_range);
+	}
+
+	SECTION("walking along the isoline") {
+		PointToPoint prev(topology, &TopologyVertex::prev);
+		PointToPoint next(topology, &TopologyVertex::next);
+		CHECK(next.at(Point<K>(0, 0)) == Point<K>(1, 0));
+		CHECK(next.at(Point<K>(1, 0)) == Point<K>(2, 1));
+		CHECK(prev.at(Point<K>(2, 1)) == Point<K>(1, 0));
+		CHECK_FALSE(prev.contains(Point<K>(0, 0)));
+		CHECK_FALSE(next.contains(Point<K>(2, 1)));
+		CHECK_THROWS_AS(next.at(Point<K>(2, 1)), std::out_of_range);
+
+		EdgeToVertex edges(topology);
+		CHECK(edges.contains(Segment<K>(Point<K>(0, 0), Point<K>(1, 0))));
+		CHECK_FALSE(edges.contains(Segment<K>(Point<K>(1, 0), Point<K>(0, 0))));
+		CHECK_FALSE(edges.contains(Segment<K>(Point<K>(0, 0), Point<K>(2, 1))));
+	}
+
+	SECTION("removing a vertex") {
+		topology.remove(vertices[1]);
+		CHECK(topology.vertex_count() == 2);
+		CHECK(topology[vertices[1]].removed);
+		CHECK_FALSE(topology.contains(Point<K>(1, 0)));
+		// removing twice has no effect
+		topology.remove(vertices[1]);
+		CHECK(topology.vertex_count() == 2);
+
+		// the point can be reused, and gets a new identifier
+		VertexId replacement =
+		    topology.add(Point<K>(1, 0), &isoline, std::next(isoline.m_points.begin()));
+		CHECK(replacement != vertices[1]);
+		CHECK(topology.id(Point<K>(1, 0)) == replacement);
+		CHECK(topology.vertex_count() == 3);
+	}
+
+	SECTION("adding a vertex at a duplicate point") {
+		Isoline<K> other({Point<K>(1, 0)}, false);
+		CHECK_THROWS_AS(topology.add(Point<K>(1, 0), &other, other.m_points.begin()),
+		                std::invalid_argument);
+		// the existing vertex is unaffected
+		CHECK(topology.id(Point<K>(1, 0)) == vertices[1]);
+		CHECK(topology[vertices[1]].isoline == &isoline);
+		CHECK(topology.vertex_count() == 3);
+	}
+}
+
+TEST_CASE("Simplifying isolines that share a vertex") {
+	SECTION("open isolines") {
+		std::vector<Isoline<K>> isolines;
+		isolines.emplace_back(std::vector<Point<K>>{Point<K>(0, 0), Point<K>(1, 1), Point<K>(2, 0)},
+		                      false);
+		isolines.emplace_back(std::vector<Point<K>>{Point<K>(0, 2), Point<K>(1, 1), Point<K>(2, 2)},
+		                      false);
+		IsolineSimplifier simplifier(isolines);
+		CHECK(simplifier.m_current_complexity == 5);
+		CHECK(simplifier.m_topology.contains(Point<K>(1, 1)));
+	}
+
+	SECTION("touching rings") {
+		// two zigzagging rings that touch at (10, 0)
+		std::vector<Isoline<K>> isolines;
+		for (const double center : {0, 20}) {
+			std::vector<Point<K>> points;
+			for (int i = 0; i < 24; i++) {
+				const double angle = 2 * M_PI * i / 24;
+				const double radius = 10 + (i % 2 == 0 ? 0.3 : -0.3);
+				points.emplace_back(center + radius * std::cos(angle), radius * std::sin(angle));
+			}
+			points[center == 0 ? 0 : 12] = Point<K>(10, 0);
+			isolines.emplace_back(points, true);
+		}
+		IsolineSimplifier simplifier(isolines);
+		CHECK(simplifier.m_current_complexity == 47);
+		simplifier.simplify(30);
+		CHECK(simplifier.m_current_complexity < 47);
+		for (const auto& isoline : simplifier.m_simplified_isolines) {
+			for (const auto& point : isoline.m_points) {
+				REQUIRE(simplifier.m_topology.contains(point));
+				CHECK(simplifier.m_topology[simplifier.m_topology.id(point)].isoline == &isoline);
+			}
+		}
+	}
+}
+
+TEST_CASE("Keeping the isoline topology consistent while simplifying") {
+	std::vector<Isoline<K>> isolines;
+	for (int level = 1; level <= 3; level++) {
+		std::vector<Point<K>> points;
+		for (int i = 0; i < 24; i++) {
+			const double angle = 2 * M_PI * i / 24;
+			const double radius = 10 * level + (i % 2 == 0 ? 0.3 : -0.3);
+			points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+		}
+		isolines.emplace_back(points, true);
+	}
+	IsolineSimplifier simplifier(isolines);
+	simplifier.simplify(36);
+	CHECK(simplifier.m_current_complexity < 72);
+
+	int count = 0;
+	for (const auto& isoline : simplifier.m_simplified_isolines) {
+		for (auto it = isoline.m_points.begin(); it != isoline.m_points.end(); ++it) {
+			REQUIRE(simplifier.m_topology.contains(*it));
+			const TopologyVertex& vertex = simplifier.m_topology[simplifier.m_topology.id(*it)];
+			CHECK_FALSE(vertex.removed);
+			CHECK(vertex.iterator == it);
+			CHECK(vertex.isoline == &isoline);
+			auto next = std::next(it);
+			if (next == isoline.m_points.end()) {
+				next = isoline.m_points.begin();
+			}
+			CHECK(simplifier.m_topology[vertex.next].point == *next);
+			count++;
+		}
+	}
+	CHECK(simplifier.m_topology.vertex_count() == count);
+	CHECK(simplifier.m_current_complexity == count);
+}
@@ -0,0 +1,102 @@
+#include "../catch.hpp"
+
+#include <cmath>
+
+#include "cartocrow/isoline_simplification/isoline_simplifier.h"
+#include "cartocrow/isoline_simplification/symmetric_difference.h"
+#include "cartocrow/isoline_simplification/tiled_simplification.h"
+
+using namespace cartocrow;
+using namespace cartocrow::isoline_simplification;
+
+namespace {
+
+/// Concentric closed isolines with a zigzag, with edges of length about
+/// 2 pi r / vertices.
+std::vector<Isoline<K>> rings(int count, int vertices) {
+	std::vector<Isoline<K>> isolines;
+	for (int level = 1; level <= count; level++) {
+		std::vector<Point<K>> points;
+		for (int i = 0; i < vertices; i++) {
+			const double angle = 2 * M_PI * i / vertices;
+			const double radius = 10 * level + (i % 2 == 0 ? 0.3 : -0.3) + 0.1 * std::sin(3 * angle);
+			points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+		}
+		isolines.emplace_back(points, true);
+	}
+	return isolines;
+}
+
+std::vector<Segment<K>> edges(const std::vector<Isoline<K>>& isolines) {
+	std::vector<Segment<K>> result;
+	for (const auto& isoline : isolines) {
+		auto polyline = isoline.polyline();
+		std::copy(polyline.edges_begin(), polyline.edges_end(), std::back_inserter(result));
+	}
+	return result;
+}
+
+int vertexCount(const std::vector<Isoline<K>>& isolines) {
+	int count = 0;
+	for (const auto& isoline : isolines) {
+		count += isoline.m_points.size();
+	}
+	return count;
+}
+
+double error(const std::vector<Isoline<K>>& original, const std::vector<Isoline<K>>& simplified) {
+	double total = 0;
+	for (int i = 0; i < original.size(); i++) {
+		total += symmetric_difference(original[i], simplified[i]);
+	}
+	return total;
+}
+
+} // namespace
+
+TEST_CASE("Simplifying isolines in tiles") {
+	// edges are up to 2 pi 80 / 80 ~ 6.3 long, so the margin of 2 needs to be enlarged
+	const auto isolines = rings(8, 80);
+	const int total = vertexCount(isolines);
+	const int target = total / 2;
+	const auto tiled = tiled_simplify(isolines, target, 40, 2, 2);
+
+	REQUIRE(tiled.size() == isolines.size());
+	const int count = vertexCount(tiled);
+	CHECK(count < total * 0.8);
+	CHECK(count >= target);
+
+	// no two edges intersect, other than consecutive edges in their shared vertex
+	const auto tiledEdges = edges(tiled);
+	for (int i = 0; i < tiledEdges.size(); i++) {
+		for (int j = i + 1; j < tiledEdges.size(); j++) {
+			const Segment<K>& e1 = tiledEdges[i];
+			const Segment<K>& e2 = tiledEdges[j];
+			if (e1.source() == e2.target() || e1.target() == e2.source()) {
+				continue;
+			}
+			CHECK_FALSE(CGAL::do_intersect(e1, e2));
+		}
+	}
+
+	// the error is comparable to that of simplifying to the same size without tiles
+	IsolineSimplifier simplifier(isolines);
+	simplifier.simplify(count);
+	CHECK(error(isolines, tiled) <= 3 * error(isolines, simplifier.m_simplified_isolines) + 1E-9);
+}
+
+TEST_CASE("Simplifying isolines in tiles that are too small for their edges") {
+	// with edges of about 6.3 crossing tile boundaries, tiles need to be larger than 4 * 6.3
+	CHECK_THROWS_AS(tiled_simplify(rings(8, 80), 320, 20, 1, 1), std::runtime_error);
+}
+
+TEST_CASE("Simplifying isolines in tiles does not depend on the number of threads") {
+	const auto isolines = rings(8, 80);
+	const auto sequential = tiled_simplify(isolines, 320, 40, 2, 1);
+	const auto parallel = tiled_simplify(isolines, 320, 40, 2, 4);
+	REQUIRE(sequential.size() == parallel.size());
+	for (int i = 0; i < sequential.size(); i++) {
+		CHECK(sequential[i].m_closed == parallel[i].m_closed);
+		CHECK(sequential[i].m_points == parallel[i].m_points);
+	}
+}
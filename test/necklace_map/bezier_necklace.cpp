@@ -0,0 +1,61 @@
+#include "../catch.hpp"
+
+#include "cartocrow/core/bezier.h"
+#include "cartocrow/core/core.h"
+#include "cartocrow/necklace_map/bezier_necklace.h"
+#include "cartocrow/necklace_map/circular_range.h"
+
+using namespace cartocrow;
+using namespace cartocrow::necklace_map;
+
+namespace {
+
+// Approximates a circle of the given radius around the origin by four cubic Bézier curves.
+BezierSpline approximateCircle(const Number<Inexact>& radius) {
+	const Number<Inexact> k = 0.5522847498 * radius;
+	BezierSpline spline;
+	spline.appendCurve(Point<Inexact>(radius, 0), Point<Inexact>(radius, k),
+	                   Point<Inexact>(k, radius), Point<Inexact>(0, radius));
+	spline.appendCurve(Point<Inexact>(-k, radius), Point<Inexact>(-radius, k),
+	                   Point<Inexact>(-radius, 0));
+	spline.appendCurve(Point<Inexact>(-radius, -k), Point<Inexact>(-k, -radius),
+	                   Point<Inexact>(0, -radius));
+	spline.appendCurve(Point<Inexact>(k, -radius), Point<Inexact>(radius, -k),
+	                   Point<Inexact>(radius, 0));
+	return spline;
+}
+
+// The covering radius of a bead on a circle necklace, measured to the points where the bead boundary
+// crosses the necklace.
+Number<Inexact> chordAngle(const Number<Inexact>& radius, const Number<Inexact>& necklace_radius) {
+	return 2 * std::asin(radius / (2 * necklace_radius));
+}
+
+} // namespace
+
+TEST_CASE("Computing covering radii on a circular Bézier necklace") {
+	BezierNecklace necklace(approximateCircle(100), Point<Inexact>(0, 0));
+
+	SECTION("tabulated bead radii") {
+		for (const Number<Inexact> radius : {1.0, 10.0, 25.0, 60.0}) {
+			const Number<Inexact> expected = chordAngle(radius, 100);
+			CHECK(necklace.computeCoveringRadiusRad(CircularRange(0.3, 1.2), radius) ==
+			      Approx(expected).epsilon(0.01));
+			CHECK(necklace.computeCoveringRadiusRad(CircularRange(5.8, 0.4), radius) ==
+			      Approx(expected).epsilon(0.01));
+			CHECK(necklace.computeCoveringRadiusRad(CircularRange(0, M_2xPI), radius) ==
+			      Approx(expected).epsilon(0.01));
+		}
+	}
+
+	SECTION("bead radii beyond the table") {
+		CHECK(necklace.computeCoveringRadiusRad(CircularRange(0.3, 1.2), 120) ==
+		      Approx(chordAngle(120, 100)).epsilon(0.01));
+	}
+
+	SECTION("lookup table disabled") {
+		necklace.setCoveringRadiusPrecision(0, 0);
+		CHECK(necklace.computeCoveringRadiusRad(CircularRange(0.3, 1.2), 10) ==
+		      Approx(chordAngle(10, 100)).epsilon(0.01));
+	}
+}
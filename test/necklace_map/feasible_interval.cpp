@@ -0,0 +1,55 @@
+#include "../catch.hpp"
+
+#include "cartocrow/core/core.h"
+#include "cartocrow/necklace_map/circle_necklace.h"
+#include "cartocrow/necklace_map/feasible_interval/compute_feasible_interval.h"
+#include "cartocrow/necklace_map/necklace.h"
+#include "cartocrow/necklace_map/parameters.h"
+
+using namespace cartocrow;
+using namespace cartocrow::necklace_map;
+
+namespace {
+
+PolygonSet<Inexact> square(const Number<Inexact>& x_min, const Number<Inexact>& y_min,
+                           const Number<Inexact>& size) {
+	Polygon<Inexact> polygon;
+	polygon.push_back(Point<Inexact>(x_min, y_min));
+	polygon.push_back(Point<Inexact>(x_min + size, y_min));
+	polygon.push_back(Point<Inexact>(x_min + size, y_min + size));
+	polygon.push_back(Point<Inexact>(x_min, y_min + size));
+	PolygonSet<Inexact> set;
+	set.insert(polygon);
+	return set;
+}
+
+} // namespace
+
+TEST_CASE("Computing wedge intervals") {
+	Necklace necklace(std::make_shared<CircleNecklace>(Circle<Inexact>(Point<Inexact>(0, 0), 100)));
+	Parameters parameters;
+	parameters.interval_type = IntervalType::kWedge;
+	parameters.centroid_interval_length_rad = 0.5;
+	auto compute = ComputeFeasibleInterval::construct(parameters);
+
+	SECTION("region to the right of the kernel") {
+		CircularRange interval = (*compute)(square(1, -1, 2), necklace);
+		CHECK(interval.from() == Approx(1.75 * M_PI));
+		CHECK(interval.length() == Approx(0.5 * M_PI));
+	}
+	SECTION("region above the kernel") {
+		CircularRange interval = (*compute)(square(-1, 1, 2), necklace);
+		CHECK(interval.from() == Approx(0.25 * M_PI));
+		CHECK(interval.length() == Approx(0.5 * M_PI));
+	}
+	SECTION("region containing the kernel") {
+		CircularRange interval = (*compute)(square(-1, -2, 4), necklace);
+		CHECK(interval.length() == Approx(0.5));
+	}
+	SECTION("region too narrow for a wedge") {
+		parameters.wedge_interval_length_min_rad = 1;
+		compute = ComputeFeasibleInterval::construct(parameters);
+		CircularRange interval = (*compute)(square(10, -1, 2), necklace);
+		CHECK(interval.length() == Approx(1));
+	}
+}
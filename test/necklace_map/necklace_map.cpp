@@ -1,5 +1,9 @@
 #include "../catch.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
 #include "cartocrow/core/core.h"
 #include "cartocrow/core/region_map.h"
 #include "cartocrow/necklace_map/circle_necklace.h"
@@ -9,6 +13,91 @@
 using namespace cartocrow;
 using namespace cartocrow::necklace_map;
 
+namespace {
+/// Checks that every bead lies in its feasible interval and that no two
+/// consecutive beads overlap.
+void checkPlacement(NecklaceMap& map) {
+	const Number<Inexact> scaleFactor = map.scaleFactor();
+	for (const Necklace& necklace : map.necklaces()) {
+		const size_t n = necklace.beads.size();
+		for (size_t i = 0; i < n; ++i) {
+			const Bead& bead = *necklace.beads[i];
+			CHECK(bead.feasible.contains(bead.angle_rad));
+			if (n < 2) {
+				continue;
+			}
+			const Bead& next = *necklace.beads[(i + 1) % n];
+			Point<Inexact> p;
+			Point<Inexact> q;
+			REQUIRE(necklace.shape->intersectRay(bead.angle_rad, p));
+			REQUIRE(necklace.shape->intersectRay(next.angle_rad, q));
+			const Number<Inexact> minimum = scaleFactor * (bead.radius_base + next.radius_base);
+			CHECK(std::sqrt(CGAL::squared_distance(p, q)) >= minimum * (1 - 1e-6));
+		}
+	}
+}
+
+/// Creates a region map with a small square region for each of the given
+/// names, placed at the given angles (in degrees) around the point (64, 32).
+std::shared_ptr<RegionMap> regionsAround(const std::map<std::string, double>& angles) {
+	auto regions = std::make_shared<RegionMap>();
+	for (const auto& [name, angle] : angles) {
+		const double x = 64 + 16 * std::cos(angle * M_PI / 180);
+		const double y = 32 + 16 * std::sin(angle * M_PI / 180);
+		Polygon<Exact> square;
+		square.push_back(Point<Exact>(x - 1, y - 1));
+		square.push_back(Point<Exact>(x + 1, y - 1));
+		square.push_back(Point<Exact>(x + 1, y + 1));
+		square.push_back(Point<Exact>(x - 1, y + 1));
+		Region& region = (*regions)[name];
+		region.name = name;
+		region.shape = PolygonSet<Exact>(square);
+	}
+	return regions;
+}
+
+/// Adds a circular necklace around (64, 32) with a bead for each of the given
+/// values, and sets the parameters for a placement that converges.
+void setUpMap(NecklaceMap& map, const std::map<std::string, Number<Inexact>>& values) {
+	auto necklace = map.addNecklace(
+	    std::make_unique<CircleNecklace>(Circle<Inexact>(Point<Inexact>(64, 32), 32 * 32)));
+	for (const auto& [name, value] : values) {
+		map.addBead(name, value, necklace);
+	}
+	map.parameters().centroid_interval_length_rad = 1;
+	map.parameters().order_type = cartocrow::necklace_map::OrderType::kAny;
+	map.parameters().heuristic_cycles = 0;
+	map.parameters().aversion_ratio = 0.5;
+	map.parameters().placement_cycles = 1000;
+	map.parameters().placement_tolerance_rad = 1e-6;
+}
+
+/// Returns the names of the regions of the beads of the first necklace, in
+/// the order in which the necklace stores them.
+std::vector<std::string> beadOrder(NecklaceMap& map) {
+	std::vector<std::string> names;
+	for (const std::shared_ptr<Bead>& bead : map.necklaces().front().beads) {
+		names.push_back(bead->region->name);
+	}
+	return names;
+}
+
+/// Returns the angle of each bead of the first necklace, keyed by region name.
+std::map<std::string, Number<Inexact>> beadAngles(NecklaceMap& map) {
+	std::map<std::string, Number<Inexact>> angles;
+	for (const std::shared_ptr<Bead>& bead : map.necklaces().front().beads) {
+		angles[bead->region->name] = bead->angle_rad;
+	}
+	return angles;
+}
+
+/// Returns the distance between two angles along the circle.
+Number<Inexact> angleDistance(const Number<Inexact>& a, const Number<Inexact>& b) {
+	const Number<Inexact> difference = wrapAngle(a - b);
+	return std::min(difference, M_2xPI - difference);
+}
+} // namespace
+
 TEST_CASE("Computing a necklace map") {
 	std::shared_ptr<RegionMap> regions = std::make_shared<RegionMap>(
 	    ipeToRegionMap(std::filesystem::path("data/test_region_map.ipe")));
@@ -33,3 +122,65 @@ TEST_CASE("Computing a necklace map") {
 		CHECK(map.scaleFactor() == Approx(32.0 / std::sqrt(2)).epsilon(0.01));
 	}
 }
+
+TEST_CASE("Updating the values of a necklace map") {
+	std::shared_ptr<RegionMap> regions =
+	    regionsAround({{"A", 0}, {"B", 40}, {"C", 150}, {"D", 250}});
+	const std::map<std::string, Number<Inexact>> values = {{"A", 1}, {"B", 2}, {"C", 1}, {"D", 3}};
+	const std::map<std::string, Number<Inexact>> updatedValues = {
+	    {"A", 1}, {"B", 2.5}, {"C", 1}, {"D", 3}};
+
+	NecklaceMap map(regions);
+	setUpMap(map, values);
+	map.compute();
+	checkPlacement(map);
+
+	NecklaceMap recomputed(regions);
+	setUpMap(recomputed, updatedValues);
+	recomputed.compute();
+	REQUIRE(0 < recomputed.placementCycles());
+	REQUIRE(recomputed.placementCycles() < 1000);
+
+	SECTION("warm start") {
+		map.updateValues({{"B", 2.5}});
+		CHECK(map.scaleFactor() == Approx(recomputed.scaleFactor()).epsilon(0.01));
+		checkPlacement(map);
+		// the placement starts from the previous one, which is close to the new balance
+		CHECK(0 < map.placementCycles());
+		CHECK(map.placementCycles() < recomputed.placementCycles());
+	}
+
+	SECTION("invalid region name") {
+		const std::map<std::string, Number<Inexact>> angles = beadAngles(map);
+		const std::vector<std::string> order = beadOrder(map);
+		CHECK_THROWS(map.updateValues({{"B", 2.5}, {"E", 1}}));
+		CHECK(beadAngles(map) == angles);
+		CHECK(beadOrder(map) == order);
+	}
+}
+
+TEST_CASE("Placing beads in red-black order") {
+	// an odd number of beads, so the last bead is updated separately from both colors
+	std::shared_ptr<RegionMap> regions =
+	    regionsAround({{"A", 0}, {"B", 40}, {"C", 110}, {"D", 200}, {"E", 290}});
+	NecklaceMap map(regions);
+	setUpMap(map, {{"A", 1}, {"B", 2}, {"C", 1}, {"D", 3}, {"E", 2}});
+	map.parameters().placement_order = PlacementOrder::kRedBlack;
+
+	map.parameters().placement_tolerance_rad = 0;
+	map.compute();
+	CHECK(map.placementCycles() == 1000);
+	checkPlacement(map);
+	const Number<Inexact> scaleFactor = map.scaleFactor();
+	const std::map<std::string, Number<Inexact>> angles = beadAngles(map);
+
+	map.parameters().placement_tolerance_rad = 1e-7;
+	map.compute();
+	CHECK(map.scaleFactor() == Approx(scaleFactor));
+	CHECK(0 < map.placementCycles());
+	CHECK(map.placementCycles() < 1000);
+	checkPlacement(map);
+	for (const auto& [name, angle] : beadAngles(map)) {
+		CHECK(angleDistance(angle, angles.at(name)) < 1e-5);
+	}
+}